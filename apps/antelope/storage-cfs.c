@@ -405,6 +405,7 @@ storage_get_row(relation_t *rel, tuple_id_t *tuple_id, storage_row_t row)
 {
   int r;
   tuple_id_t nrows;
+  const void *mapped_row;
 
   if(DB_ERROR(storage_get_row_amount(rel, &nrows))) {
     return DB_STORAGE_ERROR;
@@ -414,20 +415,27 @@ storage_get_row(relation_t *rel, tuple_id_t *tuple_id, storage_row_t row)
     return DB_FINISHED;
   }
 
-  if(cfs_seek(rel->tuple_storage, *tuple_id * rel->row_length, CFS_SEEK_SET) ==
-              (cfs_offset_t)-1) {
-    return DB_STORAGE_ERROR;
-  }
+  /* Avoid the seek and read if the file system can map the row. */
+  mapped_row = cfs_map(rel->tuple_storage, *tuple_id * rel->row_length,
+                       rel->row_length);
+  if(mapped_row != NULL) {
+    memcpy(row, mapped_row, rel->row_length);
+  } else {
+    if(cfs_seek(rel->tuple_storage, *tuple_id * rel->row_length,
+                CFS_SEEK_SET) == (cfs_offset_t)-1) {
+      return DB_STORAGE_ERROR;
+    }
 
-  r = cfs_read(rel->tuple_storage, row, rel->row_length);
-  if(r < 0) {
-    PRINTF("DB: Reading failed on fd %d\n", rel->tuple_storage);
-    return DB_STORAGE_ERROR;
-  } else if(r == 0) {
-    return DB_FINISHED;
-  } else if(r < rel->row_length) {
-    PRINTF("DB: Incomplete record: %d < %d\n", r, rel->row_length);
-    return DB_STORAGE_ERROR;
+    r = cfs_read(rel->tuple_storage, row, rel->row_length);
+    if(r < 0) {
+      PRINTF("DB: Reading failed on fd %d\n", rel->tuple_storage);
+      return DB_STORAGE_ERROR;
+    } else if(r == 0) {
+      return DB_FINISHED;
+    } else if(r < rel->row_length) {
+      PRINTF("DB: Incomplete record: %d < %d\n", r, rel->row_length);
+      return DB_STORAGE_ERROR;
+    }
   }
 
   row[rel->row_length - 1] ^= ROW_XOR;
@@ -75,9 +75,53 @@ PROCESS_THREAD(shell_format_process, ev, data)
   PROCESS_END();
 }
 /*---------------------------------------------------------------------------*/
+PROCESS(shell_wear_process, "wear");
+SHELL_COMMAND(wear_command,
+	      "wear",
+	      "wear: show the erase counts of the Coffee sectors",
+	      &shell_wear_process);
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(shell_wear_process, ev, data)
+{
+  char buf[40];
+  long count, min, max;
+  unsigned long total;
+  unsigned sector;
+
+  PROCESS_BEGIN();
+
+  if(cfs_coffee_get_erase_count(0) < 0) {
+    shell_output_str(&wear_command,
+		     "wear: the erase counts are not enabled", "");
+    PROCESS_EXIT();
+  }
+
+  min = max = cfs_coffee_get_erase_count(0);
+  total = 0;
+  for(sector = 0; (count = cfs_coffee_get_erase_count(sector)) >= 0;
+      sector++) {
+    snprintf(buf, sizeof(buf), "%u %ld", sector, count);
+    shell_output_str(&wear_command, buf, "");
+    if(count < min) {
+      min = count;
+    }
+    if(count > max) {
+      max = count;
+    }
+    total += count;
+  }
+
+  snprintf(buf, sizeof(buf), "min %ld max %ld mean %lu",
+	   min, max, total / sector);
+  shell_output_str(&wear_command, buf, "");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
 void
 shell_coffee_init(void)
 {
   shell_register_command(&format_command);
+  shell_register_command(&wear_command);
 }
 /*---------------------------------------------------------------------------*/
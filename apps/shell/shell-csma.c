@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2013, the Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Shell command that prints the CSMA per-neighbor statistics
+ */
+
+#include "shell.h"
+#include "net/mac/csma.h"
+#include "sys/clock.h"
+
+#include <stdio.h>
+
+PROCESS(shell_csma_process, "csma");
+SHELL_COMMAND(csma_command,
+	      "csma",
+	      "csma: show CSMA queue and transmission statistics",
+	      &shell_csma_process);
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(shell_csma_process, ev, data)
+{
+#if CSMA_STATS
+  const struct csma_stats *stats;
+  const rimeaddr_t *addr;
+  char buf[100];
+  unsigned long delay;
+#endif /* CSMA_STATS */
+
+  PROCESS_BEGIN();
+
+#if CSMA_STATS
+  for(stats = csma_stats_head();
+      stats != NULL;
+      stats = csma_stats_next(stats)) {
+    addr = csma_stats_addr(stats);
+    delay = 0;
+    if(stats->packets > 0) {
+      delay = stats->queueing_delay * 1000 / CLOCK_SECOND / stats->packets;
+    }
+    snprintf(buf, sizeof(buf),
+	     "%d.%d: queued %u sent %u retries %u drops %u delay %lu ms failures %u%%",
+	     addr->u8[0], addr->u8[1], stats->queued, stats->packets,
+	     stats->retries, stats->drops, delay,
+	     (unsigned)(stats->failure_rate * 100 / 255));
+    shell_output_str(&csma_command, buf, "");
+  }
+#else /* CSMA_STATS */
+  shell_output_str(&csma_command,
+		   "csma: statistics are disabled, set CSMA_CONF_STATS", "");
+#endif /* CSMA_STATS */
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
+void
+shell_csma_init(void)
+{
+  shell_register_command(&csma_command);
+}
+/*---------------------------------------------------------------------------*/
@@ -55,6 +55,13 @@ int snprintf(char *str, size_t size, const char *format, ...);
 
 #define CONTINUE_EVENT 128
 
+/* Number of packets queued back-to-back by the bulk transfer test */
+#ifdef SHELL_NETPERF_CONF_BURST_LENGTH
+#define BURST_LENGTH SHELL_NETPERF_CONF_BURST_LENGTH
+#else
+#define BURST_LENGTH 4
+#endif
+
 struct power {
   unsigned long lpm, cpu, rx, tx;
 };
@@ -492,11 +499,13 @@ static void
 print_usage(void)
 {
   shell_output_str(&netperf_command,
-		   "netperf [-b|u|p|s] <receiver> <num packets>: perform network measurements to receiver", "");
+		   "netperf [-b|u|f|p|s] <receiver> <num packets>: perform network measurements to receiver", "");
   shell_output_str(&netperf_command,
 		   "        -b measure broadcast performance", "");
   shell_output_str(&netperf_command,
 		   "        -u measure one-way unicast performance", "");
+  shell_output_str(&netperf_command,
+		   "        -f measure one-way unicast bulk transfer performance", "");
   shell_output_str(&netperf_command,
 		   "        -p measure ping-pong unicast performance", "");
   shell_output_str(&netperf_command,
@@ -523,6 +532,7 @@ PROCESS_THREAD(shell_netperf_process, ev, data)
   static char recvstr[40];
   static int i, num_packets;
   static uint8_t do_broadcast, do_unicast, do_pingpong, do_stream_pingpong;
+  static uint8_t burst_length;
 
   PROCESS_BEGIN();
 
@@ -530,10 +540,11 @@ PROCESS_THREAD(shell_netperf_process, ev, data)
   
   do_broadcast = do_unicast = do_pingpong =
     do_stream_pingpong = 0;
+  burst_length = 1;
   
   args = data;
 
-  /* Parse the -bups options */
+  /* Parse the -bufps options */
   while(*args == '-') {
     ++args;
     while(*args != ' ' &&
@@ -544,6 +555,10 @@ PROCESS_THREAD(shell_netperf_process, ev, data)
       if(*args == 'u') {
 	do_unicast = 1;
       }
+      if(*args == 'f') {
+	do_unicast = 1;
+	burst_length = BURST_LENGTH;
+      }
       if(*args == 'p') {
 	do_pingpong = 1;
       }
@@ -619,7 +634,11 @@ PROCESS_THREAD(shell_netperf_process, ev, data)
 
   if(do_unicast) {
     current_type = TYPE_UNICAST;
-    shell_output_str(&netperf_command, "-------- Unicast one-way --------", "");
+    if(burst_length > 1) {
+      shell_output_str(&netperf_command, "-------- Unicast one-way bulk --------", "");
+    } else {
+      shell_output_str(&netperf_command, "-------- Unicast one-way --------", "");
+    }
     
     shell_output_str(&netperf_command, "Contacting ", recvstr);
     while(!send_ctrl_command(&receiver, CTRL_COMMAND_CLEAR)) {
@@ -636,7 +655,11 @@ PROCESS_THREAD(shell_netperf_process, ev, data)
 	unicast_send(&unicast, &receiver);
 	stats.sent++;
       }
-      PROCESS_PAUSE();
+      /* In bulk mode, queue a few packets before letting the MAC
+	 layer run so that it can send them as a burst */
+      if((i + 1) % burst_length == 0) {
+	PROCESS_PAUSE();
+      }
     }
     
     shell_output_str(&netperf_command, "Requesting statistics from ", recvstr);
@@ -39,6 +39,9 @@
 
 #include "contiki.h"
 #include "shell-ps.h"
+#if PROCESS_PROFILE
+#include "sys/rtimer.h"
+#endif /* PROCESS_PROFILE */
 
 #include <stdio.h>
 #include <string.h>
@@ -49,6 +52,13 @@ SHELL_COMMAND(ps_command,
 	      "ps",
 	      "ps: list all running processes",
 	      &shell_ps_process);
+#if PROCESS_PROFILE
+PROCESS(shell_profile_process, "profile");
+SHELL_COMMAND(profile_command,
+	      "profile",
+	      "profile [reset]: show the time spent in each process",
+	      &shell_profile_process);
+#endif /* PROCESS_PROFILE */
 /*---------------------------------------------------------------------------*/
 PROCESS_THREAD(shell_ps_process, ev, data)
 {
@@ -65,9 +75,63 @@ PROCESS_THREAD(shell_ps_process, ev, data)
   PROCESS_END();
 }
 /*---------------------------------------------------------------------------*/
+#if PROCESS_PROFILE
+static void
+output_event_profile(const char *name, process_event_t ev)
+{
+  struct process_event_profile e;
+  char buf[60];
+
+  process_get_event_profile(ev, &e);
+  if(e.events > 0) {
+    snprintf(buf, sizeof(buf), "%lu %lu %lu ", e.events,
+             e.latency_total / e.events, e.latency_max);
+    shell_output_str(&profile_command, buf, name);
+  }
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(shell_profile_process, ev, data)
+{
+  struct process *p;
+  char buf[60];
+  char namebuf[30];
+  int i;
+
+  PROCESS_BEGIN();
+
+  if(data != NULL && strcmp(data, "reset") == 0) {
+    process_profile_reset();
+    PROCESS_EXIT();
+  }
+
+  snprintf(buf, sizeof(buf), "Processes (calls time max, %lu ticks/s):",
+           (unsigned long)PROCESS_PROFILE_SECOND);
+  shell_output_str(&profile_command, buf, "");
+  for(p = PROCESS_LIST(); p != NULL; p = p->next) {
+    snprintf(buf, sizeof(buf), "%lu %lu %lu ", p->profile.calls,
+             p->profile.time, p->profile.time_max);
+    strncpy(namebuf, PROCESS_NAME_STRING(p), sizeof(namebuf));
+    namebuf[sizeof(namebuf) - 1] = 0;
+    shell_output_str(&profile_command, buf, namebuf);
+  }
+
+  shell_output_str(&profile_command, "Events (count latency max):", "");
+  for(i = 0; i < PROCESS_PROFILE_EVENTS; i++) {
+    snprintf(namebuf, sizeof(namebuf), "0x%02x", PROCESS_EVENT_NONE + i);
+    output_event_profile(namebuf, PROCESS_EVENT_NONE + i);
+  }
+  output_event_profile("other", 0);
+
+  PROCESS_END();
+}
+#endif /* PROCESS_PROFILE */
+/*---------------------------------------------------------------------------*/
 void
 shell_ps_init(void)
 {
   shell_register_command(&ps_command);
+#if PROCESS_PROFILE
+  shell_register_command(&profile_command);
+#endif /* PROCESS_PROFILE */
 }
 /*---------------------------------------------------------------------------*/
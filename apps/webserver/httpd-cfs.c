@@ -78,6 +78,23 @@ PT_THREAD(send_file(struct httpd_state *s))
   PSOCK_BEGIN(&s->sout);
   
   do {
+#if CFS_MAP
+    /* Send straight from the file system if it can map the data */
+    s->len = sizeof(s->outputbuf);
+    s->data = cfs_map(s->fd, s->offset, s->len);
+    if(s->data != NULL) {
+      cfs_seek(s->fd, s->len, CFS_SEEK_CUR);
+    } else {
+      s->len = cfs_read(s->fd, s->outputbuf, sizeof(s->outputbuf));
+      s->data = s->outputbuf;
+    }
+    if(s->len > 0) {
+      s->offset += s->len;
+      PSOCK_SEND(&s->sout, (uint8_t *)s->data, s->len);
+    } else {
+      break;
+    }
+#else /* CFS_MAP */
     /* Read data from file system into buffer */
     s->len = cfs_read(s->fd, s->outputbuf, sizeof(s->outputbuf));
 
@@ -87,6 +104,7 @@ PT_THREAD(send_file(struct httpd_state *s))
     } else {
       break;
     }
+#endif /* CFS_MAP */
   } while(s->len > 0);
       
   PSOCK_END(&s->sout);
@@ -162,6 +180,9 @@ PT_THREAD(handle_output(struct httpd_state *s))
     PT_WAIT_THREAD(&s->outputpt,
 		   send_headers(s, http_header_200));
   }
+#if CFS_MAP
+  s->offset = 0;
+#endif
   PT_WAIT_THREAD(&s->outputpt, send_file(s));
   cfs_close(s->fd);
   s->fd = -1;
@@ -35,6 +35,7 @@
 #define HTTPD_CFS_H_
 
 #include "contiki-net.h"
+#include "cfs/cfs.h"
 
 #ifndef WEBSERVER_CONF_CFS_PATHLEN
 #define HTTPD_PATHLEN 80
@@ -52,6 +53,10 @@ struct httpd_state {
   char state;
   int fd;
   int len;
+#if CFS_MAP
+  const char *data;
+  cfs_offset_t offset;
+#endif
 };
 
 
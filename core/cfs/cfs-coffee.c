@@ -58,6 +58,7 @@
 #include "cfs/cfs.h"
 #include "cfs-coffee-arch.h"
 #include "cfs/cfs-coffee.h"
+#include "dev/xmem.h"
 
 /* Micro logs enable modifications on storage types that do not support
    in-place updates. This applies primarily to flash memories. */
@@ -81,6 +82,24 @@
 #define COFFEE_IO_SEMANTICS	0
 #endif
 
+/*
+ * Writes that are independent of each other are given to the storage
+ * driver together, as scatter lists whose offsets count from the start
+ * of the storage device rather than from COFFEE_START. A platform whose
+ * driver handles scatter lists faster than one write at a time maps
+ * COFFEE_WRITEV to it in cfs-coffee-arch.h. They are otherwise done
+ * with COFFEE_WRITE.
+ *
+ * With CFS_CONF_SUBMIT, cfs_submit() hands reads of unmodified files
+ * and writes past the end of such files to the storage driver as
+ * asynchronous requests, if the platform maps COFFEE_SUBMIT and
+ * COFFEE_WAIT to it. Other accesses are done at once. At most
+ * COFFEE_MAX_REQUESTS requests are in progress at the same time.
+ */
+#ifndef COFFEE_MAX_REQUESTS
+#define COFFEE_MAX_REQUESTS	2
+#endif
+
 /*
  * Prevent sectors from being erased directly after file removal.
  * This will level the wear across sectors better, but may lead
@@ -90,6 +109,117 @@
 #define COFFEE_EXTENDED_WEAR_LEVELLING	1
 #endif
 
+/*
+ * Keep an index of the start pages of the files in RAM, hashed by file
+ * name, so that opening a file does not require scanning the file
+ * headers. The index is built on the first file lookup, and files
+ * that do not fit in it are found by scanning the storage as usual.
+ */
+#ifndef COFFEE_NAME_INDEX
+#define COFFEE_NAME_INDEX	0
+#endif
+
+#ifndef COFFEE_NAME_INDEX_SIZE
+#define COFFEE_NAME_INDEX_SIZE	32
+#endif
+
+/*
+ * Reserve a table of end-of-file records at the end of each new file,
+ * so that the file length can be found without scanning the data
+ * backwards. Files created without the table are still handled by
+ * scanning, and get the table when they are merged or extended. The
+ * setting may be enabled on an existing file system, but should not be
+ * disabled afterwards since the tables would then be seen as data.
+ */
+#ifndef COFFEE_EOF_RECORDS
+#define COFFEE_EOF_RECORDS	0
+#endif
+
+/*
+ * Cache the index table of the most recently used micro log in RAM, and
+ * buffer the log record that is being modified, so that small writes to
+ * the same record are coalesced into one log record. The buffered record
+ * is written when another record is modified, when the file is closed
+ * or read, and by cfs_coffee_sync(). Logs with more than
+ * COFFEE_LOG_CACHE_RECORDS records do not have their index cached.
+ */
+#ifndef COFFEE_LOG_CACHE
+#define COFFEE_LOG_CACHE	0
+#endif
+
+#ifndef COFFEE_LOG_CACHE_RECORDS
+#define COFFEE_LOG_CACHE_RECORDS	64
+#endif
+
+/*
+ * Collect garbage in the background, a few sectors at a time, instead
+ * of erasing every eligible sector when a reservation fails. The
+ * collector runs as a process that keeps COFFEE_GC_FREE_SECTORS erased
+ * sectors in reserve, and erases at most COFFEE_GC_SECTORS_PER_RUN
+ * sectors each time it is scheduled. A reservation still collects all
+ * garbage directly if the reserve is not enough.
+ */
+#ifndef COFFEE_GC_INCREMENTAL
+#define COFFEE_GC_INCREMENTAL	0
+#endif
+
+#ifndef COFFEE_GC_FREE_SECTORS
+#define COFFEE_GC_FREE_SECTORS	2
+#endif
+
+#ifndef COFFEE_GC_SECTORS_PER_RUN
+#define COFFEE_GC_SECTORS_PER_RUN	1
+#endif
+
+/* Keep the statistics returned by cfs_coffee_get_gc_stats(). */
+#ifndef COFFEE_GC_STATS
+#define COFFEE_GC_STATS		COFFEE_GC_INCREMENTAL
+#endif
+
+
+/*
+ * Count the erasures of each sector, and keep the counts in the file
+ * COFFEE_WEAR_FILE so that they survive reboots and formatting. The
+ * counts are saved by a process after an erasure, or by the GC process
+ * with COFFEE_GC_INCREMENTAL, so the latest erasures can be lost in a
+ * reboot. The file holds
+ * COFFEE_WEAR_RECORDS sets of counts before it is rewritten.
+ */
+#ifndef COFFEE_WEAR_STATS
+#define COFFEE_WEAR_STATS	0
+#endif
+
+#ifndef COFFEE_WEAR_FILE
+#define COFFEE_WEAR_FILE	".coffee-wear"
+#endif
+
+#ifndef COFFEE_WEAR_RECORDS
+#define COFFEE_WEAR_RECORDS	8
+#endif
+
+/*
+ * Allocate files by the erase counts instead of in the first free
+ * pages. The files that are rewritten often -- micro logs, the files
+ * merged from them, and the wear file -- go to the least erased sector
+ * that holds no other files. The other files go to the most erased
+ * sector that holds no such files, which rests that sector while they
+ * exist.
+ */
+#ifndef COFFEE_HOT_COLD_SEPARATION
+#define COFFEE_HOT_COLD_SEPARATION	0
+#endif
+
+#if COFFEE_HOT_COLD_SEPARATION && !COFFEE_WEAR_STATS
+#error "COFFEE_HOT_COLD_SEPARATION requires COFFEE_WEAR_STATS."
+#endif
+
+#if COFFEE_GC_INCREMENTAL || COFFEE_WEAR_STATS
+#include "sys/process.h"
+#endif
+#if COFFEE_GC_STATS
+#include "sys/rtimer.h"
+#endif
+
 #if COFFEE_START & (COFFEE_SECTOR_SIZE - 1)
 #error COFFEE_START must point to the first byte in a sector.
 #endif
@@ -100,6 +230,8 @@
 #define COFFEE_FD_APPEND	0x4
 
 #define COFFEE_FILE_MODIFIED	0x1
+#define COFFEE_FILE_EOF		0x2	/* The file has EOF records. */
+#define COFFEE_FILE_EOF_DIRTY	0x4	/* The end is not recorded yet. */
 
 #define INVALID_PAGE		((coffee_page_t)-1)
 #define UNKNOWN_OFFSET		((cfs_offset_t)-1)
@@ -108,10 +240,19 @@
 #define CLOSE_FDS		1
 #define ALLOW_GC		1
 
+/* Reservation flag for files that are rewritten often. It is not
+   stored in the file header. */
+#define RESERVE_HOT		0x100
+
 /* "Greedy" garbage collection erases as many sectors as possible. */
 #define GC_GREEDY		0
 /* "Reluctant" garbage collection stops after erasing one sector. */
 #define GC_RELUCTANT		1
+/* "Incremental" garbage collection erases a limited number of sectors
+   that have no free pages left, or that have any obsolete pages if it
+   is "eager". */
+#define GC_INCREMENTAL		2
+#define GC_INCREMENTAL_EAGER	3
 
 /* File descriptor macros. */
 #define FD_VALID(fd)					\
@@ -123,6 +264,7 @@
 
 /* File object macros. */
 #define FILE_MODIFIED(file)	((file)->flags & COFFEE_FILE_MODIFIED)
+#define FILE_EOF(file)		((file)->flags & COFFEE_FILE_EOF)
 #define FILE_FREE(file)		((file)->max_pages == 0)
 #define FILE_UNREFERENCED(file)	((file)->references == 0)
 
@@ -133,6 +275,7 @@
 #define HDR_FLAG_MODIFIED	0x8	/* Modified file, log exists. */
 #define HDR_FLAG_LOG		0x10	/* Log file. */
 #define HDR_FLAG_ISOLATED	0x20	/* Isolated page. */
+#define HDR_FLAG_EOF		0x40	/* EOF records at the end. */
 
 /* File header macros. */
 #define CHECK_FLAG(hdr, flag)	((hdr).flags & (flag))
@@ -143,6 +286,7 @@
 #define HDR_MODIFIED(hdr)	CHECK_FLAG(hdr, HDR_FLAG_MODIFIED)
 #define HDR_ISOLATED(hdr)	CHECK_FLAG(hdr, HDR_FLAG_ISOLATED)
 #define HDR_OBSOLETE(hdr) 	CHECK_FLAG(hdr, HDR_FLAG_OBSOLETE)
+#define HDR_EOF(hdr)		CHECK_FLAG(hdr, HDR_FLAG_EOF)
 #define HDR_ACTIVE(hdr)		(HDR_ALLOCATED(hdr) && \
 				!HDR_OBSOLETE(hdr)  && \
 				!HDR_ISOLATED(hdr))
@@ -153,12 +297,14 @@
 	((coffee_page_t)(COFFEE_SIZE / COFFEE_PAGE_SIZE))
 #define COFFEE_PAGES_PER_SECTOR	\
 	((coffee_page_t)(COFFEE_SECTOR_SIZE / COFFEE_PAGE_SIZE))
+#define EOF_TABLE_SIZE		(COFFEE_EOF_RECORDS * sizeof(cfs_offset_t))
 
 /* This structure is used for garbage collection statistics. */
 struct sector_status {
   coffee_page_t active;
   coffee_page_t obsolete;
   coffee_page_t free;
+  coffee_page_t carried; /* Obsolete pages of a file from a previous sector. */
 };
 
 /* The structure of cached file objects. */
@@ -193,6 +339,19 @@ struct file_header {
   char name[COFFEE_NAME_LENGTH];
 };
 
+#if COFFEE_NAME_INDEX
+/* An entry of the file name index. */
+struct name_index_entry {
+  uint16_t hash;
+  coffee_page_t page;
+};
+
+/* The state of the file name index. */
+#define NAME_INDEX_NONE		0 /* Not built yet. */
+#define NAME_INDEX_COMPLETE	1 /* All files are in the index. */
+#define NAME_INDEX_PARTIAL	2 /* Some files did not fit in the index. */
+#endif /* COFFEE_NAME_INDEX */
+
 /* This is needed because of a buggy compiler. */
 struct log_param {
   cfs_offset_t offset;
@@ -200,6 +359,87 @@ struct log_param {
   uint16_t size;
 };
 
+#if COFFEE_MICRO_LOGS && COFFEE_LOG_CACHE
+/* The index table of the most recently used micro log. */
+static struct {
+  coffee_page_t log_page;
+  uint16_t records;
+  uint16_t indices[COFFEE_LOG_CACHE_RECORDS];
+} log_index = { INVALID_PAGE };
+
+/* The latest contents of a log record of a file. */
+static struct {
+  coffee_page_t file_page;
+  uint16_t region;
+  uint8_t dirty;
+  char data[COFFEE_PAGE_SIZE];
+} log_buffer = { INVALID_PAGE };
+
+static int flush_log_buffer(void);
+#endif /* COFFEE_MICRO_LOGS && COFFEE_LOG_CACHE */
+
+#if CFS_SUBMIT && defined(COFFEE_SUBMIT)
+/* An asynchronous access in progress, free if req is NULL. */
+static struct coffee_request {
+  struct xmem_request xmem;
+  struct xmem_iovec iov;
+  struct cfs_request *req;
+} coffee_requests[COFFEE_MAX_REQUESTS];
+#endif /* CFS_SUBMIT && COFFEE_SUBMIT */
+
+#if COFFEE_WEAR_STATS
+/* A set of erase counts, as stored in the wear file. The marker makes
+   the last bytes of every set nonzero, so that the end of the file
+   is found by scanning. */
+#define WEAR_MARKER		0x57454152UL
+struct wear_record {
+  uint32_t erasures[COFFEE_SECTOR_COUNT];
+  uint32_t marker;
+};
+
+#define WEAR_FILE_PAGES							\
+	((coffee_page_t)((sizeof(struct file_header) +			\
+	 COFFEE_WEAR_RECORDS * sizeof(struct wear_record) +		\
+	 COFFEE_PAGE_SIZE - 1) / COFFEE_PAGE_SIZE))
+
+/* The state of the erase counts. */
+#define WEAR_NONE		0 /* Not read from the wear file yet. */
+#define WEAR_SAVED		1 /* The same as in the wear file. */
+#define WEAR_DIRTY		2 /* Not saved since the last erasure. */
+
+static struct wear_record wear;
+static uint8_t wear_state;
+
+static void load_wear_stats(void);
+static void save_wear_stats(void);
+
+#if !COFFEE_GC_INCREMENTAL
+PROCESS(coffee_wear_process, "Coffee wear");
+static void request_wear_save(void);
+#endif
+#endif /* COFFEE_WEAR_STATS */
+
+#if COFFEE_HOT_COLD_SEPARATION
+/* The free extent in which the last file of each class was allocated.
+   The next files of the class are allocated after it without scanning
+   the file system, until it is full or a sector is erased. */
+static struct {
+  coffee_page_t page;
+  coffee_page_t end;
+} separated_extent[2];
+#endif /* COFFEE_HOT_COLD_SEPARATION */
+
+#if COFFEE_GC_INCREMENTAL
+/* The sectors in which every page is free. The map is built by scanning
+   the file system once, and is then kept up to date by the allocations
+   and erasures. */
+struct free_sector_map {
+  uint8_t bits[(COFFEE_SECTOR_COUNT + 7) / 8];
+  uint16_t count;
+  uint8_t known;
+};
+#endif
+
 /*
  * The protected memory consists of structures that should not be 
  * overwritten during system checkpointing because they may be used by 
@@ -211,12 +451,58 @@ static struct protected_mem_t {
   struct file_desc coffee_fd_set[COFFEE_FD_SET_SIZE];
   coffee_page_t next_free;
   char gc_wait;
+#if COFFEE_NAME_INDEX
+  struct name_index_entry name_index[COFFEE_NAME_INDEX_SIZE];
+  uint8_t name_index_state;
+#endif
+#if COFFEE_GC_INCREMENTAL
+  struct free_sector_map free_sectors;
+#endif
 } protected_mem;
 static struct file * const coffee_files = protected_mem.coffee_files;
 static struct file_desc * const coffee_fd_set = protected_mem.coffee_fd_set;
 static coffee_page_t * const next_free = &protected_mem.next_free;
 static char * const gc_wait = &protected_mem.gc_wait;
 
+#if COFFEE_GC_STATS
+static struct cfs_coffee_gc_stats gc_stats;
+#endif
+
+#if COFFEE_GC_INCREMENTAL
+static struct free_sector_map * const free_sectors =
+  &protected_mem.free_sectors;
+PROCESS(coffee_gc_process, "Coffee GC");
+#endif
+
+#if COFFEE_NAME_INDEX
+static struct name_index_entry * const name_index = protected_mem.name_index;
+static uint8_t * const name_index_state = &protected_mem.name_index_state;
+#endif
+
+/*---------------------------------------------------------------------------*/
+#if !defined(COFFEE_WRITEV) && COFFEE_MICRO_LOGS
+static void
+coffee_writev(const struct xmem_iovec *iov, int iovcnt)
+{
+  int i;
+
+  for(i = 0; i < iovcnt; i++) {
+    COFFEE_WRITE(iov[i].buf, iov[i].nbytes, iov[i].offset - COFFEE_START);
+  }
+}
+#define COFFEE_WRITEV(iov, iovcnt)	coffee_writev((iov), (iovcnt))
+#endif /* !COFFEE_WRITEV */
+/*---------------------------------------------------------------------------*/
+#if COFFEE_MICRO_LOGS || (CFS_SUBMIT && defined(COFFEE_SUBMIT))
+static void
+set_iovec(struct xmem_iovec *iov, const void *buf, int nbytes,
+	  cfs_offset_t offset)
+{
+  iov->buf = (void *)buf;
+  iov->nbytes = nbytes;
+  iov->offset = COFFEE_START + offset;
+}
+#endif /* COFFEE_MICRO_LOGS || (CFS_SUBMIT && COFFEE_SUBMIT) */
 /*---------------------------------------------------------------------------*/
 static void
 write_header(struct file_header *hdr, coffee_page_t page)
@@ -283,10 +569,12 @@ get_sector_status(uint16_t sector, struct sector_status *stats)
   } else {
     if(skip_pages >= COFFEE_PAGES_PER_SECTOR) {
       stats->obsolete = COFFEE_PAGES_PER_SECTOR;
+      stats->carried = COFFEE_PAGES_PER_SECTOR;
       skip_pages -= COFFEE_PAGES_PER_SECTOR;
       return skip_pages >= COFFEE_PAGES_PER_SECTOR ? 0 : skip_pages;
     }
     obsolete = skip_pages;
+    stats->carried = skip_pages;
   }
 
   /* Determine the amount of pages of each type that have not been 
@@ -342,6 +630,56 @@ get_sector_status(uint16_t sector, struct sector_status *stats)
 	0 : skip_pages;
 }
 /*---------------------------------------------------------------------------*/
+#if COFFEE_GC_INCREMENTAL
+static unsigned
+count_free_sectors(void)
+{
+  uint16_t sector;
+  struct sector_status stats;
+
+  if(!free_sectors->known) {
+    memset(free_sectors, 0, sizeof(*free_sectors));
+    for(sector = 0; sector < COFFEE_SECTOR_COUNT; sector++) {
+      get_sector_status(sector, &stats);
+      if(stats.free == COFFEE_PAGES_PER_SECTOR) {
+	free_sectors->bits[sector / 8] |= 1 << (sector % 8);
+	free_sectors->count++;
+      }
+    }
+    free_sectors->known = 1;
+  }
+  return free_sectors->count;
+}
+/*---------------------------------------------------------------------------*/
+static void
+mark_free_sector(uint16_t sector)
+{
+  if(free_sectors->known &&
+     !(free_sectors->bits[sector / 8] & (1 << (sector % 8)))) {
+    free_sectors->bits[sector / 8] |= 1 << (sector % 8);
+    free_sectors->count++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+mark_used_pages(coffee_page_t start, coffee_page_t count)
+{
+  uint16_t sector, last;
+
+  if(!free_sectors->known || count == 0) {
+    return;
+  }
+
+  last = (start + count - 1) / COFFEE_PAGES_PER_SECTOR;
+  for(sector = start / COFFEE_PAGES_PER_SECTOR; sector <= last; sector++) {
+    if(free_sectors->bits[sector / 8] & (1 << (sector % 8))) {
+      free_sectors->bits[sector / 8] &= ~(1 << (sector % 8));
+      free_sectors->count--;
+    }
+  }
+}
+#endif /* COFFEE_GC_INCREMENTAL */
+/*---------------------------------------------------------------------------*/
 static void
 isolate_pages(coffee_page_t start, coffee_page_t skip_pages)
 {
@@ -357,20 +695,39 @@ isolate_pages(coffee_page_t start, coffee_page_t skip_pages)
   for(page = 0; page < skip_pages; page++) {
     write_header(&hdr, start + page);
   }
+#if COFFEE_GC_INCREMENTAL
+  mark_used_pages(start, skip_pages);
+#endif
   PRINTF("Coffee: Isolated %u pages starting in sector %d\n",
          (unsigned)skip_pages, (int)start / COFFEE_PAGES_PER_SECTOR);
 
 }
 /*---------------------------------------------------------------------------*/
-static void
+static int
 collect_garbage(int mode)
 {
   uint16_t sector;
   struct sector_status stats;
-  coffee_page_t first_page, isolation_count;
+  coffee_page_t first_page, isolation_count, kept;
+  int erased, last_erased;
+#if COFFEE_GC_STATS
+  rtimer_clock_t start, elapsed;
+#endif
 
   PRINTF("Coffee: Running the file system garbage collector in %s mode\n",
-	 mode == GC_RELUCTANT ? "reluctant" : "greedy");
+	 mode == GC_RELUCTANT ? "reluctant" :
+	 mode == GC_GREEDY ? "greedy" : "incremental");
+#if COFFEE_GC_STATS
+  start = RTIMER_NOW();
+#endif
+  erased = last_erased = 0;
+
+#if COFFEE_WEAR_STATS
+  if(wear_state == WEAR_NONE) {
+    load_wear_stats();
+  }
+#endif
+
   /*
    * The garbage collector erases as many sectors as possible. A sector is
    * erasable if there are only free or obsolete pages in it.
@@ -381,12 +738,34 @@ collect_garbage(int mode)
         sector, (unsigned)stats.active,
 	(unsigned)stats.obsolete, (unsigned)stats.free);
 
-    if(stats.active > 0) {
+    if(mode >= GC_INCREMENTAL) {
+      /*
+       * A file that covers the whole sector is only described by its
+       * header in the previous sector. If that sector has just been
+       * erased, this one must be erased as well before stopping.
+       */
+      if(erased >= COFFEE_GC_SECTORS_PER_RUN &&
+	 !(last_erased && stats.carried == COFFEE_PAGES_PER_SECTOR)) {
+	break;
+      }
+    }
+
+    /*
+     * Pages that belong to an obsolete file whose header is kept cannot
+     * be reclaimed. They are isolated again after the erasure, since
+     * the header would otherwise hide the files allocated after them.
+     */
+    kept = last_erased ? 0 : stats.carried;
+    last_erased = 0;
+
+    if(stats.active > 0 || stats.obsolete == kept) {
       continue;
     }
 
     if((mode == GC_RELUCTANT && stats.free == 0) ||
-       (mode == GC_GREEDY && stats.obsolete > 0)) {
+       (mode == GC_GREEDY && stats.obsolete > 0) ||
+       (mode == GC_INCREMENTAL && stats.obsolete > 0 && stats.free == 0) ||
+       (mode == GC_INCREMENTAL_EAGER && stats.obsolete > 0)) {
       first_page = sector * COFFEE_PAGES_PER_SECTOR;
       if(first_page < *next_free) {
         *next_free = first_page;
@@ -398,13 +777,116 @@ collect_garbage(int mode)
 
       COFFEE_ERASE(sector);
       PRINTF("Coffee: Erased sector %d!\n", sector);
+#if COFFEE_GC_INCREMENTAL
+      mark_free_sector(sector);
+#endif
+      if(kept > 0) {
+        isolate_pages(first_page, kept);
+      }
+#if COFFEE_WEAR_STATS
+      wear.erasures[sector]++;
+      wear_state = WEAR_DIRTY;
+#endif
+#if COFFEE_HOT_COLD_SEPARATION
+      memset(separated_extent, 0, sizeof(separated_extent));
+#endif
+      erased++;
+      last_erased = 1;
 
       if(mode == GC_RELUCTANT && isolation_count > 0) {
         break;
       }
     }
   }
+
+#if COFFEE_GC_STATS
+  elapsed = (rtimer_clock_t)(RTIMER_NOW() - start);
+  gc_stats.runs++;
+  gc_stats.erased += erased;
+  if(elapsed > gc_stats.max_time) {
+    gc_stats.max_time = elapsed;
+  }
+  if(mode == GC_GREEDY) {
+    gc_stats.blocking_runs++;
+    if(elapsed > gc_stats.blocking_max_time) {
+      gc_stats.blocking_max_time = elapsed;
+    }
+  }
+#endif
+
+#if COFFEE_WEAR_STATS && !COFFEE_GC_INCREMENTAL
+  /* Save the erase counts outside of the file operation. */
+  if(erased > 0) {
+    request_wear_save();
+  }
+#endif
+
+  return erased;
+}
+/*---------------------------------------------------------------------------*/
+#if COFFEE_GC_INCREMENTAL
+static void
+request_gc(void)
+{
+  if(!process_is_running(&coffee_gc_process)) {
+    process_start(&coffee_gc_process, NULL);
+  }
+  process_poll(&coffee_gc_process);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(coffee_gc_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  while(1) {
+    PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_POLL);
+
+    /*
+     * Let other processes run between the sector erasures. The sectors
+     * that still have free pages are only erased when there is no
+     * other way to refill the reserve, since they wear faster.
+     */
+    while(count_free_sectors() < COFFEE_GC_FREE_SECTORS &&
+	  (collect_garbage(GC_INCREMENTAL) > 0 ||
+	   collect_garbage(GC_INCREMENTAL_EAGER) > 0)) {
+      process_poll(&coffee_gc_process);
+      PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_POLL);
+    }
+#if COFFEE_WEAR_STATS
+    if(wear_state == WEAR_DIRTY) {
+      save_wear_stats();
+    }
+#endif
+  }
+
+  PROCESS_END();
+}
+#endif /* COFFEE_GC_INCREMENTAL */
+/*---------------------------------------------------------------------------*/
+#if COFFEE_WEAR_STATS && !COFFEE_GC_INCREMENTAL
+static void
+request_wear_save(void)
+{
+  if(!process_is_running(&coffee_wear_process)) {
+    process_start(&coffee_wear_process, NULL);
+  }
+  process_poll(&coffee_wear_process);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(coffee_wear_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  while(1) {
+    PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_POLL);
+    if(wear_state == WEAR_DIRTY) {
+      save_wear_stats();
+    }
+  }
+
+  PROCESS_END();
 }
+#endif /* COFFEE_WEAR_STATS && !COFFEE_GC_INCREMENTAL */
 /*---------------------------------------------------------------------------*/
 static coffee_page_t
 next_file(coffee_page_t page, struct file_header *hdr)
@@ -427,6 +909,80 @@ next_file(coffee_page_t page, struct file_header *hdr)
   return page + hdr->max_pages;    
 }
 /*---------------------------------------------------------------------------*/
+#if COFFEE_NAME_INDEX
+static uint16_t
+name_hash(const char *name)
+{
+  uint16_t hash;
+  int i;
+
+  /* Only the part of the name that is stored in the header counts. */
+  hash = 5381;
+  for(i = 0; i < COFFEE_NAME_LENGTH - 1 && name[i] != '\0'; i++) {
+    hash = (hash * 33) ^ (uint8_t)name[i];
+  }
+  return hash;
+}
+/*---------------------------------------------------------------------------*/
+static void
+name_index_add(const char *name, coffee_page_t page)
+{
+  int i;
+
+  if(*name_index_state == NAME_INDEX_NONE) {
+    /* The file will be found when the index is built. */
+    return;
+  }
+
+  for(i = 0; i < COFFEE_NAME_INDEX_SIZE; i++) {
+    if(name_index[i].page == INVALID_PAGE) {
+      name_index[i].hash = name_hash(name);
+      name_index[i].page = page;
+      return;
+    }
+  }
+
+  PRINTF("Coffee: The name index is full\n");
+  *name_index_state = NAME_INDEX_PARTIAL;
+}
+/*---------------------------------------------------------------------------*/
+static void
+name_index_remove(coffee_page_t page)
+{
+  int i;
+
+  if(*name_index_state == NAME_INDEX_NONE) {
+    return;
+  }
+
+  for(i = 0; i < COFFEE_NAME_INDEX_SIZE; i++) {
+    if(name_index[i].page == page) {
+      name_index[i].page = INVALID_PAGE;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+name_index_build(void)
+{
+  struct file_header hdr;
+  coffee_page_t page;
+  int i;
+
+  for(i = 0; i < COFFEE_NAME_INDEX_SIZE; i++) {
+    name_index[i].page = INVALID_PAGE;
+  }
+  *name_index_state = NAME_INDEX_COMPLETE;
+
+  for(page = 0; page < COFFEE_PAGE_COUNT; page = next_file(page, &hdr)) {
+    read_header(&hdr, page);
+    if(HDR_ACTIVE(hdr) && !HDR_LOG(hdr)) {
+      name_index_add(hdr.name, page);
+    }
+  }
+}
+#endif /* COFFEE_NAME_INDEX */
+/*---------------------------------------------------------------------------*/
 static struct file *
 load_file(coffee_page_t start, struct file_header *hdr)
 {
@@ -463,6 +1019,11 @@ load_file(coffee_page_t start, struct file_header *hdr)
   if(HDR_MODIFIED(*hdr)) {
     file->flags |= COFFEE_FILE_MODIFIED;
   }
+#if COFFEE_EOF_RECORDS
+  if(HDR_EOF(*hdr)) {
+    file->flags |= COFFEE_FILE_EOF;
+  }
+#endif
   /* We don't know the amount of records yet. */
   file->record_count = -1;
 
@@ -475,6 +1036,37 @@ find_file(const char *name)
   int i;
   struct file_header hdr;
   coffee_page_t page;
+#if COFFEE_NAME_INDEX
+  uint16_t hash;
+  int j;
+
+  if(*name_index_state == NAME_INDEX_NONE) {
+    name_index_build();
+  }
+
+  /* Only read the headers of the files with the same name hash. */
+  hash = name_hash(name);
+  for(i = 0; i < COFFEE_NAME_INDEX_SIZE; i++) {
+    page = name_index[i].page;
+    if(page == INVALID_PAGE || name_index[i].hash != hash) {
+      continue;
+    }
+
+    read_header(&hdr, page);
+    if(HDR_ACTIVE(hdr) && !HDR_LOG(hdr) && strcmp(name, hdr.name) == 0) {
+      for(j = 0; j < COFFEE_MAX_OPEN_FILES; j++) {
+        if(!FILE_FREE(&coffee_files[j]) && coffee_files[j].page == page) {
+          return &coffee_files[j];
+        }
+      }
+      return load_file(page, &hdr);
+    }
+  }
+
+  if(*name_index_state == NAME_INDEX_COMPLETE) {
+    return NULL;
+  }
+#endif /* COFFEE_NAME_INDEX */
   
   /* First check if the file metadata is cached. */
   for(i = 0; i < COFFEE_MAX_OPEN_FILES; i++) {
@@ -499,16 +1091,95 @@ find_file(const char *name)
   return NULL;
 }
 /*---------------------------------------------------------------------------*/
+#if COFFEE_EOF_RECORDS
+static cfs_offset_t
+eof_table_offset(coffee_page_t start, coffee_page_t max_pages)
+{
+  return (start + max_pages) * COFFEE_PAGE_SIZE - EOF_TABLE_SIZE;
+}
+/*---------------------------------------------------------------------------*/
+static cfs_offset_t
+read_eof_records(coffee_page_t start, coffee_page_t max_pages, int *used)
+{
+  cfs_offset_t records[COFFEE_EOF_RECORDS];
+  int i;
+
+  COFFEE_READ(records, sizeof(records), eof_table_offset(start, max_pages));
+
+  /* The records are written in order; the last one is the file end. */
+  for(i = 0; i < COFFEE_EOF_RECORDS && records[i] != 0; i++);
+  *used = i;
+  return i == 0 ? 0 : records[i - 1];
+}
+/*---------------------------------------------------------------------------*/
+static int
+write_eof_record(struct file *file)
+{
+  cfs_offset_t end;
+  int used;
+
+  end = read_eof_records(file->page, file->max_pages, &used);
+  if(file->end <= end) {
+    file->flags &= ~COFFEE_FILE_EOF_DIRTY;
+    return 0;
+  }
+  if(used == COFFEE_EOF_RECORDS) {
+    PRINTF("Coffee: No EOF record left in the file at page %u\n",
+	(unsigned)file->page);
+    return -1;
+  }
+
+  COFFEE_WRITE(&file->end, sizeof(file->end),
+	       eof_table_offset(file->page, file->max_pages) +
+	       used * sizeof(cfs_offset_t));
+  file->flags &= ~COFFEE_FILE_EOF_DIRTY;
+  return 0;
+}
+#endif /* COFFEE_EOF_RECORDS */
+/*---------------------------------------------------------------------------*/
 static cfs_offset_t
 file_end(coffee_page_t start)
 {
   struct file_header hdr;
   unsigned char buf[COFFEE_PAGE_SIZE];
   coffee_page_t page;
+  cfs_offset_t limit, recorded, offset;
   int i;
 
   read_header(&hdr, start);
 
+  /* The offsets below are relative to the beginning of the header. */
+  limit = hdr.max_pages * COFFEE_PAGE_SIZE;
+  recorded = 0;
+
+#if COFFEE_EOF_RECORDS
+  if(HDR_EOF(hdr)) {
+    limit -= EOF_TABLE_SIZE;
+    recorded = read_eof_records(start, hdr.max_pages, &i);
+
+    /*
+     * The recorded end is exact, even if the file ends with zeroes,
+     * unless more data was written after it without closing the file.
+     * The rest of the page where the file ends tells which is the case.
+     */
+    offset = recorded + sizeof(hdr);
+    if(offset >= limit) {
+      return recorded;
+    }
+    page = offset / COFFEE_PAGE_SIZE;
+    COFFEE_READ(buf, sizeof(buf), (start + page) * COFFEE_PAGE_SIZE);
+    for(i = offset % COFFEE_PAGE_SIZE;
+	i < COFFEE_PAGE_SIZE && page * COFFEE_PAGE_SIZE + i < limit; i++) {
+      if(buf[i] != 0) {
+	break;
+      }
+    }
+    if(i == COFFEE_PAGE_SIZE || page * COFFEE_PAGE_SIZE + i >= limit) {
+      return recorded;
+    }
+  }
+#endif /* COFFEE_EOF_RECORDS */
+
   /*
    * Move from the end of the range towards the beginning and look for
    * a byte that has been modified.
@@ -517,22 +1188,28 @@ file_end(coffee_page_t start)
    * are zeroes, then these are skipped from the calculation.
    */
 
-  for(page = hdr.max_pages - 1; page >= 0; page--) {
+  for(page = (limit - 1) / COFFEE_PAGE_SIZE; page >= 0; page--) {
     COFFEE_READ(buf, sizeof(buf), (start + page) * COFFEE_PAGE_SIZE);
     for(i = COFFEE_PAGE_SIZE - 1; i >= 0; i--) {
+      offset = page * COFFEE_PAGE_SIZE + i;
+      if(offset >= limit) {
+	continue;
+      }
+      if(offset < recorded + sizeof(hdr)) {
+	/* The data before the recorded end does not need to be scanned. */
+	return recorded;
+      }
       if(buf[i] != 0) {
-	if(page == 0 && i < sizeof(hdr)) {
-	  return 0;
-	}
-	return 1 + i + (page * COFFEE_PAGE_SIZE) - sizeof(hdr);
+	return 1 + offset - sizeof(hdr);
       }
     }
   }
 
   /* All bytes are writable. */
-  return 0;
+  return recorded;
 }
 /*---------------------------------------------------------------------------*/
+#if !COFFEE_HOT_COLD_SEPARATION
 static coffee_page_t
 find_contiguous_pages(coffee_page_t amount)
 {
@@ -568,6 +1245,129 @@ find_contiguous_pages(coffee_page_t amount)
   }
   return INVALID_PAGE;
 }
+#endif /* !COFFEE_HOT_COLD_SEPARATION */
+/*---------------------------------------------------------------------------*/
+#if COFFEE_HOT_COLD_SEPARATION
+static coffee_page_t
+scan_separated_pages(coffee_page_t amount, int hot, coffee_page_t *end)
+{
+  coffee_page_t page, start, candidate, best;
+  coffee_page_t hot_end, cold_end;
+  struct file_header hdr;
+  uint32_t erasures, best_erasures;
+  int mixed, best_mixed;
+
+  best = INVALID_PAGE;
+  best_erasures = 0;
+  best_mixed = 0;
+  start = INVALID_PAGE;
+  hot_end = cold_end = 0;
+
+  /*
+   * Every free extent may be used from its first page or from the
+   * first page of any sector in it. Only the first sector of the
+   * extent can hold other files, which are hot if they have a micro
+   * log or are one.
+   */
+  for(page = 0; page <= COFFEE_PAGE_COUNT;) {
+    if(page < COFFEE_PAGE_COUNT) {
+      read_header(&hdr, page);
+      if(HDR_FREE(hdr)) {
+	if(start == INVALID_PAGE) {
+	  start = page;
+	}
+	page = next_file(page, &hdr);
+	continue;
+      }
+    }
+
+    for(candidate = start;
+	candidate != INVALID_PAGE && candidate + amount <= page;
+	candidate = (candidate + COFFEE_PAGES_PER_SECTOR) &
+		    ~(COFFEE_PAGES_PER_SECTOR - 1)) {
+      mixed = candidate == start &&
+	(hot ? cold_end : hot_end) >
+	candidate - candidate % COFFEE_PAGES_PER_SECTOR;
+      erasures = wear.erasures[candidate / COFFEE_PAGES_PER_SECTOR];
+      if(best == INVALID_PAGE || mixed < best_mixed ||
+	 (mixed == best_mixed &&
+	  (hot ? erasures < best_erasures : erasures > best_erasures))) {
+	best = candidate;
+	*end = page;
+	best_erasures = erasures;
+	best_mixed = mixed;
+      }
+    }
+    start = INVALID_PAGE;
+
+    if(page == COFFEE_PAGE_COUNT) {
+      break;
+    }
+    if(HDR_ACTIVE(hdr)) {
+      if(HDR_LOG(hdr) || HDR_MODIFIED(hdr)) {
+	hot_end = page + hdr.max_pages;
+      } else {
+	cold_end = page + hdr.max_pages;
+      }
+    }
+    page = next_file(page, &hdr);
+  }
+
+  return best;
+}
+/*---------------------------------------------------------------------------*/
+static coffee_page_t
+find_separated_pages(coffee_page_t amount, int hot)
+{
+  coffee_page_t best, end;
+
+  hot = hot != 0;
+  if(separated_extent[hot].page + amount <= separated_extent[hot].end) {
+    best = separated_extent[hot].page;
+    end = separated_extent[hot].end;
+  } else {
+    best = scan_separated_pages(amount, hot, &end);
+    if(best == INVALID_PAGE) {
+      return INVALID_PAGE;
+    }
+  }
+
+  separated_extent[hot].page = best + amount;
+  separated_extent[hot].end = end;
+
+  /* The other class cannot share the sectors of the new file. */
+  if(separated_extent[!hot].end > 0 &&
+     best / COFFEE_PAGES_PER_SECTOR <=
+     (separated_extent[!hot].end - 1) / COFFEE_PAGES_PER_SECTOR &&
+     (best + amount - 1) / COFFEE_PAGES_PER_SECTOR >=
+     separated_extent[!hot].page / COFFEE_PAGES_PER_SECTOR) {
+    separated_extent[!hot].end = 0;
+  }
+
+  if(best == *next_free) {
+    *next_free = best + amount;
+  }
+  return best;
+}
+#endif /* COFFEE_HOT_COLD_SEPARATION */
+/*---------------------------------------------------------------------------*/
+static coffee_page_t
+allocate_pages(coffee_page_t amount, int hot)
+{
+  coffee_page_t page;
+
+#if COFFEE_HOT_COLD_SEPARATION
+  page = find_separated_pages(amount, hot);
+#else
+  page = find_contiguous_pages(amount);
+#endif
+#if COFFEE_GC_INCREMENTAL
+  if(page != INVALID_PAGE) {
+    mark_used_pages(page, amount);
+  }
+#endif
+  return page;
+}
 /*---------------------------------------------------------------------------*/
 static int
 remove_by_page(coffee_page_t page, int remove_log, int close_fds,
@@ -592,6 +1392,20 @@ remove_by_page(coffee_page_t page, int remove_log, int close_fds,
 
   *gc_wait = 0;
 
+#if COFFEE_NAME_INDEX
+  name_index_remove(page);
+#endif
+
+#if COFFEE_MICRO_LOGS && COFFEE_LOG_CACHE
+  if(log_index.log_page == page) {
+    log_index.log_page = INVALID_PAGE;
+  }
+  if(log_buffer.file_page == page) {
+    log_buffer.file_page = INVALID_PAGE;
+    log_buffer.dirty = 0;
+  }
+#endif
+
   /* Close all file descriptors that reference the removed file. */
   if(close_fds) {
     for(i = 0; i < COFFEE_FD_SET_SIZE; i++) {
@@ -609,7 +1423,11 @@ remove_by_page(coffee_page_t page, int remove_log, int close_fds,
     }
   }
 
-#if !COFFEE_EXTENDED_WEAR_LEVELLING
+#if COFFEE_GC_INCREMENTAL
+  if(gc_allowed) {
+    request_gc();
+  }
+#elif !COFFEE_EXTENDED_WEAR_LEVELLING
   if(gc_allowed) {
     collect_garbage(GC_RELUCTANT);
   }
@@ -618,11 +1436,134 @@ remove_by_page(coffee_page_t page, int remove_log, int close_fds,
   return 0;
 }
 /*---------------------------------------------------------------------------*/
+#if COFFEE_WEAR_STATS
+static int
+is_wear_file(struct file_header *hdr)
+{
+  return HDR_ACTIVE(*hdr) && !HDR_LOG(*hdr) &&
+	 strncmp(hdr->name, COFFEE_WEAR_FILE, sizeof(hdr->name)) == 0;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned long
+read_wear_record(coffee_page_t page, struct wear_record *record)
+{
+  cfs_offset_t end;
+  unsigned long total;
+  unsigned i;
+
+  /* The last set may be incomplete if it was being written in a reboot. */
+  end = file_end(page) / sizeof(*record) * sizeof(*record);
+  if(end == 0) {
+    return 0;
+  }
+  COFFEE_READ(record, sizeof(*record),
+	      absolute_offset(page, end - sizeof(*record)));
+  if(record->marker != WEAR_MARKER) {
+    return 0;
+  }
+
+  for(total = 0, i = 0; i < COFFEE_SECTOR_COUNT; i++) {
+    total += record->erasures[i];
+  }
+  return total;
+}
+/*---------------------------------------------------------------------------*/
+static void
+load_wear_stats(void)
+{
+  struct wear_record record;
+  struct file_header hdr;
+  coffee_page_t page;
+  unsigned long total, best;
+
+  memset(&wear, 0, sizeof(wear));
+  wear.marker = WEAR_MARKER;
+  wear_state = WEAR_SAVED;
+
+  /* A reboot while the file is rewritten can leave two of them. The
+     counts only grow, so the largest ones are the latest. */
+  best = 0;
+  for(page = 0; page < COFFEE_PAGE_COUNT; page = next_file(page, &hdr)) {
+    read_header(&hdr, page);
+    if(is_wear_file(&hdr)) {
+      total = read_wear_record(page, &record);
+      if(total > best) {
+	best = total;
+	memcpy(wear.erasures, record.erasures, sizeof(wear.erasures));
+      }
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+save_wear_stats(void)
+{
+  struct file_header hdr;
+  coffee_page_t page, old;
+  cfs_offset_t end;
+
+  for(page = 0; page < COFFEE_PAGE_COUNT; page = next_file(page, &hdr)) {
+    read_header(&hdr, page);
+    if(is_wear_file(&hdr)) {
+      /* Append the counts if there is room for them. */
+      end = file_end(page);
+      end = (end + sizeof(wear) - 1) / sizeof(wear) * sizeof(wear);
+      if(sizeof(hdr) + end + sizeof(wear) <=
+	 (cfs_offset_t)hdr.max_pages * COFFEE_PAGE_SIZE) {
+	COFFEE_WRITE(&wear, sizeof(wear), absolute_offset(page, end));
+	wear_state = WEAR_SAVED;
+	return;
+      }
+      break;
+    }
+  }
+
+  /*
+   * Write the counts to a new file before removing the full one. The
+   * allocation does not collect garbage, since that would change the
+   * counts; the counts are saved later if there is no room now.
+   */
+  page = allocate_pages(WEAR_FILE_PAGES, 1);
+  if(page == INVALID_PAGE) {
+    return;
+  }
+
+  memset(&hdr, 0, sizeof(hdr));
+  strncpy(hdr.name, COFFEE_WEAR_FILE, sizeof(hdr.name) - 1);
+  hdr.max_pages = WEAR_FILE_PAGES;
+  hdr.flags = HDR_FLAG_ALLOCATED;
+  write_header(&hdr, page);
+  COFFEE_WRITE(&wear, sizeof(wear), absolute_offset(page, 0));
+  wear_state = WEAR_SAVED;
+#if COFFEE_NAME_INDEX
+  name_index_add(hdr.name, page);
+#endif
+
+  for(old = 0; old < COFFEE_PAGE_COUNT; old = next_file(old, &hdr)) {
+    read_header(&hdr, old);
+    if(old != page && is_wear_file(&hdr)) {
+      remove_by_page(old, REMOVE_LOG, CLOSE_FDS, !ALLOW_GC);
+    }
+  }
+}
+#endif /* COFFEE_WEAR_STATS */
+/*---------------------------------------------------------------------------*/
 static coffee_page_t
-page_count(cfs_offset_t size)
+page_count(cfs_offset_t size, unsigned flags)
 {
-  return (size + sizeof(struct file_header) + COFFEE_PAGE_SIZE - 1) /
-		COFFEE_PAGE_SIZE;
+  /* Log files have no EOF records. */
+  if(!(flags & HDR_FLAG_LOG)) {
+    size += EOF_TABLE_SIZE;
+  }
+  return (size + sizeof(struct file_header) +
+	  COFFEE_PAGE_SIZE - 1) / COFFEE_PAGE_SIZE;
+}
+/*---------------------------------------------------------------------------*/
+static cfs_offset_t
+data_capacity(struct file *file)
+{
+  return (cfs_offset_t)file->max_pages * COFFEE_PAGE_SIZE -
+    sizeof(struct file_header) - (FILE_EOF(file) ? EOF_TABLE_SIZE : 0);
 }
 /*---------------------------------------------------------------------------*/
 static struct file *
@@ -632,18 +1573,20 @@ reserve(const char *name, coffee_page_t pages,
   struct file_header hdr;
   coffee_page_t page;
   struct file *file;
+  int hot;
 
   if(!allow_duplicates && find_file(name) != NULL) {
     return NULL;
   }
 
-  page = find_contiguous_pages(pages);
+  hot = flags & (RESERVE_HOT | HDR_FLAG_LOG);
+  page = allocate_pages(pages, hot);
   if(page == INVALID_PAGE) {
     if(*gc_wait) {
       return NULL;
     }
     collect_garbage(GC_GREEDY);
-    page = find_contiguous_pages(pages);
+    page = allocate_pages(pages, hot);
     if(page == INVALID_PAGE) {
       *gc_wait = 1;
       return NULL;
@@ -653,12 +1596,28 @@ reserve(const char *name, coffee_page_t pages,
   memset(&hdr, 0, sizeof(hdr));
   memcpy(hdr.name, name, sizeof(hdr.name) - 1);
   hdr.max_pages = pages;
-  hdr.flags = HDR_FLAG_ALLOCATED | flags;
+  hdr.flags = HDR_FLAG_ALLOCATED | (flags & ~RESERVE_HOT);
+#if COFFEE_EOF_RECORDS
+  if(!(flags & HDR_FLAG_LOG)) {
+    hdr.flags |= HDR_FLAG_EOF;
+  }
+#endif
   write_header(&hdr, page);
 
+#if COFFEE_NAME_INDEX
+  if(!(flags & HDR_FLAG_LOG)) {
+    name_index_add(hdr.name, page);
+  }
+#endif
+
   PRINTF("Coffee: Reserved %u pages starting from %u for file %s\n",
       pages, page, name);
 
+#if COFFEE_GC_INCREMENTAL
+  /* Refill the reserve of erased sectors before it is needed. */
+  request_gc();
+#endif
+
   file = load_file(page, &hdr);
   if(file != NULL) {
     file->end = 0;
@@ -697,16 +1656,49 @@ modify_log_buffer(uint16_t log_record_size,
 }
 #endif /* COFFEE_MICRO_LOGS */
 /*---------------------------------------------------------------------------*/
+#if COFFEE_MICRO_LOGS && COFFEE_LOG_CACHE
+static uint16_t *
+cache_log_index(coffee_page_t log_page, uint16_t log_records)
+{
+  uint16_t i;
+
+  if(log_records > COFFEE_LOG_CACHE_RECORDS) {
+    return NULL;
+  }
+
+  if(log_index.log_page != log_page) {
+    COFFEE_READ(log_index.indices, log_records * sizeof(log_index.indices[0]),
+		absolute_offset(log_page, 0));
+    for(i = 0; i < log_records && log_index.indices[i] != 0; i++);
+    log_index.records = i;
+    log_index.log_page = log_page;
+  }
+
+  return log_index.indices;
+}
+#endif /* COFFEE_MICRO_LOGS && COFFEE_LOG_CACHE */
+/*---------------------------------------------------------------------------*/
 #if COFFEE_MICRO_LOGS
 static int
-get_record_index(coffee_page_t log_page, uint16_t search_records,
-		 uint16_t region)
+get_record_index(coffee_page_t log_page, uint16_t log_records,
+		 uint16_t search_records, uint16_t region)
 {
   cfs_offset_t base;
   uint16_t processed;
   uint16_t batch_size;
   int16_t match_index, i;
 
+#if COFFEE_LOG_CACHE
+  if(cache_log_index(log_page, log_records) != NULL) {
+    for(i = search_records - 1; i >= 0; i--) {
+      if(log_index.indices[i] - 1 == region) {
+	return i;
+      }
+    }
+    return -1;
+  }
+#endif /* COFFEE_LOG_CACHE */
+
   base = absolute_offset(log_page, sizeof(uint16_t) * search_records);
   batch_size = search_records > COFFEE_LOG_TABLE_LIMIT ?
       		COFFEE_LOG_TABLE_LIMIT : search_records;
@@ -755,7 +1747,8 @@ read_log_page(struct file_header *hdr, int16_t record_count,
   region = modify_log_buffer(log_record_size, &lp->offset, &lp->size);
 
   search_records = record_count < 0 ? log_records : record_count;
-  match_index = get_record_index(hdr->log_page, search_records, region);
+  match_index = get_record_index(hdr->log_page, log_records,
+				 search_records, region);
   if(match_index < 0) {
     return -1;
   }
@@ -782,7 +1775,7 @@ create_log(struct file *file, struct file_header *hdr)
   /* Log index size + log data size. */
   size = log_records * (sizeof(uint16_t) + log_record_size);
 
-  log_file = reserve(hdr->name, page_count(size), 1, HDR_FLAG_LOG);
+  log_file = reserve(hdr->name, page_count(size, HDR_FLAG_LOG), 1, HDR_FLAG_LOG);
   if(log_file == NULL) {
     return INVALID_PAGE;
   }
@@ -806,6 +1799,16 @@ merge_log(coffee_page_t file_page, int extend)
   struct file *new_file;
   int i;
 
+#if COFFEE_MICRO_LOGS && COFFEE_LOG_CACHE
+  if(log_buffer.dirty && log_buffer.file_page == file_page) {
+    if(flush_log_buffer() < 0) {
+      return -1;
+    }
+    /* The flush may have merged the file already. */
+    file_page = log_buffer.file_page;
+  }
+#endif
+
   read_header(&hdr, file_page);
 
   fd = cfs_open(hdr.name, CFS_READ);
@@ -818,7 +1821,14 @@ merge_log(coffee_page_t file_page, int extend)
    * already been accounted for in the previous reservation.
    */
   max_pages = hdr.max_pages << extend;
-  new_file = reserve(hdr.name, max_pages, 1, 0);
+#if COFFEE_EOF_RECORDS
+  /* A file without EOF records may be too full to get them. */
+  if(page_count(coffee_fd_set[fd].file->end, 0) > max_pages) {
+    max_pages = page_count(coffee_fd_set[fd].file->end, 0);
+  }
+#endif
+  new_file = reserve(hdr.name, max_pages, 1,
+		     HDR_MODIFIED(hdr) ? RESERVE_HOT : 0);
   if(new_file == NULL) {
     cfs_close(fd);
     return -1;
@@ -846,6 +1856,13 @@ merge_log(coffee_page_t file_page, int extend)
     }
   }
 
+#if COFFEE_MICRO_LOGS && COFFEE_LOG_CACHE
+  /* The buffered record holds the same data in the new file. */
+  if(log_buffer.file_page == file_page) {
+    log_buffer.file_page = new_file->page;
+  }
+#endif
+
   if(remove_by_page(file_page, REMOVE_LOG, !CLOSE_FDS, !ALLOW_GC) < 0) {
     remove_by_page(new_file->page, !REMOVE_LOG, !CLOSE_FDS, !ALLOW_GC);
     cfs_close(fd);
@@ -860,6 +1877,11 @@ merge_log(coffee_page_t file_page, int extend)
 
   new_file->flags &= ~COFFEE_FILE_MODIFIED;
   new_file->end = offset;
+#if COFFEE_EOF_RECORDS
+  if(FILE_EOF(new_file)) {
+    write_eof_record(new_file);
+  }
+#endif
 
   cfs_close(fd);
 
@@ -877,6 +1899,12 @@ find_next_record(struct file *file, coffee_page_t log_page,
     return file->record_count;
   }
 
+#if COFFEE_LOG_CACHE
+  if(cache_log_index(log_page, log_records) != NULL) {
+    return log_index.records;
+  }
+#endif
+
   preferred_batch_size = log_records > COFFEE_LOG_TABLE_LIMIT ?
 			 COFFEE_LOG_TABLE_LIMIT : log_records;
   {
@@ -906,22 +1934,39 @@ find_next_record(struct file *file, coffee_page_t log_page,
 #endif /* COFFEE_MICRO_LOGS */
 /*---------------------------------------------------------------------------*/
 #if COFFEE_MICRO_LOGS
+static void
+read_log_record(struct file *file, struct file_header *hdr,
+		uint16_t region, uint16_t log_record_size, char *buf)
+{
+  struct log_param lp;
+
+  /* Take the latest log record of the region, or the original data. */
+  lp.offset = (cfs_offset_t)region * log_record_size;
+  lp.buf = buf;
+  lp.size = log_record_size;
+
+  if(!HDR_MODIFIED(*hdr) ||
+     read_log_page(hdr, file->record_count, &lp) < 0) {
+    COFFEE_READ(buf, log_record_size,
+		absolute_offset(file->page, (cfs_offset_t)region *
+				log_record_size));
+  }
+}
+/*---------------------------------------------------------------------------*/
 static int
-write_log_page(struct file *file, struct log_param *lp)
+write_log_record(struct file *file, uint16_t region, const char *buf)
 {
   struct file_header hdr;
-  uint16_t region;
+  struct xmem_iovec iov[2];
   coffee_page_t log_page;
   int16_t log_record;
   uint16_t log_record_size;
   uint16_t log_records;
   cfs_offset_t offset;
-  struct log_param lp_out;
 
   read_header(&hdr, file->page);
 
   adjust_log_config(&hdr, &log_record_size, &log_records);
-  region = modify_log_buffer(log_record_size, &lp->offset, &lp->size);
 
   log_page = 0;
   if(HDR_MODIFIED(hdr)) {
@@ -945,39 +1990,174 @@ write_log_page(struct file *file, struct log_param *lp)
     log_record = 0;
   }
 
+  /*
+   * Write the region number in the region index table, and the record.
+   * The region number is incremented to avoid values of zero.
+   */
+  offset = absolute_offset(log_page, 0);
+  ++region;
+  set_iovec(&iov[0], &region, sizeof(region),
+	    offset + log_record * sizeof(region));
+
+  offset += log_records * sizeof(region);
+  set_iovec(&iov[1], buf, log_record_size,
+	    offset + log_record * log_record_size);
+  COFFEE_WRITEV(iov, 2);
+  file->record_count = log_record + 1;
+
+#if COFFEE_LOG_CACHE
+  if(log_index.log_page == log_page) {
+    log_index.indices[log_record] = region;
+    log_index.records = log_record + 1;
+  }
+#endif
+
+  return log_record_size;
+}
+/*---------------------------------------------------------------------------*/
+#if !COFFEE_LOG_CACHE
+static int
+write_log_page(struct file *file, struct log_param *lp)
+{
+  struct file_header hdr;
+  uint16_t region;
+  uint16_t log_record_size;
+  uint16_t log_records;
+  int r;
+
+  read_header(&hdr, file->page);
+
+  adjust_log_config(&hdr, &log_record_size, &log_records);
+  region = modify_log_buffer(log_record_size, &lp->offset, &lp->size);
+
   {
     char copy_buf[log_record_size];
 
-    lp_out.offset = offset = region * log_record_size;
-    lp_out.buf = copy_buf;
-    lp_out.size = log_record_size;
+    if(lp->offset > 0 || lp->size != log_record_size) {
+      read_log_record(file, &hdr, region, log_record_size, copy_buf);
+    }
+    memcpy(&copy_buf[lp->offset], lp->buf, lp->size);
+
+    r = write_log_record(file, region, copy_buf);
+  }
+
+  return r > 0 ? lp->size : r;
+}
+#endif /* !COFFEE_LOG_CACHE */
+#endif /* COFFEE_MICRO_LOGS */
+/*---------------------------------------------------------------------------*/
+#if COFFEE_MICRO_LOGS && COFFEE_LOG_CACHE
+static struct file *
+find_loaded_file(coffee_page_t page)
+{
+  int i;
 
-    if((lp->offset > 0 || lp->size != log_record_size) &&
-	read_log_page(&hdr, log_record, &lp_out) < 0) {
-      COFFEE_READ(copy_buf, sizeof(copy_buf),
-	  absolute_offset(file->page, offset));
+  for(i = 0; i < COFFEE_MAX_OPEN_FILES; i++) {
+    if(!FILE_FREE(&coffee_files[i]) && coffee_files[i].page == page) {
+      return &coffee_files[i];
     }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static int
+flush_log_buffer(void)
+{
+  struct file *file;
+  int r;
 
-    memcpy(&copy_buf[lp->offset], lp->buf, lp->size);
+  if(!log_buffer.dirty) {
+    return 0;
+  }
+  log_buffer.dirty = 0;
 
-    /*
-     * Write the region number in the region index table.
-     * The region number is incremented to avoid values of zero.
-     */
-    offset = absolute_offset(log_page, 0);
-    ++region;
-    COFFEE_WRITE(&region, sizeof(region),
-		 offset + log_record * sizeof(region));
+  do {
+    /* A merge of the log moves the file and the buffer to a new page. */
+    file = find_loaded_file(log_buffer.file_page);
+    if(file == NULL) {
+      log_buffer.file_page = INVALID_PAGE;
+      return -1;
+    }
+    r = write_log_record(file, log_buffer.region, log_buffer.data);
+  } while(r == 0);
+
+  if(r < 0) {
+    log_buffer.file_page = INVALID_PAGE;
+    return -1;
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static int
+flush_file_log_buffer(struct file *file)
+{
+  if(log_buffer.dirty && log_buffer.file_page == file->page) {
+    return flush_log_buffer();
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static int
+write_log_page(struct file_desc *fdp, struct log_param *lp)
+{
+  struct file_header hdr;
+  struct file *file;
+  uint16_t region;
+  uint16_t log_record_size;
+  uint16_t log_records;
+
+  file = fdp->file;
+  read_header(&hdr, file->page);
+
+  adjust_log_config(&hdr, &log_record_size, &log_records);
+  region = modify_log_buffer(log_record_size, &lp->offset, &lp->size);
 
-    offset += log_records * sizeof(region);
-    COFFEE_WRITE(copy_buf, sizeof(copy_buf),
-		 offset + log_record * log_record_size);
-    file->record_count = log_record + 1;
+  if(log_buffer.file_page != file->page || log_buffer.region != region) {
+    if(flush_log_buffer() < 0) {
+      return -1;
+    }
+
+    /* The flush may have merged this file with its log. */
+    file = fdp->file;
+    read_header(&hdr, file->page);
+
+    read_log_record(file, &hdr, region, log_record_size, log_buffer.data);
+    log_buffer.file_page = file->page;
+    log_buffer.region = region;
   }
 
+  memcpy(&log_buffer.data[lp->offset], lp->buf, lp->size);
+  log_buffer.dirty = 1;
+
   return lp->size;
 }
-#endif /* COFFEE_MICRO_LOGS */
+/*---------------------------------------------------------------------------*/
+static int
+read_log_buffer(struct file *file, struct file_header *hdr,
+		struct log_param *lp)
+{
+  uint16_t region;
+  uint16_t log_record_size;
+  uint16_t log_records;
+  cfs_offset_t offset;
+  uint16_t size;
+
+  if(log_buffer.file_page != file->page) {
+    return -1;
+  }
+
+  adjust_log_config(hdr, &log_record_size, &log_records);
+  offset = lp->offset;
+  size = lp->size;
+  region = modify_log_buffer(log_record_size, &offset, &size);
+  if(region != log_buffer.region) {
+    return -1;
+  }
+
+  memcpy((char *)lp->buf, &log_buffer.data[offset], size);
+  return size;
+}
+#endif /* COFFEE_MICRO_LOGS && COFFEE_LOG_CACHE */
 /*---------------------------------------------------------------------------*/
 static int
 get_available_fd(void)
@@ -1012,7 +2192,7 @@ cfs_open(const char *name, int flags)
     if((flags & (CFS_READ | CFS_WRITE)) == CFS_READ) {
       return -1;
     }
-    fdp->file = reserve(name, page_count(COFFEE_DYN_SIZE), 1, 0);
+    fdp->file = reserve(name, page_count(COFFEE_DYN_SIZE, 0), 1, 0);
     if(fdp->file == NULL) {
       return -1;
     }
@@ -1032,6 +2212,17 @@ void
 cfs_close(int fd)
 {
   if(FD_VALID(fd)) {
+#if COFFEE_MICRO_LOGS && COFFEE_LOG_CACHE
+    flush_file_log_buffer(coffee_fd_set[fd].file);
+#endif
+#if COFFEE_EOF_RECORDS
+    if((coffee_fd_set[fd].file->flags & COFFEE_FILE_EOF_DIRTY) &&
+       write_eof_record(coffee_fd_set[fd].file) < 0) {
+      /* Move the file to get a new table of records. If that fails,
+         the end will be found by scanning from the last record. */
+      merge_log(coffee_fd_set[fd].file->page, 0);
+    }
+#endif
     coffee_fd_set[fd].flags = COFFEE_FD_FREE;
     coffee_fd_set[fd].file->references--;
     coffee_fd_set[fd].file = NULL;
@@ -1059,12 +2250,15 @@ cfs_seek(int fd, cfs_offset_t offset, int whence)
     return (cfs_offset_t)-1;
   }
 
-  if(new_offset < 0 || new_offset > fdp->file->max_pages * COFFEE_PAGE_SIZE) {
+  if(new_offset < 0 || new_offset > data_capacity(fdp->file)) {
     return -1;
   }
 
-  if(fdp->file->end < new_offset) {
+  /* Only writers move the end of the file, so that seeking on a
+     read-only descriptor never writes to the flash memory. */
+  if(FD_WRITABLE(fd) && fdp->file->end < new_offset) {
     fdp->file->end = new_offset;
+    fdp->file->flags |= COFFEE_FILE_EOF_DIRTY;
   }
 
   return fdp->offset = new_offset;
@@ -1107,6 +2301,15 @@ cfs_read(int fd, void *buf, unsigned size)
 
   fdp = &coffee_fd_set[fd];
   file = fdp->file;
+
+#if COFFEE_MICRO_LOGS && COFFEE_LOG_CACHE
+  /* The first log record of a file is only kept in the buffer. */
+  if(!FILE_MODIFIED(file) && flush_file_log_buffer(file) < 0) {
+    return -1;
+  }
+  file = fdp->file;
+#endif
+
   if(fdp->offset + size > file->end) {
     size = file->end - fdp->offset;
   }
@@ -1131,7 +2334,14 @@ cfs_read(int fd, void *buf, unsigned size)
     lp.offset = fdp->offset;
     lp.buf = buf;
     lp.size = bytes_left;
+#if COFFEE_LOG_CACHE
+    r = read_log_buffer(file, &hdr, &lp);
+    if(r < 0) {
+      r = read_log_page(&hdr, file->record_count, &lp);
+    }
+#else
     r = read_log_page(&hdr, file->record_count, &lp);
+#endif
 
     /* Read from the original file if we cannot find the data in the log. */
     if(r < 0) {
@@ -1169,8 +2379,7 @@ cfs_write(int fd, const void *buf, unsigned size)
 #if COFFEE_IO_SEMANTICS
   if(!(fdp->io_flags & CFS_COFFEE_IO_FIRM_SIZE)) {
 #endif
-  while(size + fdp->offset + sizeof(struct file_header) >
-     (file->max_pages * COFFEE_PAGE_SIZE)) {
+  while(size + fdp->offset > data_capacity(file)) {
     if(merge_log(file->page, 1) < 0) {
       return -1;
     }
@@ -1192,7 +2401,12 @@ cfs_write(int fd, const void *buf, unsigned size)
       lp.offset = fdp->offset;
       lp.buf = buf;
       lp.size = bytes_left;
+#if COFFEE_LOG_CACHE
+      i = write_log_page(fdp, &lp);
+      file = fdp->file;
+#else
       i = write_log_page(file, &lp);
+#endif
       if(i < 0) {
 	/* Return -1 if we wrote nothing because the log write failed. */
 	if(size == bytes_left) {
@@ -1212,12 +2426,15 @@ cfs_write(int fd, const void *buf, unsigned size)
            occur while writing log records. */
         if(fdp->offset > file->end) {
           file->end = fdp->offset;
+          file->flags |= COFFEE_FILE_EOF_DIRTY;
         }
       }
     }
 
-    if(fdp->offset > file->end) {
-      /* Update the original file's end with a dummy write. */
+    if(fdp->offset > file->end && fdp->offset < data_capacity(file)) {
+      /* Update the original file's end with a dummy write, unless the
+         file is full and the write would land on its EOF records or
+         on the next file. */
       COFFEE_WRITE(dummy, 1, absolute_offset(file->page, fdp->offset));
     }
   } else {
@@ -1228,6 +2445,17 @@ cfs_write(int fd, const void *buf, unsigned size)
     }
 #endif /* COFFEE_APPEND_ONLY */
 
+#if COFFEE_MICRO_LOGS && COFFEE_LOG_CACHE
+    /* The buffered log record must not hide the data written here. */
+    if(log_buffer.file_page == file->page) {
+      if(flush_log_buffer() < 0) {
+        return -1;
+      }
+      log_buffer.file_page = INVALID_PAGE;
+      file = fdp->file;
+    }
+#endif
+
     COFFEE_WRITE(buf, size, absolute_offset(file->page, fdp->offset));
     fdp->offset += size;
 #if COFFEE_MICRO_LOGS
@@ -1236,11 +2464,141 @@ cfs_write(int fd, const void *buf, unsigned size)
 
   if(fdp->offset > file->end) {
     file->end = fdp->offset;
+    file->flags |= COFFEE_FILE_EOF_DIRTY;
   }
 
   return size;
 }
 /*---------------------------------------------------------------------------*/
+#if CFS_SUBMIT
+#ifdef COFFEE_SUBMIT
+static void
+request_done(struct xmem_request *xreq)
+{
+  struct coffee_request *cr;
+  struct cfs_request *req;
+
+  cr = xreq->ptr;
+  req = cr->req;
+  cr->req = NULL;
+  req->result = xreq->result;
+  if(req->callback != NULL) {
+    req->callback(req);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static struct coffee_request *
+start_request(struct cfs_request *req)
+{
+  struct file *file;
+  struct coffee_request *cr;
+  cfs_offset_t len;
+  int i;
+
+  file = coffee_fd_set[req->fd].file;
+  if(FILE_MODIFIED(file)) {
+    /* The data may be in the micro log. */
+    return NULL;
+  }
+#if COFFEE_MICRO_LOGS && COFFEE_LOG_CACHE
+  if(log_buffer.file_page == file->page) {
+    return NULL;
+  }
+#endif
+  len = req->len;
+  if(req->write) {
+    /* Data that has already been written can only be modified
+       through the micro log, and the file can only be extended by
+       cfs_write(). */
+    if(req->offset < file->end ||
+       req->offset + len > data_capacity(file)) {
+      return NULL;
+    }
+  } else if(req->offset + len > file->end) {
+    len = req->offset < file->end ? file->end - req->offset : 0;
+  }
+
+  for(i = 0; i < COFFEE_MAX_REQUESTS; i++) {
+    cr = &coffee_requests[i];
+    if(cr->req == NULL) {
+      cr->req = req;
+      set_iovec(&cr->iov, req->buf, len,
+		absolute_offset(file->page, req->offset));
+      cr->xmem.iov = &cr->iov;
+      cr->xmem.iovcnt = 1;
+      cr->xmem.write = req->write;
+      cr->xmem.callback = request_done;
+      cr->xmem.ptr = cr;
+      return cr;
+    }
+  }
+  return NULL;
+}
+#endif /* COFFEE_SUBMIT */
+/*---------------------------------------------------------------------------*/
+int
+cfs_submit(struct cfs_request *req)
+{
+  struct file_desc *fdp;
+  cfs_offset_t offset;
+#ifdef COFFEE_SUBMIT
+  struct coffee_request *cr;
+#endif
+
+  if(!FD_VALID(req->fd) || req->offset < 0 ||
+     !(req->write ? FD_WRITABLE(req->fd) : FD_READABLE(req->fd))) {
+    return -1;
+  }
+  fdp = &coffee_fd_set[req->fd];
+
+#ifdef COFFEE_SUBMIT
+  cr = start_request(req);
+  if(cr != NULL) {
+    if(COFFEE_SUBMIT(&cr->xmem) < 0) {
+      cr->req = NULL;
+      return -1;
+    }
+    if(req->write) {
+      fdp->file->end = req->offset + req->len;
+      fdp->file->flags |= COFFEE_FILE_EOF_DIRTY;
+    }
+    return 0;
+  }
+#endif
+
+  /* Do the access at once, without moving the file descriptor. */
+  offset = fdp->offset;
+  if(cfs_seek(req->fd, req->offset, CFS_SEEK_SET) != req->offset) {
+    req->result = -1;
+  } else if(req->write) {
+    req->result = cfs_write(req->fd, req->buf, req->len);
+  } else {
+    req->result = cfs_read(req->fd, req->buf, req->len);
+  }
+  fdp->offset = offset;
+
+  if(req->callback != NULL) {
+    req->callback(req);
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+void
+cfs_wait(struct cfs_request *req)
+{
+#ifdef COFFEE_SUBMIT
+  int i;
+
+  for(i = 0; i < COFFEE_MAX_REQUESTS; i++) {
+    if(coffee_requests[i].req == req) {
+      COFFEE_WAIT(&coffee_requests[i].xmem);
+      return;
+    }
+  }
+#endif
+}
+#endif /* CFS_SUBMIT */
+/*---------------------------------------------------------------------------*/
 int
 cfs_opendir(struct cfs_dir *dir, const char *name)
 {
@@ -1287,7 +2645,7 @@ cfs_closedir(struct cfs_dir *dir)
 int
 cfs_coffee_reserve(const char *name, cfs_offset_t size)
 {
-  return reserve(name, page_count(size), 0, 0) == NULL ? -1 : 0;
+  return reserve(name, page_count(size, 0), 0, 0) == NULL ? -1 : 0;
 }
 /*---------------------------------------------------------------------------*/
 int
@@ -1343,19 +2701,87 @@ cfs_coffee_format(void)
 
   *next_free = 0;
 
+#if COFFEE_WEAR_STATS
+  if(wear_state == WEAR_NONE) {
+    load_wear_stats();
+  }
+#endif
+
   for(i = 0; i < COFFEE_SECTOR_COUNT; i++) {
     COFFEE_ERASE(i);
     PRINTF(".");
+#if COFFEE_WEAR_STATS
+    wear.erasures[i]++;
+    wear_state = WEAR_DIRTY;
+#endif
   }
 
   /* Formatting invalidates the file information. */
   memset(&protected_mem, 0, sizeof(protected_mem));
+#if COFFEE_HOT_COLD_SEPARATION
+  memset(separated_extent, 0, sizeof(separated_extent));
+#endif
+#if COFFEE_MICRO_LOGS && COFFEE_LOG_CACHE
+  log_index.log_page = INVALID_PAGE;
+  log_buffer.file_page = INVALID_PAGE;
+  log_buffer.dirty = 0;
+#endif
+#if COFFEE_WEAR_STATS
+  save_wear_stats();
+#endif
 
   PRINTF(" done!\n");
 
   return 0;
 }
 /*---------------------------------------------------------------------------*/
+int
+cfs_coffee_sync(int fd)
+{
+  if(!FD_VALID(fd)) {
+    return -1;
+  }
+
+#if COFFEE_MICRO_LOGS && COFFEE_LOG_CACHE
+  if(flush_file_log_buffer(coffee_fd_set[fd].file) < 0) {
+    return -1;
+  }
+#endif
+#if COFFEE_EOF_RECORDS
+  if(coffee_fd_set[fd].file->flags & COFFEE_FILE_EOF_DIRTY) {
+    write_eof_record(coffee_fd_set[fd].file);
+  }
+#endif
+
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+void
+cfs_coffee_get_gc_stats(struct cfs_coffee_gc_stats *stats)
+{
+#if COFFEE_GC_STATS
+  memcpy(stats, &gc_stats, sizeof(*stats));
+#else
+  memset(stats, 0, sizeof(*stats));
+#endif
+}
+/*---------------------------------------------------------------------------*/
+long
+cfs_coffee_get_erase_count(unsigned sector)
+{
+#if COFFEE_WEAR_STATS
+  if(sector >= COFFEE_SECTOR_COUNT) {
+    return -1;
+  }
+  if(wear_state == WEAR_NONE) {
+    load_wear_stats();
+  }
+  return wear.erasures[sector];
+#else
+  return -1;
+#endif
+}
+/*---------------------------------------------------------------------------*/
 void *
 cfs_coffee_get_protected_mem(unsigned *size)
 {
@@ -39,6 +39,7 @@
 #define CFS_COFFEE_H
 
 #include "cfs.h"
+#include "sys/rtimer.h"
 
 /**
  * Instruct Coffee that the access pattern to this file is adapted to 
@@ -116,6 +117,19 @@ int cfs_coffee_configure_log(const char *file, unsigned log_size,
  */
 int cfs_coffee_set_io_semantics(int fd, unsigned flags);
 
+/**
+ * \brief Write the pending modifications of a file to the storage.
+ * \param fd The file descriptor through which the file is accessed.
+ * \return 0 on success, -1 on failure.
+ *
+ * With COFFEE_LOG_CACHE, small writes to a file that has a micro log
+ * are gathered in RAM before they are written as a log record, and
+ * with COFFEE_EOF_RECORDS, the end of the file is recorded when the
+ * file is closed. This function does both immediately, so that the
+ * data written so far survives a reboot.
+ */
+int cfs_coffee_sync(int fd);
+
 /**
  * \brief Format the storage area assigned to Coffee.
  * \return 0 on success, -1 on failure.
@@ -126,6 +140,42 @@ int cfs_coffee_set_io_semantics(int fd, unsigned flags);
  */
 int cfs_coffee_format(void);
 
+/**
+ * Garbage collection statistics, as returned by cfs_coffee_get_gc_stats().
+ * The times are in rtimer ticks.
+ */
+struct cfs_coffee_gc_stats {
+  unsigned long runs;               /**< Runs of the garbage collector. */
+  unsigned long erased;             /**< Erased sectors. */
+  unsigned long blocking_runs;      /**< Runs that blocked a reservation. */
+  rtimer_clock_t max_time;          /**< Longest run. */
+  rtimer_clock_t blocking_max_time; /**< Longest run blocking a reservation. */
+};
+
+/**
+ * \brief Get the garbage collection statistics.
+ * \param stats A pointer to the structure that receives the statistics.
+ *
+ * The longest run of the garbage collector is the longest time that
+ * a file operation can be stalled by it. With COFFEE_GC_INCREMENTAL,
+ * most runs happen in the background, and the blocking runs only
+ * occur when a reservation cannot be satisfied from the erased sectors.
+ * The statistics are only kept with COFFEE_GC_STATS, which is enabled
+ * by COFFEE_GC_INCREMENTAL; otherwise they are all zero.
+ */
+void cfs_coffee_get_gc_stats(struct cfs_coffee_gc_stats *stats);
+
+/**
+ * \brief Get the number of times that a sector has been erased.
+ * \param sector The number of the sector, starting from 0.
+ * \return The erase count, or -1 if the sector does not exist or
+ *         COFFEE_WEAR_STATS is disabled.
+ *
+ * The counts include the erasures done by formatting, and are kept
+ * in a file in the storage.
+ */
+long cfs_coffee_get_erase_count(unsigned sector);
+
 /**
  * \brief Points out a memory region that may not be altered during
  * checkpointing operations that use the file system.
@@ -42,13 +42,119 @@
 
 #include "cfs/cfs.h"
 
+#if CFS_MAP
+#ifdef _MSC_VER
+#error "cfs-posix cannot map files into memory on this host"
+#endif
+
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/*
+ * Files opened for reading are mapped into memory. Read-only files
+ * are then read from the mapping, with the file position kept here,
+ * so that cfs_read() and cfs_seek() need no read() or lseek() calls.
+ * Files that are also opened for writing keep using read() and
+ * write(), but can still be accessed through cfs_map().
+ *
+ * Another writer may change the size of a mapped file. cfs_read()
+ * checks the size with fstat() so that it never touches the mapping
+ * past the end of a truncated file, and reads the part of a grown file
+ * that is not mapped with pread(). Only cfs_map() and cfs_close()
+ * replace a mapping, as that invalidates the pointers returned by
+ * cfs_map().
+ */
+#ifdef CFS_POSIX_CONF_MAPPINGS
+#define CFS_POSIX_MAPPINGS CFS_POSIX_CONF_MAPPINGS
+#else
+#define CFS_POSIX_MAPPINGS 8
+#endif
+
+struct mapping {
+  int fd;
+  int flags;
+  unsigned char *base;
+  size_t size;
+  cfs_offset_t pos;
+};
+
+#define IS_READ_ONLY(m) ((m)->flags == CFS_READ)
+
+static struct mapping mappings[CFS_POSIX_MAPPINGS];
+
+/*---------------------------------------------------------------------------*/
+static struct mapping *
+find_mapping(int fd)
+{
+  int i;
+
+  for(i = 0; i < CFS_POSIX_MAPPINGS; i++) {
+    if(mappings[i].flags != 0 && mappings[i].fd == fd) {
+      return &mappings[i];
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static int
+remap(struct mapping *m)
+{
+  struct stat st;
+
+  if(fstat(m->fd, &st) < 0) {
+    return -1;
+  }
+  if((size_t)st.st_size == m->size) {
+    return 0;
+  }
+
+  if(m->base != NULL) {
+    munmap(m->base, m->size);
+    m->base = NULL;
+    m->size = 0;
+  }
+  if(st.st_size > 0) {
+    m->base = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, m->fd, 0);
+    if(m->base == MAP_FAILED) {
+      m->base = NULL;
+      return -1;
+    }
+    m->size = st.st_size;
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+add_mapping(int fd, int flags)
+{
+  struct mapping *m;
+
+  /* Files that do not fit in the table are accessed without mapping. */
+  for(m = mappings; m < &mappings[CFS_POSIX_MAPPINGS]; m++) {
+    if(m->flags == 0) {
+      m->fd = fd;
+      m->flags = flags;
+      m->base = NULL;
+      m->size = 0;
+      m->pos = 0;
+      if(IS_READ_ONLY(m) && remap(m) < 0) {
+        m->flags = 0;
+      }
+      return;
+    }
+  }
+}
+#endif /* CFS_MAP */
+
 /*---------------------------------------------------------------------------*/
 int
 cfs_open(const char *n, int f)
 {
+  int fd;
   int s = 0;
   if(f == CFS_READ) {
-    return open(n, O_RDONLY);
+    fd = open(n, O_RDONLY);
   } else if(f & CFS_WRITE) {
     s = O_CREAT;
     if(f & CFS_READ) {
@@ -61,20 +167,67 @@ cfs_open(const char *n, int f)
     } else {
       s |= O_TRUNC;
     }
-    return open(n, s, 0600);
+    fd = open(n, s, 0600);
+  } else {
+    return -1;
   }
-  return -1;
+#if CFS_MAP
+  if(fd >= 0 && (f & CFS_READ)) {
+    add_mapping(fd, f);
+  }
+#endif
+  return fd;
 }
 /*---------------------------------------------------------------------------*/
 void
 cfs_close(int f)
 {
+#if CFS_MAP
+  struct mapping *m;
+
+  m = find_mapping(f);
+  if(m != NULL) {
+    if(m->base != NULL) {
+      munmap(m->base, m->size);
+    }
+    m->flags = 0;
+  }
+#endif
   close(f);
 }
 /*---------------------------------------------------------------------------*/
 int
 cfs_read(int f, void *b, unsigned int l)
 {
+#if CFS_MAP
+  struct mapping *m;
+  struct stat st;
+  ssize_t r;
+
+  m = find_mapping(f);
+  if(m != NULL && IS_READ_ONLY(m)) {
+    if(fstat(f, &st) < 0) {
+      return -1;
+    }
+    if(m->pos >= st.st_size) {
+      return 0;
+    }
+    if(l > st.st_size - m->pos) {
+      l = st.st_size - m->pos;
+    }
+    if((size_t)m->pos + l > m->size) {
+      /* The file has grown since it was mapped. */
+      r = pread(f, b, l, m->pos);
+      if(r > 0) {
+        m->pos += r;
+      }
+      return r;
+    }
+    memcpy(b, m->base + m->pos, l);
+    m->pos += l;
+    return l;
+  }
+#endif
   return read(f, b, l);
 }
 /*---------------------------------------------------------------------------*/
@@ -87,6 +240,29 @@ cfs_write(int f, const void *b, unsigned int l)
 cfs_offset_t
 cfs_seek(int f, cfs_offset_t o, int w)
 {
+#if CFS_MAP
+  struct mapping *m;
+  struct stat st;
+
+  m = find_mapping(f);
+  if(m != NULL && IS_READ_ONLY(m)) {
+    if(w == CFS_SEEK_CUR) {
+      o += m->pos;
+    } else if(w == CFS_SEEK_END) {
+      if(fstat(f, &st) < 0) {
+        return (cfs_offset_t)-1;
+      }
+      o += st.st_size;
+    } else if(w != CFS_SEEK_SET) {
+      return (cfs_offset_t)-1;
+    }
+    if(o < 0) {
+      return (cfs_offset_t)-1;
+    }
+    m->pos = o;
+    return o;
+  }
+#endif
   if(w == CFS_SEEK_SET) {
     w = SEEK_SET;
   } else if(w == CFS_SEEK_CUR) {
@@ -99,6 +275,24 @@ cfs_seek(int f, cfs_offset_t o, int w)
   return lseek(f, o, w);
 }
 /*---------------------------------------------------------------------------*/
+#if CFS_MAP
+const void *
+cfs_map(int f, cfs_offset_t o, unsigned int l)
+{
+  struct mapping *m;
+
+  m = find_mapping(f);
+  if(m == NULL || o < 0) {
+    return NULL;
+  }
+  /* Follow the current size of the file, which may also have shrunk. */
+  if(remap(m) < 0 || (size_t)o + l > m->size) {
+    return NULL;
+  }
+  return m->base + o;
+}
+#endif /* CFS_MAP */
+/*---------------------------------------------------------------------------*/
 int
 cfs_remove(const char *name)
 {
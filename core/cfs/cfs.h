@@ -66,6 +66,27 @@ typedef int cfs_offset_t;
 typedef CFS_CONF_OFFSET_TYPE cfs_offset_t;
 #endif
 
+/*
+ * Set CFS_CONF_MAP to 1 on back-ends that can map files into memory
+ * (currently cfs-posix). Without it, cfs_map() always fails.
+ */
+#ifdef CFS_CONF_MAP
+#define CFS_MAP CFS_CONF_MAP
+#else
+#define CFS_MAP 0
+#endif
+
+/*
+ * Set CFS_CONF_SUBMIT to 1 on back-ends that can access files
+ * asynchronously (currently Coffee). Without it, cfs_submit() and
+ * cfs_wait() are not available.
+ */
+#ifdef CFS_CONF_SUBMIT
+#define CFS_SUBMIT CFS_CONF_SUBMIT
+#else
+#define CFS_SUBMIT 0
+#endif
+
 struct cfs_dir {
   char dummy_space[32];
 };
@@ -75,6 +96,22 @@ struct cfs_dirent {
   cfs_offset_t size;
 };
 
+/**
+ * An asynchronous read or write of an open file, started by
+ * cfs_submit(). When the access is done, the number of bytes read or
+ * written, or -1, is stored in result and the callback is called.
+ */
+struct cfs_request {
+  int fd;
+  cfs_offset_t offset;
+  void *buf;
+  unsigned int len;
+  unsigned char write;
+  int result;
+  void (*callback)(struct cfs_request *req);
+  void *ptr;
+};
+
 /**
  * Specify that cfs_open() should open a file for reading.
  *
@@ -228,6 +265,66 @@ CCIF int cfs_write(int fd, const void *buf, unsigned int len);
 CCIF cfs_offset_t cfs_seek(int fd, cfs_offset_t offset, int whence);
 #endif
 
+/**
+ * \brief      Map a part of an open file into memory.
+ * \param fd   The file descriptor of the open file.
+ * \param offset The position of the first byte to map.
+ * \param len  The number of bytes to map.
+ * \return     A pointer to the data, or NULL if the range could not
+ *             be mapped.
+ *
+ *             This function gives read-only access to file data
+ *             without copying it. It fails if the file system does
+ *             not support mapping or if the range extends past the
+ *             end of the file, so callers must fall back to
+ *             cfs_read(). The pointer stays valid until the next
+ *             cfs_map() call on the same file or until the file is
+ *             closed. The file must not be truncated in the meantime.
+ *
+ * \sa         CFS_CONF_MAP
+ */
+#if CFS_MAP
+#ifndef cfs_map
+CCIF const void *cfs_map(int fd, cfs_offset_t offset, unsigned int len);
+#endif
+#else
+#define cfs_map(fd, offset, len) NULL
+#endif
+
+/**
+ * \brief      Start an asynchronous read or write of an open file.
+ * \param req  The request, which gives the file, the position and the
+ *             buffer. The position of the file descriptor is not used
+ *             nor moved.
+ * \return     0, or -1 if the access could not be started.
+ *
+ *             The request and its buffer must be kept until the
+ *             callback has been called. This may happen before the
+ *             function returns, when the file system has to do the
+ *             access at once. The file must not be written to, closed
+ *             or removed by other calls until then.
+ *
+ * \sa         cfs_wait()
+ * \sa         CFS_CONF_SUBMIT
+ */
+#if CFS_SUBMIT
+#ifndef cfs_submit
+CCIF int cfs_submit(struct cfs_request *req);
+#endif
+
+/**
+ * \brief      Complete an asynchronous access before returning.
+ * \param req  A request started by cfs_submit().
+ *
+ *             This function is called by a caller that needs the
+ *             buffer of the request back. The callback is called as
+ *             usual, unless the request has already completed.
+ */
+#ifndef cfs_wait
+CCIF void cfs_wait(struct cfs_request *req);
+#endif
+#endif /* CFS_SUBMIT */
+
 /**
  * \brief      Remove a file.
  * \param name The name of the file.
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2013, the Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Asynchronous access to the external memory, for drivers that
+ *         have no DMA. The accesses are done one at a time by a process.
+ */
+
+#include "contiki.h"
+#include "lib/list.h"
+#include "dev/xmem.h"
+
+LIST(requests);
+
+PROCESS(xmem_request_process, "xmem");
+/*---------------------------------------------------------------------------*/
+static void
+do_request(struct xmem_request *req)
+{
+  req->result = req->write ? xmem_pwritev(req->iov, req->iovcnt) :
+			      xmem_preadv(req->iov, req->iovcnt);
+  if(req->callback != NULL) {
+    req->callback(req);
+  }
+}
+/*---------------------------------------------------------------------------*/
+int
+xmem_submit(struct xmem_request *req)
+{
+  if(!process_is_running(&xmem_request_process)) {
+    process_start(&xmem_request_process, NULL);
+  }
+  list_add(requests, req);
+  process_poll(&xmem_request_process);
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+void
+xmem_wait(struct xmem_request *req)
+{
+  struct xmem_request *r;
+
+  for(r = list_head(requests); r != req; r = list_item_next(r)) {
+    if(r == NULL) {
+      return;
+    }
+  }
+
+  /* The requests queued before it are done first, in order. */
+  do {
+    r = list_pop(requests);
+    do_request(r);
+  } while(r != req);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(xmem_request_process, ev, data)
+{
+  struct xmem_request *req;
+
+  PROCESS_BEGIN();
+
+  while(1) {
+    PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_POLL);
+
+    /* Let other processes run between the requests. */
+    req = list_pop(requests);
+    if(req == NULL) {
+      continue;
+    }
+    if(list_head(requests) != NULL) {
+      process_poll(&xmem_request_process);
+    }
+
+    do_request(req);
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
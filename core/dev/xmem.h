@@ -39,4 +39,57 @@ int xmem_pwrite(const void *buf, int nbytes, unsigned long offset);
 
 int xmem_erase(long nbytes, unsigned long offset);
 
+/*
+ * An element of a scatter list, which gives one buffer and the place
+ * in the external memory that it is read from or written to.
+ */
+struct xmem_iovec {
+  void *buf;
+  unsigned long offset;
+  int nbytes;
+};
+
+/*
+ * Vectored access to the external memory. The elements are processed
+ * in order, as a sequence of xmem_pread() or xmem_pwrite() calls
+ * would, but a driver can save the command overhead of each call, for
+ * instance by streaming elements that are contiguous in the memory in
+ * one command. The functions return the total number of bytes read
+ * or written, or -1 on failure.
+ */
+int xmem_preadv(const struct xmem_iovec *iov, int iovcnt);
+
+int xmem_pwritev(const struct xmem_iovec *iov, int iovcnt);
+
+/*
+ * An asynchronous vectored access, which is started by xmem_submit().
+ * When the access is done, its result is stored in the request, as
+ * returned by xmem_preadv() or xmem_pwritev(), and the callback is
+ * called. The request and the scatter list must be kept until then.
+ */
+struct xmem_request {
+  struct xmem_request *next;
+  const struct xmem_iovec *iov;
+  int iovcnt;
+  unsigned char write;
+  int result;
+  void (*callback)(struct xmem_request *req);
+  void *ptr;
+};
+
+/*
+ * Queue an asynchronous access. Drivers that can use DMA implement
+ * this function themselves; the others can be used with
+ * core/dev/xmem-request.c, which does the accesses from a process.
+ * Returns 0, or -1 if the request could not be queued.
+ */
+int xmem_submit(struct xmem_request *req);
+
+/*
+ * Complete a request queued by xmem_submit() before returning, for a
+ * caller that needs its buffers back. The callback is called as
+ * usual. Nothing is done if the request has already completed.
+ */
+void xmem_wait(struct xmem_request *req);
+
 #endif /* XMEM_H */
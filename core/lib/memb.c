@@ -47,12 +47,36 @@
 #include "contiki.h"
 #include "lib/memb.h"
 
+#if MEMB_FREELIST
+/*---------------------------------------------------------------------------*/
+/* Blocks that cannot hold the free list link are searched linearly. */
+#define HAS_FREELIST(m) ((m)->size >= sizeof(void *))
+/*---------------------------------------------------------------------------*/
+static int
+block_index(struct memb *m, void *ptr)
+{
+  unsigned long offset;
+
+  if(!memb_inmemb(m, ptr)) {
+    return -1;
+  }
+  offset = (unsigned long)((char *)ptr - (char *)m->mem);
+  if(offset % m->size != 0) {
+    return -1;
+  }
+  return offset / m->size;
+}
+#endif /* MEMB_FREELIST */
 /*---------------------------------------------------------------------------*/
 void
 memb_init(struct memb *m)
 {
   memset(m->count, 0, m->num);
   memset(m->mem, 0, m->size * m->num);
+#if MEMB_FREELIST
+  m->free = NULL;
+  m->unused = 0;
+#endif /* MEMB_FREELIST */
 }
 /*---------------------------------------------------------------------------*/
 void *
@@ -60,6 +84,28 @@ memb_alloc(struct memb *m)
 {
   int i;
 
+#if MEMB_FREELIST
+  if(HAS_FREELIST(m)) {
+    void *ptr;
+
+    if(m->free != NULL) {
+      /* Reuse the most recently freed block. The link to the next
+	 free block is stored in the beginning of the block itself. */
+      ptr = m->free;
+      memcpy(&m->free, ptr, sizeof(void *));
+      i = block_index(m, ptr);
+    } else if(m->unused < m->num) {
+      /* Hand out a block that has never been used before. */
+      i = m->unused++;
+      ptr = (char *)m->mem + (i * m->size);
+    } else {
+      return NULL;
+    }
+    ++(m->count[i]);
+    return ptr;
+  }
+#endif /* MEMB_FREELIST */
+
   for(i = 0; i < m->num; ++i) {
     if(m->count[i] == 0) {
       /* If this block was unused, we increase the reference count to
@@ -81,6 +127,25 @@ memb_free(struct memb *m, void *ptr)
   int i;
   char *ptr2;
 
+#if MEMB_FREELIST
+  if(HAS_FREELIST(m)) {
+    i = block_index(m, ptr);
+    if(i < 0) {
+      return -1;
+    }
+    if(m->count[i] > 0) {
+      /* Make sure that we don't deallocate free memory, as that would
+	 put the block on the free list twice. */
+      --(m->count[i]);
+      if(m->count[i] == 0) {
+	memcpy(ptr, &m->free, sizeof(void *));
+	m->free = ptr;
+      }
+    }
+    return m->count[i];
+  }
+#endif /* MEMB_FREELIST */
+
   /* Walk through the list of blocks and try to find the block to
      which the pointer "ptr" points to. */
   ptr2 = (char *)m->mem;
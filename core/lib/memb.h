@@ -48,6 +48,13 @@
  * memory by the memb_alloc() function, and are deallocated with the
  * memb_free() function.
  *
+ * By default, memb_alloc() and memb_free() search the block array
+ * linearly. If MEMB_CONF_FREELIST is set to 1 in contiki-conf.h, the
+ * allocator instead threads a list of free blocks through the unused
+ * blocks themselves, which makes both operations take constant time
+ * regardless of the number of blocks. The MEMB() declaration and the
+ * function interface are the same in both modes.
+ *
  * @{
  */
 
@@ -63,8 +70,28 @@
 #ifndef MEMB_H_
 #define MEMB_H_
 
+#include "contiki-conf.h"
 #include "sys/cc.h"
 
+/**
+ * \brief Selects the constant-time free list allocator.
+ *
+ * 0: Disabled (default). Blocks are found by a linear search.
+ * 1: Enabled. Freed blocks are kept on a list that is stored in the
+ *    first bytes of the free blocks themselves. Memory blocks smaller
+ *    than a pointer are still handled with a linear search.
+ *
+ * In free list mode, the first sizeof(void *) bytes of a block that
+ * is handed out again after having been freed contain the list link
+ * rather than the data last written to it. Blocks that have never
+ * been allocated are zero, just like in the default mode.
+ */
+#ifdef MEMB_CONF_FREELIST
+#define MEMB_FREELIST MEMB_CONF_FREELIST
+#else
+#define MEMB_FREELIST 0
+#endif
+
 /**
  * Declare a memory block.
  *
@@ -98,6 +125,12 @@ struct memb {
   unsigned short num;
   char *count;
   void *mem;
+#if MEMB_FREELIST
+  /* Both fields are zero in a MEMB() declaration, so a memory block
+     can be used without calling memb_init() first. */
+  void *free;             /* List of blocks that have been freed. */
+  unsigned short unused;  /* Blocks from this index on were never used. */
+#endif /* MEMB_FREELIST */
 };
 
 /**
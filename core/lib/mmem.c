@@ -46,6 +46,7 @@
 
 #include "mmem.h"
 #include "list.h"
+#include "sys/clock.h"
 #include "contiki-conf.h"
 #include <string.h>
 
@@ -55,10 +56,69 @@
 #define MMEM_SIZE 4096
 #endif
 
+#ifdef MMEM_CONF_LAZY_COMPACTION
+#define MMEM_LAZY_COMPACTION MMEM_CONF_LAZY_COMPACTION
+#else
+#define MMEM_LAZY_COMPACTION 0
+#endif
+
+/* The list of allocated blocks is kept sorted by address. */
 LIST(mmemlist);
 unsigned int avail_memory;
 static char memory[MMEM_SIZE];
 
+static unsigned long compactions;
+static unsigned long bytes_moved;
+static unsigned long compaction_time;
+static rtimer_clock_t compaction_time_max;
+
+/*---------------------------------------------------------------------------*/
+static char *
+block_end(struct mmem *m)
+{
+  return m == NULL ? memory : (char *)m->ptr + m->size;
+}
+/*---------------------------------------------------------------------------*/
+static void
+compaction_done(rtimer_clock_t start, unsigned long moved)
+{
+  rtimer_clock_t t;
+
+  t = RTIMER_NOW() - start;
+  compactions++;
+  bytes_moved += moved;
+  compaction_time += t;
+  if(t > compaction_time_max) {
+    compaction_time_max = t;
+  }
+}
+#if MMEM_LAZY_COMPACTION
+/*---------------------------------------------------------------------------*/
+/* Move all blocks to the beginning of the memory, closing the holes
+   left by freed blocks. */
+static void
+compact(void)
+{
+  struct mmem *n;
+  char *dst;
+  unsigned long moved;
+  rtimer_clock_t start;
+
+  start = RTIMER_NOW();
+  moved = 0;
+  dst = memory;
+  for(n = list_head(mmemlist); n != NULL; n = n->next) {
+    if(n->ptr != dst) {
+      memmove(dst, n->ptr, n->size);
+      n->ptr = dst;
+      moved += n->size;
+    }
+    dst += n->size;
+  }
+  compaction_done(start, moved);
+}
+#endif /* MMEM_LAZY_COMPACTION */
+
 /*---------------------------------------------------------------------------*/
 /**
  * \brief      Allocate a managed memory block
@@ -87,6 +147,34 @@ mmem_alloc(struct mmem *m, unsigned int size)
     return 0;
   }
 
+#if MMEM_LAZY_COMPACTION
+  {
+    struct mmem *n, *prev;
+
+    /* Look for the first hole, or the space after the last block,
+       that is large enough. */
+    prev = NULL;
+    for(n = list_head(mmemlist); n != NULL; n = n->next) {
+      if((char *)n->ptr - block_end(prev) >= size) {
+        break;
+      }
+      prev = n;
+    }
+
+    if(n == NULL && &memory[MMEM_SIZE] - block_end(prev) < size) {
+      /* There is enough free memory, but not in one piece. */
+      compact();
+      prev = list_tail(mmemlist);
+    }
+
+    m->ptr = block_end(prev);
+    m->size = size;
+    list_insert(mmemlist, prev, m);
+    avail_memory -= size;
+    return 1;
+  }
+#endif /* MMEM_LAZY_COMPACTION */
+
   /* We had enough memory so we add this memory block to the end of
      the list of allocated memory blocks. */
   list_add(mmemlist, m);
@@ -118,20 +206,28 @@ mmem_alloc(struct mmem *m, unsigned int size)
 void
 mmem_free(struct mmem *m)
 {
+#if !MMEM_LAZY_COMPACTION
   struct mmem *n;
+  rtimer_clock_t start;
+  unsigned long moved;
 
   if(m->next != NULL) {
+    start = RTIMER_NOW();
+    moved = &memory[MMEM_SIZE - avail_memory] - (char *)m->next->ptr;
+
     /* Compact the memory after the allocation that is to be removed
        by moving it downwards. */
-    memmove(m->ptr, m->next->ptr,
-	    &memory[MMEM_SIZE - avail_memory] - (char *)m->next->ptr);
+    memmove(m->ptr, m->next->ptr, moved);
     
     /* Update all the memory pointers that points to memory that is
        after the allocation that is to be removed. */
     for(n = m->next; n != NULL; n = n->next) {
       n->ptr = (void *)((char *)n->ptr - m->size);
     }
+
+    compaction_done(start, moved);
   }
+#endif /* !MMEM_LAZY_COMPACTION */
 
   avail_memory += m->size;
 
@@ -153,6 +249,47 @@ mmem_init(void)
 {
   list_init(mmemlist);
   avail_memory = MMEM_SIZE;
+  compactions = bytes_moved = compaction_time = 0;
+  compaction_time_max = 0;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * \brief      Get statistics about the managed memory
+ * \param stats A pointer to a struct mmem_stats that is filled in
+ *
+ *             This function reports the number of allocated blocks,
+ *             the amount of free memory and how much of it is
+ *             contiguous, and how often and for how long the memory
+ *             has been compacted since mmem_init() was called.
+ *
+ */
+void
+mmem_get_stats(struct mmem_stats *stats)
+{
+  struct mmem *n, *prev;
+  unsigned int hole;
+
+  stats->blocks = 0;
+  stats->largest_free = 0;
+  prev = NULL;
+  for(n = list_head(mmemlist); n != NULL; n = n->next) {
+    hole = (char *)n->ptr - block_end(prev);
+    if(hole > stats->largest_free) {
+      stats->largest_free = hole;
+    }
+    stats->blocks++;
+    prev = n;
+  }
+  hole = &memory[MMEM_SIZE] - block_end(prev);
+  if(hole > stats->largest_free) {
+    stats->largest_free = hole;
+  }
+
+  stats->free = avail_memory;
+  stats->compactions = compactions;
+  stats->bytes_moved = bytes_moved;
+  stats->compaction_time = compaction_time;
+  stats->compaction_time_max = compaction_time_max;
 }
 /*---------------------------------------------------------------------------*/
 
@@ -44,6 +44,14 @@
  * stays in place. Therefore, a level of indirection is used: access
  * to allocated memory must always be done using a special macro.
  *
+ * By default, the memory is compacted every time a block is freed,
+ * which makes mmem_free() proportional to the amount of memory
+ * allocated after the freed block. If MMEM_CONF_LAZY_COMPACTION is set
+ * to 1 in contiki-conf.h, freeing a block only leaves a hole that
+ * later allocations are fitted into. The memory is then compacted only
+ * when an allocation would otherwise fail. In both modes, allocated
+ * memory may move and must be accessed through MMEM_PTR().
+ *
  * \note This module has not been heavily tested.
  * @{
  */
@@ -59,6 +67,8 @@
 #ifndef MMEM_H_
 #define MMEM_H_
 
+#include "sys/rtimer.h"
+
 /*---------------------------------------------------------------------------*/
 /**
  * \brief      Get a pointer to the managed memory
@@ -83,9 +93,31 @@ struct mmem {
 /* XXX: tagga minne med "interrupt usage", vilke gr att man r
    speciellt varsam under free(). */
 
+/**
+ * Allocation, fragmentation and compaction statistics, as returned by
+ * mmem_get_stats().
+ */
+struct mmem_stats {
+  /** Number of allocated blocks. */
+  unsigned int blocks;
+  /** Total number of free bytes. */
+  unsigned int free;
+  /** Size of the largest contiguous free area. The memory is
+      fragmented when this is smaller than the number of free bytes. */
+  unsigned int largest_free;
+  /** Number of times the memory has been compacted. */
+  unsigned long compactions;
+  /** Number of bytes moved by all compactions. */
+  unsigned long bytes_moved;
+  /** Total and worst-case time spent compacting, in rtimer ticks. */
+  unsigned long compaction_time;
+  rtimer_clock_t compaction_time_max;
+};
+
 int  mmem_alloc(struct mmem *m, unsigned int size);
 void mmem_free(struct mmem *);
 void mmem_init(void);
+void mmem_get_stats(struct mmem_stats *stats);
 
 #endif /* MMEM_H_ */
 
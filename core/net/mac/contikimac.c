@@ -68,6 +68,16 @@
 #else
 #define WITH_CONTIKIMAC_HEADER       1
 #endif
+/* Receivers confirm that they stay awake for the rest of a burst by
+   setting the frame pending bit in their ACK, and senders only skip
+   the wake-up of the next packet of a burst when it was confirmed.
+   Requires software ACKs: hardware ACKs do not have the bit set, so
+   with them every packet of a burst is sent with a full wake-up */
+#ifdef CONTIKIMAC_CONF_WITH_BURST_HANDSHAKE
+#define WITH_BURST_HANDSHAKE         CONTIKIMAC_CONF_WITH_BURST_HANDSHAKE
+#else
+#define WITH_BURST_HANDSHAKE         0
+#endif
 /* More aggressive radio sleeping when channel is busy with other traffic */
 #ifndef WITH_FAST_SLEEP
 #define WITH_FAST_SLEEP              1
@@ -125,8 +135,13 @@ struct hdr {
 static int we_are_receiving_burst = 0;
 
 /* INTER_PACKET_DEADLINE is the maximum time a receiver waits for the
-   next packet of a burst when FRAME_PENDING is set. */
+   next packet of a burst when FRAME_PENDING is set. Each packet of
+   the burst restarts the deadline. */
+#ifdef CONTIKIMAC_CONF_INTER_PACKET_DEADLINE
+#define INTER_PACKET_DEADLINE               CONTIKIMAC_CONF_INTER_PACKET_DEADLINE
+#else
 #define INTER_PACKET_DEADLINE               CLOCK_SECOND / 32
+#endif
 
 /* ContikiMAC performs periodic channel checks. Each channel check
    consists of two or more CCA checks. CCA_COUNT_MAX is the number of
@@ -232,6 +247,9 @@ static int we_are_receiving_burst = 0;
 
 #define ACK_LEN 3
 
+/* Frame pending bit in the first byte of an ACK */
+#define ACK_FRAME_PENDING 0x10
+
 #include <stdio.h>
 static struct rtimer rt;
 static struct pt pt;
@@ -245,6 +263,13 @@ static volatile unsigned char radio_is_on = 0;
 static volatile unsigned char we_are_acking = 0;
 #endif
 
+#if WITH_BURST_HANDSHAKE
+/* Set by send_packet() when the receiver confirmed in its ACK that it
+   stays awake for the next packet of the burst */
+static uint8_t burst_confirmed;
+static clock_time_t burst_confirmed_at;
+#endif /* WITH_BURST_HANDSHAKE */
+
 #define DEBUG 0
 #if DEBUG
 #include <stdio.h>
@@ -750,6 +775,9 @@ send_packet(mac_callback_t mac_callback, void *mac_callback_ptr,
   watchdog_periodic();
   t0 = RTIMER_NOW();
   seqno = packetbuf_attr(PACKETBUF_ATTR_MAC_SEQNO);
+#if WITH_BURST_HANDSHAKE
+  burst_confirmed = 0;
+#endif /* WITH_BURST_HANDSHAKE */
   for(strobes = 0, collisions = 0;
       got_strobe_ack == 0 && collisions == 0 &&
       RTIMER_CLOCK_LT(RTIMER_NOW(), t0 + STROBE_TIME); strobes++) {
@@ -779,6 +807,7 @@ send_packet(mac_callback_t mac_callback, void *mac_callback_ptr,
         if(!is_broadcast) {
           got_strobe_ack = 1;
           encounter_time = txtime;
+          /* The ACK is not available, so the burst is not confirmed */
           break;
         }
       } else if (ret == RADIO_TX_NOACK) {
@@ -805,6 +834,14 @@ send_packet(mac_callback_t mac_callback, void *mac_callback_ptr,
         if(len == ACK_LEN && seqno == ackbuf[ACK_LEN - 1]) {
           got_strobe_ack = 1;
           encounter_time = txtime;
+#if WITH_BURST_HANDSHAKE
+          /* Only the receiver sets the frame pending bit, the ACKs
+             sent by the radio hardware do not */
+          if(ackbuf[0] & ACK_FRAME_PENDING) {
+            burst_confirmed = 1;
+            burst_confirmed_at = clock_time();
+          }
+#endif /* WITH_BURST_HANDSHAKE */
           break;
         } else {
           PRINTF("contikimac: collisions while sending\n");
@@ -860,7 +897,7 @@ send_packet(mac_callback_t mac_callback, void *mac_callback_ptr,
 
   if(!is_broadcast) {
     if(collisions == 0 && is_receiver_awake == 0) {
-      phase_update(packetbuf_addr(PACKETBUF_ADDR_RECEIVER),
+      phase_update(packetbuf_addr(PACKETBUF_ADDR_RECEIVER), CYCLE_TIME,
 		   encounter_time, ret);
     }
   }
@@ -917,7 +954,14 @@ qsend_list(mac_callback_t sent, void *ptr, struct rdc_buf_list *buf_list)
     if(ret == MAC_TX_OK) {
       if(next != NULL) {
         /* We're in a burst, no need to wake the receiver up again */
+#if WITH_BURST_HANDSHAKE
+        /* ...unless it did not confirm that it stays awake, or its
+           inter-packet deadline has passed since it did */
+        is_receiver_awake = burst_confirmed &&
+          clock_time() - burst_confirmed_at < INTER_PACKET_DEADLINE;
+#else /* WITH_BURST_HANDSHAKE */
         is_receiver_awake = 1;
+#endif /* WITH_BURST_HANDSHAKE */
         curr = next;
       }
     } else {
@@ -976,6 +1020,11 @@ input_packet(void)
           we_are_acking = 1;
           /* need to send an ack */
           static uint8_t ackbuf[ACK_LEN] = { 0 };
+#if WITH_BURST_HANDSHAKE
+          /* Confirm that we stay awake for the rest of the burst */
+          ackbuf[0] = packetbuf_attr(PACKETBUF_ATTR_PENDING) ?
+            ACK_FRAME_PENDING : 0;
+#endif /* WITH_BURST_HANDSHAKE */
           ackbuf[ACK_LEN - 1] = packetbuf_attr(PACKETBUF_ATTR_PACKET_ID);
           NETSTACK_RADIO.send(ackbuf, ACK_LEN);
           we_are_acking = 0;
@@ -51,6 +51,8 @@
 #include "lib/list.h"
 #include "lib/memb.h"
 
+#include "net/nbr-table.h"
+
 #include <string.h>
 
 #include <stdio.h>
@@ -79,16 +81,109 @@
 #endif /* CSMA_CONF_MAX_MAC_TRANSMISSIONS */
 #endif /* CSMA_MAX_MAC_TRANSMISSIONS */
 
+/*
+ * With adaptive backoff, the backoff exponent of a neighbor may grow
+ * beyond CSMA_MAX_BACKOFF_EXPONENT, up to
+ * CSMA_ADAPTIVE_MAX_BACKOFF_EXPONENT, in proportion to the moving
+ * average of its failed transmissions. Neighbors that usually
+ * acknowledge keep the normal window, while neighbors that are hard
+ * to reach are retried less often.
+ */
+#ifdef CSMA_CONF_ADAPTIVE_BACKOFF
+#define CSMA_ADAPTIVE_BACKOFF CSMA_CONF_ADAPTIVE_BACKOFF
+#else
+#define CSMA_ADAPTIVE_BACKOFF 0
+#endif /* CSMA_CONF_ADAPTIVE_BACKOFF */
+
+#ifdef CSMA_CONF_ADAPTIVE_MAX_BACKOFF_EXPONENT
+#define CSMA_ADAPTIVE_MAX_BACKOFF_EXPONENT CSMA_CONF_ADAPTIVE_MAX_BACKOFF_EXPONENT
+#else
+#define CSMA_ADAPTIVE_MAX_BACKOFF_EXPONENT (CSMA_MAX_BACKOFF_EXPONENT + 2)
+#endif /* CSMA_CONF_ADAPTIVE_MAX_BACKOFF_EXPONENT */
+
+#if CSMA_ADAPTIVE_BACKOFF && \
+    CSMA_ADAPTIVE_MAX_BACKOFF_EXPONENT < CSMA_MAX_BACKOFF_EXPONENT
+#error CSMA_CONF_ADAPTIVE_MAX_BACKOFF_EXPONENT must not be below CSMA_MAX_BACKOFF_EXPONENT.
+#endif
+
+#define WITH_NEIGHBOR_STATS (CSMA_STATS || CSMA_ADAPTIVE_BACKOFF)
+
 #if CSMA_MAX_MAC_TRANSMISSIONS < 1
 #error CSMA_CONF_MAX_MAC_TRANSMISSIONS must be at least 1.
 #error Change CSMA_CONF_MAX_MAC_TRANSMISSIONS in contiki-conf.h or in your Makefile.
 #endif /* CSMA_CONF_MAX_MAC_TRANSMISSIONS < 1 */
 
+/* The maximum number of co-existing neighbor queues */
+#ifdef CSMA_CONF_MAX_NEIGHBOR_QUEUES
+#define CSMA_MAX_NEIGHBOR_QUEUES CSMA_CONF_MAX_NEIGHBOR_QUEUES
+#else
+#define CSMA_MAX_NEIGHBOR_QUEUES 2
+#endif /* CSMA_CONF_MAX_NEIGHBOR_QUEUES */
+
+/* The number of hash chains used to look up neighbor queues */
+#ifdef CSMA_CONF_NEIGHBOR_HASH_SIZE
+#define CSMA_NEIGHBOR_HASH_SIZE CSMA_CONF_NEIGHBOR_HASH_SIZE
+#else
+#define CSMA_NEIGHBOR_HASH_SIZE ((CSMA_MAX_NEIGHBOR_QUEUES + 3) / 4)
+#endif /* CSMA_CONF_NEIGHBOR_HASH_SIZE */
+
+#define MAX_QUEUED_PACKETS QUEUEBUF_NUM
+
+/*
+ * With fair queueing, neighbors share the packet budget instead of
+ * taking it on a first come, first served basis. A data packet is
+ * only queued if its neighbor holds fewer packets than both
+ * CSMA_MAX_PACKETS_PER_NEIGHBOR and the number of packets still
+ * free, so a single busy neighbor cannot lock out the others.
+ * Routing and neighbor discovery packets may also use the last
+ * CSMA_CONTROL_RESERVE packets and the last
+ * CSMA_CONTROL_NEIGHBOR_RESERVE neighbor queues, and are sent ahead
+ * of the data packets waiting for the same neighbor.
+ */
+#ifdef CSMA_CONF_FAIR_QUEUEING
+#define CSMA_FAIR_QUEUEING CSMA_CONF_FAIR_QUEUEING
+#else
+#define CSMA_FAIR_QUEUEING 0
+#endif /* CSMA_CONF_FAIR_QUEUEING */
+
+#ifdef CSMA_CONF_MAX_PACKETS_PER_NEIGHBOR
+#define CSMA_MAX_PACKETS_PER_NEIGHBOR CSMA_CONF_MAX_PACKETS_PER_NEIGHBOR
+#else
+#define CSMA_MAX_PACKETS_PER_NEIGHBOR (MAX_QUEUED_PACKETS / 2)
+#endif /* CSMA_CONF_MAX_PACKETS_PER_NEIGHBOR */
+
+#ifdef CSMA_CONF_CONTROL_RESERVE
+#define CSMA_CONTROL_RESERVE CSMA_CONF_CONTROL_RESERVE
+#else
+#define CSMA_CONTROL_RESERVE 1
+#endif /* CSMA_CONF_CONTROL_RESERVE */
+
+#ifdef CSMA_CONF_CONTROL_NEIGHBOR_RESERVE
+#define CSMA_CONTROL_NEIGHBOR_RESERVE CSMA_CONF_CONTROL_NEIGHBOR_RESERVE
+#else
+#define CSMA_CONTROL_NEIGHBOR_RESERVE (CSMA_MAX_NEIGHBOR_QUEUES > 1)
+#endif /* CSMA_CONF_CONTROL_NEIGHBOR_RESERVE */
+
+#if CSMA_FAIR_QUEUEING && CSMA_CONTROL_RESERVE >= MAX_QUEUED_PACKETS
+#error CSMA_CONF_CONTROL_RESERVE must be smaller than QUEUEBUF_NUM.
+#endif
+
+#if CSMA_FAIR_QUEUEING && \
+    CSMA_CONTROL_NEIGHBOR_RESERVE >= CSMA_MAX_NEIGHBOR_QUEUES
+#error CSMA_CONF_CONTROL_NEIGHBOR_RESERVE must be smaller than CSMA_CONF_MAX_NEIGHBOR_QUEUES.
+#endif
+
 /* Packet metadata */
 struct qbuf_metadata {
   mac_callback_t sent;
   void *cptr;
   uint8_t max_transmissions;
+#if CSMA_FAIR_QUEUEING
+  uint8_t control;
+#endif /* CSMA_FAIR_QUEUEING */
+#if WITH_NEIGHBOR_STATS
+  clock_time_t queued_at;
+#endif /* WITH_NEIGHBOR_STATS */
 };
 
 /* Every neighbor has its own packet queue */
@@ -101,18 +196,24 @@ struct neighbor_queue {
   LIST_STRUCT(queued_packet_list);
 };
 
-/* The maximum number of co-existing neighbor queues */
-#ifdef CSMA_CONF_MAX_NEIGHBOR_QUEUES
-#define CSMA_MAX_NEIGHBOR_QUEUES CSMA_CONF_MAX_NEIGHBOR_QUEUES
-#else
-#define CSMA_MAX_NEIGHBOR_QUEUES 2
-#endif /* CSMA_CONF_MAX_NEIGHBOR_QUEUES */
-
-#define MAX_QUEUED_PACKETS QUEUEBUF_NUM
 MEMB(neighbor_memb, struct neighbor_queue, CSMA_MAX_NEIGHBOR_QUEUES);
 MEMB(packet_memb, struct rdc_buf_list, MAX_QUEUED_PACKETS);
 MEMB(metadata_memb, struct qbuf_metadata, MAX_QUEUED_PACKETS);
-LIST(neighbor_list);
+
+/* Neighbor queues, hashed on the last byte of the address */
+static void *neighbor_hash[CSMA_NEIGHBOR_HASH_SIZE];
+#define NEIGHBOR_CHAIN(addr) \
+  ((list_t)&neighbor_hash[(addr)->u8[RIMEADDR_SIZE - 1] % \
+                          CSMA_NEIGHBOR_HASH_SIZE])
+
+#if CSMA_FAIR_QUEUEING
+static uint8_t queued_packets;
+static uint8_t queued_neighbors;
+#endif /* CSMA_FAIR_QUEUEING */
+
+#if WITH_NEIGHBOR_STATS
+NBR_TABLE(struct csma_stats, neighbor_stats);
+#endif /* WITH_NEIGHBOR_STATS */
 
 static void packet_sent(void *ptr, int status, int num_transmissions);
 static void transmit_packet_list(void *ptr);
@@ -121,7 +222,7 @@ static void transmit_packet_list(void *ptr);
 static struct neighbor_queue *
 neighbor_queue_from_addr(const rimeaddr_t *addr)
 {
-  struct neighbor_queue *n = list_head(neighbor_list);
+  struct neighbor_queue *n = list_head(NEIGHBOR_CHAIN(addr));
   while(n != NULL) {
     if(rimeaddr_cmp(&n->addr, addr)) {
       return n;
@@ -131,6 +232,58 @@ neighbor_queue_from_addr(const rimeaddr_t *addr)
   return NULL;
 }
 /*---------------------------------------------------------------------------*/
+#if WITH_NEIGHBOR_STATS
+static struct csma_stats *
+stats_from_addr(const rimeaddr_t *addr)
+{
+  struct csma_stats *stats;
+
+  /* Broadcasts are not acknowledged, so they have no statistics. */
+  if(rimeaddr_cmp(addr, &rimeaddr_null)) {
+    return NULL;
+  }
+
+  /* The statistics must not push the routing and neighbor discovery
+     state of another neighbor out of the shared table. */
+  stats = nbr_table_get_from_lladdr(neighbor_stats, addr);
+  if(stats == NULL) {
+    stats = nbr_table_try_add_lladdr(neighbor_stats, addr);
+  }
+  return stats;
+}
+/*---------------------------------------------------------------------------*/
+static void
+update_failure_rate(struct csma_stats *stats, int failed)
+{
+  /* Exponentially weighted moving average with a weight of 1/8 */
+  if(failed) {
+    stats->failure_rate += (255 - stats->failure_rate) >> 3;
+  } else {
+    stats->failure_rate -= stats->failure_rate >> 3;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+packet_done(struct neighbor_queue *n, struct rdc_buf_list *q, int status)
+{
+  struct csma_stats *stats;
+  struct qbuf_metadata *metadata;
+
+  stats = nbr_table_get_from_lladdr(neighbor_stats, &n->addr);
+  if(stats != NULL) {
+    metadata = (struct qbuf_metadata *)q->ptr;
+    stats->packets++;
+    if(status != MAC_TX_OK) {
+      stats->drops++;
+    }
+    if(stats->queued > 0) {
+      stats->queued--;
+    }
+    stats->queueing_delay += clock_time() - metadata->queued_at;
+  }
+}
+#endif /* WITH_NEIGHBOR_STATS */
+/*---------------------------------------------------------------------------*/
 static clock_time_t
 default_timebase(void)
 {
@@ -173,6 +326,9 @@ free_packet(struct neighbor_queue *n, struct rdc_buf_list *p)
     queuebuf_free(p->buf);
     memb_free(&metadata_memb, p->ptr);
     memb_free(&packet_memb, p);
+#if CSMA_FAIR_QUEUEING
+    queued_packets--;
+#endif /* CSMA_FAIR_QUEUEING */
     PRINTF("csma: free_queued_packet, queue length %d\n",
         list_length(n->queued_packet_list));
     if(list_head(n->queued_packet_list) != NULL) {
@@ -186,12 +342,54 @@ free_packet(struct neighbor_queue *n, struct rdc_buf_list *p)
     } else {
       /* This was the last packet in the queue, we free the neighbor */
       ctimer_stop(&n->transmit_timer);
-      list_remove(neighbor_list, n);
+      list_remove(NEIGHBOR_CHAIN(&n->addr), n);
       memb_free(&neighbor_memb, n);
+#if CSMA_FAIR_QUEUEING
+      queued_neighbors--;
+#endif /* CSMA_FAIR_QUEUEING */
     }
   }
 }
 /*---------------------------------------------------------------------------*/
+#if CSMA_FAIR_QUEUEING
+static int
+admit_packet(struct neighbor_queue *n, int control)
+{
+  int free_packets;
+  int length;
+
+  free_packets = MAX_QUEUED_PACKETS - queued_packets;
+  if(control) {
+    return free_packets > 0;
+  }
+
+  free_packets -= CSMA_CONTROL_RESERVE;
+  length = list_length(n->queued_packet_list);
+  return length < CSMA_MAX_PACKETS_PER_NEIGHBOR && length < free_packets;
+}
+/*---------------------------------------------------------------------------*/
+static void
+queue_control_packet(struct neighbor_queue *n, struct rdc_buf_list *q)
+{
+  struct rdc_buf_list *prev;
+  struct rdc_buf_list *next;
+
+  /* The head of the queue may be in transmission already, so control
+     packets go after it and after the control packets queued before. */
+  prev = list_head(n->queued_packet_list);
+  if(prev == NULL) {
+    list_add(n->queued_packet_list, q);
+    return;
+  }
+  for(next = list_item_next(prev);
+      next != NULL && ((struct qbuf_metadata *)next->ptr)->control;
+      next = list_item_next(next)) {
+    prev = next;
+  }
+  list_insert(n->queued_packet_list, prev, q);
+}
+#endif /* CSMA_FAIR_QUEUEING */
+/*---------------------------------------------------------------------------*/
 static void
 packet_sent(void *ptr, int status, int num_transmissions)
 {
@@ -203,12 +401,23 @@ packet_sent(void *ptr, int status, int num_transmissions)
   void *cptr;
   int num_tx;
   int backoff_exponent;
+  int max_backoff_exponent;
   int backoff_transmissions;
+#if WITH_NEIGHBOR_STATS
+  struct csma_stats *stats;
+#endif /* WITH_NEIGHBOR_STATS */
 
   n = ptr;
   if(n == NULL) {
     return;
   }
+#if WITH_NEIGHBOR_STATS
+  stats = nbr_table_get_from_lladdr(neighbor_stats, &n->addr);
+  if(stats != NULL && status != MAC_TX_DEFERRED) {
+    update_failure_rate(stats, status == MAC_TX_COLLISION ||
+                        status == MAC_TX_NOACK);
+  }
+#endif /* WITH_NEIGHBOR_STATS */
   switch(status) {
   case MAC_TX_OK:
   case MAC_TX_NOACK:
@@ -263,9 +472,18 @@ packet_sent(void *ptr, int status, int num_transmissions)
          * each retransmit. */
         backoff_exponent = num_tx;
 
+        max_backoff_exponent = CSMA_MAX_BACKOFF_EXPONENT;
+#if CSMA_ADAPTIVE_BACKOFF
+        if(stats != NULL) {
+          max_backoff_exponent += (stats->failure_rate *
+                                   (CSMA_ADAPTIVE_MAX_BACKOFF_EXPONENT -
+                                    CSMA_MAX_BACKOFF_EXPONENT + 1)) >> 8;
+        }
+#endif /* CSMA_ADAPTIVE_BACKOFF */
+
         /* Truncate the exponent if needed. */
-        if(backoff_exponent > CSMA_MAX_BACKOFF_EXPONENT) {
-          backoff_exponent = CSMA_MAX_BACKOFF_EXPONENT;
+        if(backoff_exponent > max_backoff_exponent) {
+          backoff_exponent = max_backoff_exponent;
         }
 
         /* Proceed to exponentiation. */
@@ -282,9 +500,17 @@ packet_sent(void *ptr, int status, int num_transmissions)
           /* This is needed to correctly attribute energy that we spent
              transmitting this packet. */
           queuebuf_update_attr_from_packetbuf(q->buf);
+#if WITH_NEIGHBOR_STATS
+          if(stats != NULL) {
+            stats->retries++;
+          }
+#endif /* WITH_NEIGHBOR_STATS */
         } else {
           PRINTF("csma: drop with status %d after %d transmissions, %d collisions\n",
                  status, n->transmissions, n->collisions);
+#if WITH_NEIGHBOR_STATS
+          packet_done(n, q, status);
+#endif /* WITH_NEIGHBOR_STATS */
           free_packet(n, q);
           mac_call_sent_callback(sent, cptr, status, num_tx);
         }
@@ -294,6 +520,9 @@ packet_sent(void *ptr, int status, int num_transmissions)
         } else {
           PRINTF("csma: rexmit failed %d: %d\n", n->transmissions, status);
         }
+#if WITH_NEIGHBOR_STATS
+        packet_done(n, q, status);
+#endif /* WITH_NEIGHBOR_STATS */
         free_packet(n, q);
         mac_call_sent_callback(sent, cptr, status, num_tx);
       }
@@ -309,6 +538,13 @@ send_packet(mac_callback_t sent, void *ptr)
   static uint8_t initialized = 0;
   static uint16_t seqno;
   const rimeaddr_t *addr = packetbuf_addr(PACKETBUF_ADDR_RECEIVER);
+#if CSMA_FAIR_QUEUEING
+  int control = packetbuf_attr(PACKETBUF_ATTR_PACKET_TYPE) ==
+    PACKETBUF_ATTR_PACKET_TYPE_CONTROL;
+#endif /* CSMA_FAIR_QUEUEING */
+#if WITH_NEIGHBOR_STATS
+  struct csma_stats *stats = stats_from_addr(addr);
+#endif /* WITH_NEIGHBOR_STATS */
 
   if(!initialized) {
     initialized = 1;
@@ -327,8 +563,18 @@ send_packet(mac_callback_t sent, void *ptr)
   n = neighbor_queue_from_addr(addr);
   if(n == NULL) {
     /* Allocate a new neighbor entry */
+#if CSMA_FAIR_QUEUEING
+    if(control || queued_neighbors <
+       CSMA_MAX_NEIGHBOR_QUEUES - CSMA_CONTROL_NEIGHBOR_RESERVE) {
+      n = memb_alloc(&neighbor_memb);
+    }
+#else /* CSMA_FAIR_QUEUEING */
     n = memb_alloc(&neighbor_memb);
+#endif /* CSMA_FAIR_QUEUEING */
     if(n != NULL) {
+#if CSMA_FAIR_QUEUEING
+      queued_neighbors++;
+#endif /* CSMA_FAIR_QUEUEING */
       /* Init neighbor entry */
       rimeaddr_copy(&n->addr, addr);
       n->transmissions = 0;
@@ -337,13 +583,22 @@ send_packet(mac_callback_t sent, void *ptr)
       /* Init packet list for this neighbor */
       LIST_STRUCT_INIT(n, queued_packet_list);
       /* Add neighbor to the list */
-      list_add(neighbor_list, n);
+      list_add(NEIGHBOR_CHAIN(addr), n);
     }
   }
 
   if(n != NULL) {
     /* Add packet to the neighbor's queue */
+#if CSMA_FAIR_QUEUEING
+    if(admit_packet(n, control)) {
+      q = memb_alloc(&packet_memb);
+    } else {
+      PRINTF("csma: neighbor has used its share, dropping packet\n");
+      q = NULL;
+    }
+#else /* CSMA_FAIR_QUEUEING */
     q = memb_alloc(&packet_memb);
+#endif /* CSMA_FAIR_QUEUEING */
     if(q != NULL) {
       q->ptr = memb_alloc(&metadata_memb);
       if(q->ptr != NULL) {
@@ -360,10 +615,24 @@ send_packet(mac_callback_t sent, void *ptr)
 	  }
 	  metadata->sent = sent;
 	  metadata->cptr = ptr;
+#if CSMA_FAIR_QUEUEING
+	  metadata->control = control;
+	  queued_packets++;
+#endif /* CSMA_FAIR_QUEUEING */
+#if WITH_NEIGHBOR_STATS
+	  metadata->queued_at = clock_time();
+	  if(stats != NULL) {
+	    stats->queued++;
+	  }
+#endif /* WITH_NEIGHBOR_STATS */
 
 	  if(packetbuf_attr(PACKETBUF_ATTR_PACKET_TYPE) ==
 	     PACKETBUF_ATTR_PACKET_TYPE_ACK) {
 	    list_push(n->queued_packet_list, q);
+#if CSMA_FAIR_QUEUEING
+	  } else if(control) {
+	    queue_control_packet(n, q);
+#endif /* CSMA_FAIR_QUEUEING */
 	  } else {
 	    list_add(n->queued_packet_list, q);
 	  }
@@ -382,13 +651,21 @@ send_packet(mac_callback_t sent, void *ptr)
     }
     /* The packet allocation failed. Remove and free neighbor entry if empty. */
     if(list_length(n->queued_packet_list) == 0) {
-      list_remove(neighbor_list, n);
+      list_remove(NEIGHBOR_CHAIN(addr), n);
       memb_free(&neighbor_memb, n);
+#if CSMA_FAIR_QUEUEING
+      queued_neighbors--;
+#endif /* CSMA_FAIR_QUEUEING */
     }
     PRINTF("csma: could not allocate packet, dropping packet\n");
   } else {
     PRINTF("csma: could not allocate neighbor, dropping packet\n");
   }
+#if WITH_NEIGHBOR_STATS
+  if(stats != NULL) {
+    stats->drops++;
+  }
+#endif /* WITH_NEIGHBOR_STATS */
   mac_call_sent_callback(sent, ptr, MAC_TX_ERR, 1);
 }
 /*---------------------------------------------------------------------------*/
@@ -425,7 +702,36 @@ init(void)
   memb_init(&packet_memb);
   memb_init(&metadata_memb);
   memb_init(&neighbor_memb);
+#if WITH_NEIGHBOR_STATS
+  nbr_table_register(neighbor_stats, NULL);
+#endif /* WITH_NEIGHBOR_STATS */
+}
+/*---------------------------------------------------------------------------*/
+#if CSMA_STATS
+const struct csma_stats *
+csma_stats_get(const rimeaddr_t *addr)
+{
+  return nbr_table_get_from_lladdr(neighbor_stats, addr);
+}
+/*---------------------------------------------------------------------------*/
+const struct csma_stats *
+csma_stats_head(void)
+{
+  return nbr_table_head(neighbor_stats);
+}
+/*---------------------------------------------------------------------------*/
+const struct csma_stats *
+csma_stats_next(const struct csma_stats *stats)
+{
+  return nbr_table_next(neighbor_stats, (nbr_table_item_t *)stats);
+}
+/*---------------------------------------------------------------------------*/
+const rimeaddr_t *
+csma_stats_addr(const struct csma_stats *stats)
+{
+  return nbr_table_get_lladdr(neighbor_stats, stats);
 }
+#endif /* CSMA_STATS */
 /*---------------------------------------------------------------------------*/
 const struct mac_driver csma_driver = {
   "CSMA",
@@ -43,9 +43,65 @@
 
 #include "net/mac/mac.h"
 #include "dev/radio.h"
+#include "net/rime/rimeaddr.h"
+
+#ifdef CSMA_CONF_STATS
+#define CSMA_STATS CSMA_CONF_STATS
+#else
+#define CSMA_STATS 0
+#endif /* CSMA_CONF_STATS */
+
+/**
+ * Transmission statistics kept for each neighbor. The counters are
+ * kept in a neighbor table and restart when the neighbor is evicted
+ * from it.
+ */
+struct csma_stats {
+  /** Packets currently queued for the neighbor */
+  uint8_t queued;
+  /** Moving average of failed transmissions, 0 (none) to 255 (all) */
+  uint8_t failure_rate;
+  /** Packets whose transmission has completed, successfully or not */
+  uint16_t packets;
+  /** Retransmissions after a collision or a missing ack */
+  uint16_t retries;
+  /** Packets dropped when queued or after the last retransmission */
+  uint16_t drops;
+  /** Total clock ticks that completed packets spent queued */
+  unsigned long queueing_delay;
+};
 
 extern const struct mac_driver csma_driver;
 
 const struct mac_driver *csma_init(const struct mac_driver *r);
 
+#if CSMA_STATS
+/**
+ * \brief      Get the statistics for a neighbor
+ * \param addr The link-layer address of the neighbor
+ * \return     The statistics, or NULL if none are kept for the neighbor
+ */
+const struct csma_stats *csma_stats_get(const rimeaddr_t *addr);
+
+/**
+ * \brief      Get the first neighbor that statistics are kept for
+ * \return     The statistics, or NULL if there are none
+ */
+const struct csma_stats *csma_stats_head(void);
+
+/**
+ * \brief      Get the next neighbor that statistics are kept for
+ * \param stats The statistics of the current neighbor
+ * \return     The statistics, or NULL if stats was the last
+ */
+const struct csma_stats *csma_stats_next(const struct csma_stats *stats);
+
+/**
+ * \brief      Get the address of the neighbor that statistics belong to
+ * \param stats The statistics of the neighbor
+ * \return     The link-layer address of the neighbor
+ */
+const rimeaddr_t *csma_stats_addr(const struct csma_stats *stats);
+#endif /* CSMA_STATS */
+
 #endif /* CSMA_H_ */
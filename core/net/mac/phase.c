@@ -50,10 +50,39 @@
 #define PHASE_DRIFT_CORRECT 0
 #endif
 
+#if PHASE_DRIFT_CORRECT
+/* The drift of a neighbor is only measured over intervals longer than
+   PHASE_DRIFT_MIN_INTERVAL, as the jitter of a single phase
+   observation is a large part of the drift over a shorter interval. */
+#ifdef PHASE_CONF_DRIFT_MIN_INTERVAL
+#define PHASE_DRIFT_MIN_INTERVAL PHASE_CONF_DRIFT_MIN_INTERVAL
+#else
+#define PHASE_DRIFT_MIN_INTERVAL (CLOCK_SECOND * 30)
+#endif
+
+/* Drift estimates are kept in rtimer ticks per second, as fixed point
+   numbers with PHASE_DRIFT_SHIFT fractional bits. */
+#define PHASE_DRIFT_SHIFT     8
+
+/* Beyond PHASE_DRIFT_MAX_SECONDS, the accumulated drift is no longer
+   extrapolated. */
+#define PHASE_DRIFT_MAX_SECONDS 3600
+
+struct phase_stamp {
+  unsigned long seconds;
+  clock_time_t ticks;
+};
+#endif /* PHASE_DRIFT_CORRECT */
+
 struct phase {
   rtimer_clock_t time;
 #if PHASE_DRIFT_CORRECT
-  rtimer_clock_t drift;
+  /* When the phase was last seen. */
+  struct phase_stamp updated;
+  /* The phase the drift is measured from, and when it was seen. */
+  rtimer_clock_t drift_time;
+  struct phase_stamp drift_updated;
+  int16_t drift;
 #endif
   uint8_t noacks;
   struct timer noacks_timer;
@@ -87,9 +116,99 @@ NBR_TABLE(struct phase, nbr_phase);
 #define PRINTDEBUG(...)
 #endif
 /*---------------------------------------------------------------------------*/
+#if PHASE_DRIFT_CORRECT
+static void
+stamp_set(struct phase_stamp *s)
+{
+  s->seconds = clock_seconds();
+  s->ticks = clock_time();
+}
+/*---------------------------------------------------------------------------*/
+static unsigned long
+stamp_elapsed(const struct phase_stamp *s)
+{
+  unsigned long seconds;
+
+  /* clock_time() may wrap after a few minutes, so longer intervals
+     are measured in seconds. */
+  seconds = clock_seconds() - s->seconds;
+  if(seconds < 128) {
+    return (clock_time_t)(clock_time() - s->ticks);
+  }
+  if(seconds > PHASE_DRIFT_MAX_SECONDS) {
+    seconds = PHASE_DRIFT_MAX_SECONDS;
+  }
+  return seconds * CLOCK_SECOND;
+}
+/*---------------------------------------------------------------------------*/
+/* Returns the phase shift, in rtimer ticks, accumulated by a neighbor
+   with the given drift over elapsed clock ticks. */
+static int32_t
+drift_offset(int16_t drift, unsigned long elapsed)
+{
+  int32_t offset;
+
+  offset = (int32_t)drift * (int32_t)(elapsed / CLOCK_SECOND) +
+    (int32_t)drift * (int32_t)(elapsed % CLOCK_SECOND) / CLOCK_SECOND;
+  return offset / (1 << PHASE_DRIFT_SHIFT);
+}
+/*---------------------------------------------------------------------------*/
+static void
+drift_update(struct phase *e, rtimer_clock_t cycle_time, rtimer_clock_t time)
+{
+  unsigned long elapsed;
+  rtimer_clock_t expected;
+  rtimer_clock_t diff;
+  int32_t error;
+  int32_t drift;
+
+  elapsed = stamp_elapsed(&e->drift_updated);
+  if(elapsed < PHASE_DRIFT_MIN_INTERVAL) {
+    return;
+  }
+
+  /* Compare the observed phase with the one predicted by the current
+     drift estimate. The difference is the phase error, between minus
+     and plus half a cycle. */
+  expected = e->drift_time + drift_offset(e->drift, elapsed);
+  if(!(cycle_time & (cycle_time - 1))) {
+    diff = (rtimer_clock_t)(time - expected) & (cycle_time - 1);
+  } else {
+    diff = (rtimer_clock_t)(time - expected) % cycle_time;
+  }
+  error = diff;
+  if(diff >= cycle_time / 2) {
+    error -= cycle_time;
+  }
+
+  if(error > cycle_time / 4 || error < -(int32_t)(cycle_time / 4)) {
+    /* Too large to be drift: the neighbor has likely changed phase. */
+    PRINTF("phase drift reset, error %ld\n", (long)error);
+    drift = 0;
+  } else {
+    /* Move the estimate half way towards the measured drift. */
+    /* Divide in sixteenths of a second to keep the product in range. */
+    elapsed = elapsed * 16 / CLOCK_SECOND;
+    drift = e->drift + (error * (16 << PHASE_DRIFT_SHIFT) /
+                        (int32_t)(elapsed > 0 ? elapsed : 1)) / 2;
+    if(drift > 0x7fff) {
+      drift = 0x7fff;
+    } else if(drift < -0x8000) {
+      drift = -0x8000;
+    }
+  }
+  PRINTF("phase drift %ld/%d ticks per second\n",
+         (long)drift, 1 << PHASE_DRIFT_SHIFT);
+
+  e->drift = drift;
+  e->drift_time = time;
+  stamp_set(&e->drift_updated);
+}
+#endif /* PHASE_DRIFT_CORRECT */
+/*---------------------------------------------------------------------------*/
 void
-phase_update(const rimeaddr_t *neighbor, rtimer_clock_t time,
-             int mac_status)
+phase_update(const rimeaddr_t *neighbor, rtimer_clock_t cycle_time,
+             rtimer_clock_t time, int mac_status)
 {
   struct phase *e;
 
@@ -98,7 +217,8 @@ phase_update(const rimeaddr_t *neighbor, rtimer_clock_t time,
   if(e != NULL) {
     if(mac_status == MAC_TX_OK) {
 #if PHASE_DRIFT_CORRECT
-      e->drift = time-e->time;
+      drift_update(e, cycle_time, time);
+      stamp_set(&e->updated);
 #endif
       e->time = time;
     }
@@ -126,9 +246,12 @@ phase_update(const rimeaddr_t *neighbor, rtimer_clock_t time,
       if(e) {
         e->time = time;
 #if PHASE_DRIFT_CORRECT
-      e->drift = 0;
+        stamp_set(&e->updated);
+        e->drift_time = time;
+        e->drift_updated = e->updated;
+        e->drift = 0;
 #endif
-      e->noacks = 0;
+        e->noacks = 0;
       }
     }
   }
@@ -186,14 +309,9 @@ phase_wait(const rimeaddr_t *neighbor, rtimer_clock_t cycle_time,
     sync = (e == NULL) ? now : e->time;
 
 #if PHASE_DRIFT_CORRECT
-    {
-      int32_t s;
-      if(e->drift > cycle_time) {
-        s = e->drift % cycle_time / (e->drift / cycle_time);  /* drift per cycle */
-        s = s * (now - sync) / cycle_time;                    /* estimated drift to now */
-        sync += s;                                            /* add it in */
-      }
-    }
+    /* Shift the phase by the drift accumulated since it was last
+       seen. */
+    sync += drift_offset(e->drift, stamp_elapsed(&e->updated));
 #endif
 
     /* Check if cycle_time is a power of two */
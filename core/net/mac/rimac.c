@@ -0,0 +1,616 @@
+/*
+ * Copyright (c) 2013, the Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         A receiver-initiated radio duty cycling protocol, after
+ *         RI-MAC (Y. Sun, O. Gurewitz, D. B. Johnson. RI-MAC: A
+ *         Receiver-Initiated Asynchronous Duty Cycle MAC Protocol for
+ *         Dynamic Traffic Loads in Wireless Sensor Networks, SenSys
+ *         2008)
+ *
+ * Every node periodically turns on its radio, sends a short beacon
+ * and keeps listening for a short dwell time. A node that has a
+ * packet to send turns on its radio and waits for a beacon from the
+ * receiver of the packet, then sends the packet after a random
+ * backoff within the window announced in the beacon. The receiver
+ * acknowledges the packet with a beacon addressed to the sender,
+ * which also invites the next packet, so that queued packets are
+ * sent back to back. Broadcast packets are sent after every beacon
+ * heard during one beacon interval.
+ *
+ * Unlike sender-initiated protocols, the channel is only occupied
+ * by short beacons and by the data packets themselves, not by the
+ * strobe trains of waiting senders.
+ */
+
+#include "contiki-conf.h"
+#include "dev/watchdog.h"
+#include "lib/list.h"
+#include "lib/memb.h"
+#include "lib/random.h"
+#include "net/mac/mac-sequence.h"
+#include "net/mac/rimac.h"
+#include "net/netstack.h"
+#include "net/packetbuf.h"
+#include "net/queuebuf.h"
+#include "sys/ctimer.h"
+#include "sys/pt.h"
+#include "sys/rtimer.h"
+
+#include <string.h>
+
+#if CONTIKI_TARGET_COOJA
+#include "lib/simEnvChange.h"
+#endif /* CONTIKI_TARGET_COOJA */
+
+#define DEBUG 0
+#if DEBUG
+#include <stdio.h>
+#define PRINTF(...) printf(__VA_ARGS__)
+#else
+#define PRINTF(...)
+#endif
+
+/* CYCLE_TIME is the average interval between two beacons. */
+#define CYCLE_TIME (CLOCK_SECOND / NETSTACK_RDC_CHANNEL_CHECK_RATE)
+
+/* DWELL_TIME is the time the radio is kept on after a beacon. */
+#ifdef RIMAC_CONF_DWELL_TIME
+#define DWELL_TIME RIMAC_CONF_DWELL_TIME
+#else
+#define DWELL_TIME (CLOCK_SECOND / 64)
+#endif
+
+/* A dwell time shorter than two clock ticks may expire right after
+   the beacon has been sent. */
+#if DWELL_TIME < 2
+#undef DWELL_TIME
+#define DWELL_TIME 2
+#endif
+
+#define OFF_TIME (CYCLE_TIME - DWELL_TIME)
+
+#if OFF_TIME < 2
+#undef OFF_TIME
+#define OFF_TIME 2
+#endif
+
+/* The backoff window announced in beacons, in backoff slots. Senders
+   wait a random number of slots within the window before sending,
+   to avoid collisions between senders that wait for the same
+   receiver. */
+#ifdef RIMAC_CONF_BACKOFF_WINDOW
+#define BACKOFF_WINDOW RIMAC_CONF_BACKOFF_WINDOW
+#else
+#define BACKOFF_WINDOW 8
+#endif
+
+#define BACKOFF_SLOT_TIME (RTIMER_ARCH_SECOND / 2000)
+
+/* The time a sender waits for the beacon that acknowledges its
+   packet. */
+#define ACK_TIMEOUT (CLOCK_SECOND / 32 > 2 ? CLOCK_SECOND / 32 : 2)
+
+/* The interval at which we check whether a packet that kept the
+   radio on has been received, so that the radio can be turned off. */
+#define OFF_CHECK_TIME (CLOCK_SECOND / 128 > 1 ? CLOCK_SECOND / 128 : 1)
+
+/* Maximum number of transmissions of a unicast packet before it is
+   reported as not acknowledged. */
+#ifdef RIMAC_CONF_MAX_TRANSMISSIONS
+#define MAX_TRANSMISSIONS RIMAC_CONF_MAX_TRANSMISSIONS
+#else
+#define MAX_TRANSMISSIONS 3
+#endif
+
+/* Beacons are sent at random intervals between OFF_TIME / 2 and
+   3 * OFF_TIME / 2. A unicast packet is kept for two cycles, and a
+   broadcast packet is kept until every neighbor has sent a beacon. */
+#define UNICAST_TIMEOUT   (2 * CYCLE_TIME)
+#define BROADCAST_TIMEOUT (3 * OFF_TIME / 2 + DWELL_TIME)
+
+#ifdef QUEUEBUF_CONF_NUM
+#define MAX_QUEUED_PACKETS QUEUEBUF_CONF_NUM / 2
+#else /* QUEUEBUF_CONF_NUM */
+#define MAX_QUEUED_PACKETS 4
+#endif /* QUEUEBUF_CONF_NUM */
+
+#define TYPE_BEACON 1
+#define TYPE_DATA   2
+
+struct rimac_hdr {
+  uint8_t type;
+  uint8_t backoff_window;
+};
+
+struct queue_item {
+  struct queue_item *next;
+  struct queuebuf *packet;
+  struct ctimer removal_timer;
+  mac_callback_t sent_callback;
+  void *sent_callback_ptr;
+  uint8_t transmissions;
+};
+
+LIST(queued_packets_list);
+MEMB(queued_packets_memb, struct queue_item, MAX_QUEUED_PACKETS);
+
+/* The unicast packet that waits for an acknowledgement beacon. */
+static struct queue_item *unacked;
+static struct ctimer ack_timer;
+
+static uint8_t rimac_is_on;
+static uint8_t is_dwelling;
+static uint8_t extend_dwell;
+
+static struct pt dutycycle_pt;
+static struct ctimer dutycycle_timer;
+static struct ctimer off_timer;
+
+/*---------------------------------------------------------------------------*/
+static void
+update_radio(void)
+{
+  if(!rimac_is_on) {
+    return;
+  }
+  /* The radio is kept on while we listen after a beacon and while we
+     wait for beacons from the receivers of our queued packets. */
+  if(is_dwelling || list_head(queued_packets_list) != NULL) {
+    NETSTACK_RADIO.on();
+  } else if(NETSTACK_RADIO.receiving_packet()) {
+    /* Check again when the packet has been received. */
+    ctimer_set(&off_timer, OFF_CHECK_TIME,
+               (void (*)(void *))update_radio, NULL);
+  } else {
+    NETSTACK_RADIO.off();
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+is_broadcast(struct queue_item *i)
+{
+  return rimeaddr_cmp(queuebuf_addr(i->packet, PACKETBUF_ADDR_RECEIVER),
+                      &rimeaddr_null);
+}
+/*---------------------------------------------------------------------------*/
+static void
+remove_queued_packet(struct queue_item *i, int status)
+{
+  mac_callback_t sent;
+  void *ptr;
+  int transmissions;
+
+  if(i == unacked) {
+    unacked = NULL;
+    ctimer_stop(&ack_timer);
+  }
+  ctimer_stop(&i->removal_timer);
+  queuebuf_free(i->packet);
+  list_remove(queued_packets_list, i);
+
+  sent = i->sent_callback;
+  ptr = i->sent_callback_ptr;
+  transmissions = i->transmissions;
+  memb_free(&queued_packets_memb, i);
+
+  update_radio();
+  mac_call_sent_callback(sent, ptr, status, transmissions);
+}
+/*---------------------------------------------------------------------------*/
+static void
+remove_old_packet(void *ptr)
+{
+  struct queue_item *i = ptr;
+
+  if(is_broadcast(i) && i->transmissions > 0) {
+    remove_queued_packet(i, MAC_TX_OK);
+  } else {
+    PRINTF("rimac: no beacon from the receiver\n");
+    remove_queued_packet(i, MAC_TX_NOACK);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+ack_timed_out(void *ptr)
+{
+  struct queue_item *i;
+
+  i = unacked;
+  unacked = NULL;
+  if(i != NULL && i->transmissions >= MAX_TRANSMISSIONS) {
+    remove_queued_packet(i, MAC_TX_NOACK);
+  }
+  /* Otherwise, the packet is sent again after the next beacon from
+     its receiver. */
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_beacon(const rimeaddr_t *receiver)
+{
+  struct rimac_hdr *hdr;
+
+  packetbuf_clear();
+  packetbuf_set_datalen(sizeof(struct rimac_hdr));
+  hdr = packetbuf_dataptr();
+  hdr->type = TYPE_BEACON;
+  hdr->backoff_window = BACKOFF_WINDOW;
+
+  packetbuf_set_addr(PACKETBUF_ADDR_SENDER, &rimeaddr_node_addr);
+  packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, receiver);
+  if(NETSTACK_FRAMER.create() < 0) {
+    PRINTF("rimac: failed to create a beacon\n");
+    return;
+  }
+
+  NETSTACK_RADIO.send(packetbuf_hdrptr(), packetbuf_totlen());
+}
+/*---------------------------------------------------------------------------*/
+static void
+busy_wait(rtimer_clock_t time)
+{
+  rtimer_clock_t t0;
+
+  t0 = RTIMER_NOW();
+  watchdog_periodic();
+  while(RTIMER_CLOCK_LT(RTIMER_NOW(), t0 + time)) {
+#if CONTIKI_TARGET_COOJA
+    simProcessRunValue = 1;
+    cooja_mt_yield();
+#endif /* CONTIKI_TARGET_COOJA */
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+transmit(struct queue_item *i, uint8_t backoff_window)
+{
+  int ret;
+
+  if(backoff_window > 0) {
+    busy_wait(BACKOFF_SLOT_TIME * (random_rand() % (backoff_window + 1)));
+  }
+
+  if(NETSTACK_RADIO.receiving_packet() || !NETSTACK_RADIO.channel_clear()) {
+    /* Another sender was faster. The receiver will send a new beacon
+       when it has received its packet. */
+    PRINTF("rimac: channel busy after beacon\n");
+    return;
+  }
+
+  i->transmissions++;
+  ret = NETSTACK_RADIO.send(queuebuf_dataptr(i->packet),
+                            queuebuf_datalen(i->packet));
+
+  if(is_broadcast(i)) {
+    /* Broadcast packets are removed when the beacon interval is
+       over. */
+    return;
+  }
+
+#if RDC_CONF_HARDWARE_ACK
+  if(ret == RADIO_TX_OK) {
+    remove_queued_packet(i, MAC_TX_OK);
+  } else if(i->transmissions >= MAX_TRANSMISSIONS) {
+    remove_queued_packet(i, MAC_TX_NOACK);
+  }
+#else /* RDC_CONF_HARDWARE_ACK */
+  if(ret == RADIO_TX_OK) {
+    unacked = i;
+    ctimer_set(&ack_timer, ACK_TIMEOUT, ack_timed_out, NULL);
+  } else if(i->transmissions >= MAX_TRANSMISSIONS) {
+    remove_queued_packet(i, MAC_TX_COLLISION);
+  }
+#endif /* RDC_CONF_HARDWARE_ACK */
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * Send beacons and listen for packets. This function is called
+ * repeatedly by a ctimer.
+ */
+static int
+dutycycle(void *ptr)
+{
+  struct ctimer *t = ptr;
+
+  PT_BEGIN(&dutycycle_pt);
+
+  while(1) {
+    if(rimac_is_on) {
+      is_dwelling = 1;
+      update_radio();
+
+      /* A busy channel means that a neighbor is sending, so we only
+         listen. */
+      if(NETSTACK_RADIO.channel_clear()) {
+        send_beacon(&rimeaddr_null);
+      }
+
+      /* Keep listening for as long as we receive packets. */
+      do {
+        extend_dwell = 0;
+        ctimer_set(t, DWELL_TIME, (void (*)(void *))dutycycle, t);
+        PT_YIELD(&dutycycle_pt);
+      } while(extend_dwell);
+
+      is_dwelling = 0;
+      update_radio();
+    }
+
+    /* Randomize the beacon interval so that the beacons of neighbors
+       do not stay synchronized. */
+    ctimer_set(t, OFF_TIME / 2 + random_rand() % OFF_TIME,
+               (void (*)(void *))dutycycle, t);
+    PT_YIELD(&dutycycle_pt);
+  }
+
+  PT_END(&dutycycle_pt);
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_packet(mac_callback_t sent, void *ptr)
+{
+  struct rimac_hdr hdr;
+  struct queue_item *i;
+  clock_time_t timeout;
+
+  hdr.type = TYPE_DATA;
+  hdr.backoff_window = 0;
+  if(!packetbuf_hdralloc(sizeof(struct rimac_hdr))) {
+    mac_call_sent_callback(sent, ptr, MAC_TX_ERR_FATAL, 0);
+    return;
+  }
+  memcpy(packetbuf_hdrptr(), &hdr, sizeof(struct rimac_hdr));
+  packetbuf_compact();
+
+  packetbuf_set_addr(PACKETBUF_ADDR_SENDER, &rimeaddr_node_addr);
+#if RDC_CONF_HARDWARE_ACK
+  packetbuf_set_attr(PACKETBUF_ATTR_MAC_ACK, 1);
+#endif /* RDC_CONF_HARDWARE_ACK */
+
+  if(NETSTACK_FRAMER.create() < 0) {
+    PRINTF("rimac: send failed, too large header\n");
+    mac_call_sent_callback(sent, ptr, MAC_TX_ERR_FATAL, 0);
+    return;
+  }
+
+  i = memb_alloc(&queued_packets_memb);
+  if(i == NULL) {
+    PRINTF("rimac: queue full\n");
+    mac_call_sent_callback(sent, ptr, MAC_TX_ERR, 0);
+    return;
+  }
+  i->packet = queuebuf_new_from_packetbuf();
+  if(i->packet == NULL) {
+    PRINTF("rimac: could not allocate queuebuf\n");
+    memb_free(&queued_packets_memb, i);
+    mac_call_sent_callback(sent, ptr, MAC_TX_ERR, 0);
+    return;
+  }
+  i->sent_callback = sent;
+  i->sent_callback_ptr = ptr;
+  i->transmissions = 0;
+
+  timeout = is_broadcast(i) ? BROADCAST_TIMEOUT : UNICAST_TIMEOUT;
+  ctimer_set(&i->removal_timer, timeout, remove_old_packet, i);
+  list_add(queued_packets_list, i);
+
+  /* Wait for a beacon from the receiver. The packet is sent by
+     input_packet(). */
+  update_radio();
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_list(mac_callback_t sent, void *ptr, struct rdc_buf_list *buf_list)
+{
+  if(buf_list != NULL) {
+    queuebuf_to_packetbuf(buf_list->buf);
+    send_packet(sent, ptr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+beacon_input(struct rimac_hdr *hdr)
+{
+  rimeaddr_t sender;
+  struct queue_item *i;
+  struct queue_item *broadcast;
+  int to_us;
+
+  rimeaddr_copy(&sender, packetbuf_addr(PACKETBUF_ADDR_SENDER));
+  to_us = rimeaddr_cmp(packetbuf_addr(PACKETBUF_ADDR_RECEIVER),
+                       &rimeaddr_node_addr);
+
+  /* A beacon addressed to us from the receiver of our last packet
+     acknowledges the packet. */
+  i = unacked;
+  if(i != NULL &&
+     rimeaddr_cmp(queuebuf_addr(i->packet, PACKETBUF_ADDR_RECEIVER),
+                  &sender)) {
+    unacked = NULL;
+    ctimer_stop(&ack_timer);
+    if(to_us) {
+      PRINTF("rimac: packet acknowledged by %d.%d\n",
+             sender.u8[0], sender.u8[1]);
+      remove_queued_packet(i, MAC_TX_OK);
+    } else if(i->transmissions >= MAX_TRANSMISSIONS) {
+      remove_queued_packet(i, MAC_TX_NOACK);
+    }
+  }
+
+  /* Every beacon invites a packet, so we send the first packet that
+     is queued for the sender of the beacon. A broadcast packet can
+     follow the beacon of any neighbor, but a unicast packet only the
+     beacon of its receiver, so broadcasts only get the beacons for
+     which no unicast packet is queued. */
+  broadcast = NULL;
+  for(i = list_head(queued_packets_list); i != NULL; i = list_item_next(i)) {
+    if(i == unacked) {
+      continue;
+    }
+    if(rimeaddr_cmp(queuebuf_addr(i->packet, PACKETBUF_ADDR_RECEIVER),
+                    &sender)) {
+      break;
+    }
+    if(broadcast == NULL && is_broadcast(i)) {
+      broadcast = i;
+    }
+  }
+  if(i == NULL) {
+    i = broadcast;
+  }
+
+  if(i != NULL) {
+    PRINTF("rimac: beacon from %d.%d, sending packet\n",
+           sender.u8[0], sender.u8[1]);
+    transmit(i, hdr->backoff_window);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+data_input(void)
+{
+  rimeaddr_t sender;
+  struct queuebuf *q;
+  int duplicate;
+
+  if(!rimeaddr_cmp(packetbuf_addr(PACKETBUF_ADDR_RECEIVER),
+                   &rimeaddr_node_addr) &&
+     !rimeaddr_cmp(packetbuf_addr(PACKETBUF_ADDR_RECEIVER),
+                   &rimeaddr_null)) {
+    PRINTF("rimac: not for us\n");
+    return;
+  }
+
+  duplicate = mac_sequence_is_duplicate();
+  if(!duplicate) {
+    mac_sequence_register_seqno();
+  }
+
+  if(rimeaddr_cmp(packetbuf_addr(PACKETBUF_ADDR_RECEIVER),
+                  &rimeaddr_node_addr)) {
+    /* Acknowledge the packet with a beacon, which also invites the
+       next packet. The packet is kept in a queuebuf while the beacon
+       is built in the packetbuf. */
+    rimeaddr_copy(&sender, packetbuf_addr(PACKETBUF_ADDR_SENDER));
+    q = queuebuf_new_from_packetbuf();
+    if(q != NULL) {
+      send_beacon(&sender);
+      queuebuf_to_packetbuf(q);
+      queuebuf_free(q);
+    }
+    extend_dwell = 1;
+  }
+
+  if(duplicate) {
+    PRINTF("rimac: drop duplicate link layer packet %u\n",
+           packetbuf_attr(PACKETBUF_ATTR_PACKET_ID));
+    return;
+  }
+
+  NETSTACK_MAC.input();
+}
+/*---------------------------------------------------------------------------*/
+static void
+input_packet(void)
+{
+  struct rimac_hdr hdr;
+
+  if(NETSTACK_FRAMER.parse() < 0) {
+    PRINTF("rimac: failed to parse %u\n", packetbuf_datalen());
+    return;
+  }
+
+  if(packetbuf_datalen() < sizeof(struct rimac_hdr)) {
+    PRINTF("rimac: too short packet\n");
+    return;
+  }
+  memcpy(&hdr, packetbuf_dataptr(), sizeof(struct rimac_hdr));
+  packetbuf_hdrreduce(sizeof(struct rimac_hdr));
+
+  if(hdr.type == TYPE_BEACON) {
+    beacon_input(&hdr);
+  } else if(hdr.type == TYPE_DATA) {
+    data_input();
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+on(void)
+{
+  rimac_is_on = 1;
+  update_radio();
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+off(int keep_radio_on)
+{
+  rimac_is_on = 0;
+  if(keep_radio_on) {
+    NETSTACK_RADIO.on();
+  } else {
+    NETSTACK_RADIO.off();
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned short
+channel_check_interval(void)
+{
+  return CYCLE_TIME;
+}
+/*---------------------------------------------------------------------------*/
+static void
+init(void)
+{
+  memb_init(&queued_packets_memb);
+  list_init(queued_packets_list);
+
+  rimac_is_on = 1;
+  PT_INIT(&dutycycle_pt);
+  ctimer_set(&dutycycle_timer, random_rand() % CYCLE_TIME,
+             (void (*)(void *))dutycycle, &dutycycle_timer);
+}
+/*---------------------------------------------------------------------------*/
+const struct rdc_driver rimac_driver = {
+  "RI-MAC",
+  init,
+  send_packet,
+  send_list,
+  input_packet,
+  on,
+  off,
+  channel_check_interval,
+};
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,1171 @@
+/*
+ * Copyright (c) 2013, the Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         A time-slotted channel hopping radio duty cycling protocol,
+ *         in the spirit of the TSCH mode of IEEE 802.15.4e
+ *
+ * Time is divided in slots, which are grouped in a slotframe that
+ * repeats over time. All nodes of a network count the slots with the
+ * absolute slot number (ASN). A cell of the schedule is a slot of the
+ * slotframe and a channel offset; the channel of a cell is taken from
+ * the hopping sequence at index (ASN + channel offset) modulo the
+ * length of the sequence, so every cell hops over all channels of the
+ * sequence, and a packet that is lost to interference on one channel
+ * is retransmitted on another one.
+ *
+ * The schedule is static. Slot 0 is a shared cell in which every node
+ * listens, and in which enhanced beacons (EBs) and broadcast packets
+ * are sent. With TSCH_CONF_WITH_RECEIVER_CELLS, every node also
+ * listens in a slot derived from its address, and unicast packets are
+ * sent in the slot of their receiver; otherwise they are sent in the
+ * shared cell. Packets are kept in one queue per neighbor and each
+ * queue is only served in the cells of its neighbor. Senders that
+ * fail to get an acknowledgement back off for a random number of the
+ * cells of the neighbor, as in the CSMA-CA of TSCH.
+ *
+ * The coordinator of the network starts the ASN. Other nodes keep
+ * their radio on and scan the channels of the hopping sequence until
+ * they receive an EB, which carries the ASN of the slot in which it
+ * was sent. The radio driver must timestamp received frames in
+ * PACKETBUF_ATTR_TIMESTAMP, as cc2420 and the Cooja radio do, so that
+ * the node can tell when that slot started. The node then follows
+ * the schedule, and keeps synchronized with the sender of the EB,
+ * its time source, by measuring when the frames of the time source
+ * arrive in its slots. A node that has not heard from its time source
+ * for TSCH_CONF_DESYNC_TIMEOUT leaves the network and scans again.
+ *
+ * The slots are run by an rtimer. Packets are framed by send_packet()
+ * and kept in queuebufs, so that the slot operation only has to hand
+ * them to the radio. Sent callbacks are called from a process once
+ * the slot operation is done with a packet. Unless the radio sends
+ * acknowledgements itself, the slot operation also reads the frames
+ * received in its cells, acknowledges them and passes them to the
+ * process.
+ */
+
+#include "contiki-conf.h"
+#include "dev/watchdog.h"
+#include "lib/random.h"
+#include "net/mac/frame802154.h"
+#include "net/mac/mac-sequence.h"
+#include "net/mac/tsch.h"
+#include "net/netstack.h"
+#include "net/packetbuf.h"
+#include "net/queuebuf.h"
+#include "net/rime/rimeaddr.h"
+#include "sys/ctimer.h"
+#include "sys/pt.h"
+#include "sys/rtimer.h"
+
+#include <string.h>
+
+#if CONTIKI_TARGET_COOJA
+#include "lib/simEnvChange.h"
+#include "dev/cooja-radio.h"
+#endif /* CONTIKI_TARGET_COOJA */
+
+#ifdef CONTIKI_TARGET_SKY
+#include "dev/cc2420.h"
+#endif /* CONTIKI_TARGET_SKY */
+
+#define DEBUG 0
+#if DEBUG
+#include <stdio.h>
+#define PRINTF(...) printf(__VA_ARGS__)
+#else
+#define PRINTF(...)
+#endif
+
+#ifndef RDC_CONF_HARDWARE_ACK
+#define RDC_CONF_HARDWARE_ACK        0
+#endif
+
+#ifndef RDC_CONF_HARDWARE_SEND_ACK
+#define RDC_CONF_HARDWARE_SEND_ACK   1
+#endif
+
+/* The function that sets the channel of the radio. Without it, all
+   cells use the channel the radio driver was configured with. */
+#ifdef TSCH_CONF_SET_CHANNEL
+#define SET_CHANNEL(c) TSCH_CONF_SET_CHANNEL(c)
+#else
+#define SET_CHANNEL(c) (void)(c)
+#endif
+
+/* The channels of the hopping sequence. */
+#ifdef TSCH_CONF_HOPPING_SEQUENCE
+#define HOPPING_SEQUENCE TSCH_CONF_HOPPING_SEQUENCE
+#else
+#define HOPPING_SEQUENCE { 15, 25, 26, 20 }
+#endif
+
+/* Number of slots in the slotframe. */
+#ifdef TSCH_CONF_SLOTFRAME_LENGTH
+#define SLOTFRAME_LENGTH TSCH_CONF_SLOTFRAME_LENGTH
+#else
+#define SLOTFRAME_LENGTH 7
+#endif
+
+/* With receiver cells, every node listens in a slot derived from its
+   address, in which its neighbors send their unicast packets to it. */
+#ifdef TSCH_CONF_WITH_RECEIVER_CELLS
+#define WITH_RECEIVER_CELLS TSCH_CONF_WITH_RECEIVER_CELLS
+#else
+#define WITH_RECEIVER_CELLS 1
+#endif
+
+#if WITH_RECEIVER_CELLS && SLOTFRAME_LENGTH < 2
+#error "TSCH receiver cells need a slotframe of at least two slots"
+#endif
+
+/* The duration of a slot. */
+#ifdef TSCH_CONF_SLOT_DURATION
+#define SLOT_DURATION TSCH_CONF_SLOT_DURATION
+#else
+#define SLOT_DURATION (RTIMER_SECOND / 100)
+#endif
+
+/* The time from the start of a slot to the start of a transmission. */
+#ifdef TSCH_CONF_TX_OFFSET
+#define TX_OFFSET TSCH_CONF_TX_OFFSET
+#else
+#define TX_OFFSET (RTIMER_SECOND / 470)
+#endif
+
+/* The time from the start of a transmission to the detection of the
+   frame by the receiver: the turnaround time of the radio, the
+   preamble and the start of frame delimiter. */
+#ifdef TSCH_CONF_TX_DELAY
+#define TX_DELAY TSCH_CONF_TX_DELAY
+#else
+#define TX_DELAY (RTIMER_SECOND / 2840)
+#endif
+
+/* Receivers listen from GUARD_TIME before until GUARD_TIME after the
+   expected start of a frame. */
+#ifdef TSCH_CONF_GUARD_TIME
+#define GUARD_TIME TSCH_CONF_GUARD_TIME
+#else
+#define GUARD_TIME (RTIMER_SECOND / 910)
+#endif
+
+#ifdef TSCH_CONF_ACK_WAIT_TIME
+#define ACK_WAIT_TIME TSCH_CONF_ACK_WAIT_TIME
+#else
+#define ACK_WAIT_TIME (RTIMER_SECOND / 2500)
+#endif
+
+#ifdef TSCH_CONF_AFTER_ACK_DETECTED_WAIT_TIME
+#define AFTER_ACK_DETECTED_WAIT_TIME TSCH_CONF_AFTER_ACK_DETECTED_WAIT_TIME
+#else
+#define AFTER_ACK_DETECTED_WAIT_TIME (RTIMER_SECOND / 1500)
+#endif
+
+/* The duration of the longest frame: 133 bytes at 250 kbit/s. */
+#define MAX_FRAME_TIME (RTIMER_SECOND / 235 + 1)
+
+/* The interval between two EBs of a node. */
+#ifdef TSCH_CONF_EB_PERIOD
+#define EB_PERIOD TSCH_CONF_EB_PERIOD
+#else
+#define EB_PERIOD (4 * CLOCK_SECOND)
+#endif
+
+/* A node leaves the network when it has not synchronized with its
+   time source for this long. */
+#ifdef TSCH_CONF_DESYNC_TIMEOUT
+#define DESYNC_TIMEOUT TSCH_CONF_DESYNC_TIMEOUT
+#else
+#define DESYNC_TIMEOUT (5 * EB_PERIOD)
+#endif
+
+/* The time a scanning node listens on each channel. */
+#define SCAN_CHANNEL_TIME CLOCK_SECOND
+
+/* Maximum number of transmissions of a unicast packet, unless the
+   packet sets PACKETBUF_ATTR_MAX_MAC_TRANSMISSIONS. */
+#ifdef TSCH_CONF_MAX_TRANSMISSIONS
+#define MAX_TRANSMISSIONS TSCH_CONF_MAX_TRANSMISSIONS
+#else
+#define MAX_TRANSMISSIONS 4
+#endif
+
+/* The number of packets in the queue of a neighbor. This must be a
+   power of two. */
+#ifdef TSCH_CONF_QUEUE_SIZE
+#define QUEUE_SIZE TSCH_CONF_QUEUE_SIZE
+#else
+#define QUEUE_SIZE 4
+#endif
+
+#if (QUEUE_SIZE & (QUEUE_SIZE - 1)) != 0
+#error "TSCH_CONF_QUEUE_SIZE must be a power of two"
+#endif
+
+/* The number of neighbors that can have packets queued at the same
+   time, not counting the broadcast queue. */
+#ifdef TSCH_CONF_MAX_NEIGHBOR_QUEUES
+#define MAX_NEIGHBOR_QUEUES TSCH_CONF_MAX_NEIGHBOR_QUEUES
+#else
+#define MAX_NEIGHBOR_QUEUES 4
+#endif
+
+/* Backoff exponents of the CSMA-CA in shared cells. */
+#define MIN_BACKOFF_EXPONENT 1
+#define MAX_BACKOFF_EXPONENT 5
+
+#define ACK_LEN 3
+
+#define TYPE_EB   1
+#define TYPE_DATA 2
+
+/* An EB is made of the type, the ASN of the slot in which it is sent
+   (four bytes, least significant first) and the join priority of the
+   sender, which is its distance in hops to the coordinator. */
+#define EB_ASN_OFFSET  1
+#define EB_JP_OFFSET   5
+#define EB_LEN         6
+
+/* The maximum size of an EB including the frame header. */
+#define EB_BUF_SIZE (EB_LEN + 32)
+
+struct tsch_packet {
+  struct queuebuf *qb;
+  mac_callback_t sent;
+  void *ptr;
+  uint8_t transmissions;
+  uint8_t max_transmissions;
+  uint8_t ret;
+};
+
+/* The packets between done and tx have been sent and wait for their
+   sent callback, the packets between tx and put wait to be sent. put
+   is only changed by send_packet(), tx only by the slot operation and
+   done only by the TSCH process, so the queue needs no locking. */
+struct tsch_neighbor {
+  rimeaddr_t addr;
+  struct tsch_packet packets[QUEUE_SIZE];
+  volatile uint8_t put;
+  volatile uint8_t tx;
+  volatile uint8_t done;
+  uint8_t slot;
+  uint8_t backoff_exponent;
+  uint8_t backoff_window;
+};
+
+/* The first queue is the queue of broadcast packets. */
+static struct tsch_neighbor neighbors[MAX_NEIGHBOR_QUEUES + 1];
+#define BROADCAST_QUEUE (&neighbors[0])
+
+static const uint8_t hopping_sequence[] = HOPPING_SEQUENCE;
+
+static uint8_t tsch_is_on;
+static uint8_t tsch_keep_radio_on;
+static uint8_t is_coordinator;
+static volatile uint8_t associated;
+/* Set when the node has adjusted its slots to its time source after
+   joining. Until then, the node listens longer in its cells. */
+static volatile uint8_t synchronized;
+
+static uint32_t asn;
+static rtimer_clock_t slot_start;
+static uint8_t own_slot;
+static uint8_t join_priority;
+static rimeaddr_t time_source;
+static clock_time_t last_sync;
+
+/* The difference between the arrival time of the last frame received
+   in a cell and its expected arrival time. */
+static volatile int16_t rx_offset;
+static volatile uint8_t rx_offset_valid;
+/* A correction to apply to the start of the next slot. */
+static volatile int16_t sync_correction;
+
+static uint8_t eb_buf[EB_BUF_SIZE];
+static volatile uint8_t eb_len;
+static uint8_t eb_hdr_len;
+static volatile uint8_t eb_due;
+
+#if !RDC_CONF_HARDWARE_SEND_ACK
+/* A frame that the slot operation has received and acknowledged, and
+   that waits for the TSCH process. The slot operation only reads a
+   new frame when rx_len is zero. */
+static uint8_t rx_buf[PACKETBUF_SIZE];
+static volatile uint8_t rx_len;
+#endif /* !RDC_CONF_HARDWARE_SEND_ACK */
+
+static struct rtimer slot_timer;
+static struct pt slot_pt;
+static struct ctimer eb_timer;
+static struct ctimer housekeeping_timer;
+static uint8_t scan_channel;
+
+PROCESS(tsch_process, "TSCH");
+
+#if CONTIKI_TARGET_COOJA
+#define BUSYWAIT_UNTIL_ABS(cond, end)                                   \
+  do {                                                                  \
+    watchdog_periodic();                                                \
+    while(!(cond) && RTIMER_CLOCK_LT(RTIMER_NOW(), (end))) {            \
+      simProcessRunValue = 1;                                           \
+      cooja_mt_yield();                                                 \
+    }                                                                   \
+  } while(0)
+#else /* CONTIKI_TARGET_COOJA */
+#define BUSYWAIT_UNTIL_ABS(cond, end)                                   \
+  do {                                                                  \
+    watchdog_periodic();                                                \
+    while(!(cond) && RTIMER_CLOCK_LT(RTIMER_NOW(), (end)));             \
+  } while(0)
+#endif /* CONTIKI_TARGET_COOJA */
+
+static char slot_operation(struct rtimer *t, void *ptr);
+
+/*---------------------------------------------------------------------------*/
+static uint8_t
+receiver_slot(const rimeaddr_t *addr)
+{
+#if WITH_RECEIVER_CELLS
+  uint16_t id;
+
+  /* Slot 0 is the shared cell. */
+  id = (addr->u8[RIMEADDR_SIZE - 2] << 8) | addr->u8[RIMEADDR_SIZE - 1];
+  return 1 + id % (SLOTFRAME_LENGTH - 1);
+#else /* WITH_RECEIVER_CELLS */
+  return 0;
+#endif /* WITH_RECEIVER_CELLS */
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t
+channel(uint8_t channel_offset)
+{
+  return hopping_sequence[(asn + channel_offset) % sizeof(hopping_sequence)];
+}
+/*---------------------------------------------------------------------------*/
+static int
+has_packet_to_send(struct tsch_neighbor *n)
+{
+  return n->put != n->tx;
+}
+/*---------------------------------------------------------------------------*/
+static struct tsch_neighbor *
+get_neighbor(const rimeaddr_t *addr)
+{
+  struct tsch_neighbor *n;
+  struct tsch_neighbor *empty;
+
+  if(rimeaddr_cmp(addr, &rimeaddr_null)) {
+    return BROADCAST_QUEUE;
+  }
+
+  empty = NULL;
+  for(n = &neighbors[1]; n <= &neighbors[MAX_NEIGHBOR_QUEUES]; n++) {
+    if(rimeaddr_cmp(&n->addr, addr)) {
+      return n;
+    }
+    if(empty == NULL && n->put == n->done) {
+      empty = n;
+    }
+  }
+
+  /* The slot operation ignores the queues that have nothing to send,
+     so an empty queue can be given to another neighbor. */
+  if(empty != NULL) {
+    rimeaddr_copy(&empty->addr, addr);
+    empty->slot = receiver_slot(addr);
+    empty->backoff_exponent = MIN_BACKOFF_EXPONENT;
+    empty->backoff_window = 0;
+  }
+  return empty;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * Pick the neighbor queue to serve in a slot, and count down the
+ * backoff of the queues that are waiting for this slot.
+ */
+static struct tsch_neighbor *
+select_unicast_queue(uint8_t slot)
+{
+  static uint8_t last;
+  struct tsch_neighbor *n;
+  struct tsch_neighbor *selected;
+  uint8_t i;
+
+  /* Start after the queue served last, so that every neighbor gets
+     its turn. */
+  selected = NULL;
+  for(i = 0; i < MAX_NEIGHBOR_QUEUES; i++) {
+    n = &neighbors[1 + (last + 1 + i) % MAX_NEIGHBOR_QUEUES];
+    if(!has_packet_to_send(n) || n->slot != slot) {
+      continue;
+    }
+    if(n->backoff_window > 0) {
+      n->backoff_window--;
+    } else if(selected == NULL) {
+      selected = n;
+      last = (uint8_t)(n - &neighbors[1]);
+    }
+  }
+  return selected;
+}
+/*---------------------------------------------------------------------------*/
+static void
+packet_done(struct tsch_neighbor *n, int ret)
+{
+  n->packets[n->tx % QUEUE_SIZE].ret = ret;
+  n->tx++;
+  process_poll(&tsch_process);
+}
+/*---------------------------------------------------------------------------*/
+static void
+update_backoff(struct tsch_neighbor *n, int success)
+{
+  if(success) {
+    n->backoff_exponent = MIN_BACKOFF_EXPONENT;
+    n->backoff_window = 0;
+  } else {
+    if(n->backoff_exponent < MAX_BACKOFF_EXPONENT) {
+      n->backoff_exponent++;
+    }
+    n->backoff_window = random_rand() % (1 << n->backoff_exponent);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+schedule_slot_operation(struct rtimer *t, rtimer_clock_t time)
+{
+  if(RTIMER_CLOCK_LT(time, RTIMER_NOW() + 2)) {
+    time = RTIMER_NOW() + 2;
+  }
+  if(rtimer_set(t, time, 1,
+                (void (*)(struct rtimer *, void *))slot_operation,
+                NULL) != RTIMER_OK) {
+    PRINTF("tsch: could not set rtimer\n");
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+transmit(const uint8_t *buf, uint8_t len, int is_broadcast)
+{
+  int ret;
+#if !RDC_CONF_HARDWARE_ACK
+  rtimer_clock_t wt;
+  uint8_t seqno;
+  uint8_t ackbuf[ACK_LEN];
+#endif /* !RDC_CONF_HARDWARE_ACK */
+
+  if(!is_broadcast) {
+    /* Listen for the acknowledgement. */
+    NETSTACK_RADIO.on();
+  }
+
+  ret = NETSTACK_RADIO.transmit(len);
+
+  if(is_broadcast) {
+    return ret == RADIO_TX_OK ? MAC_TX_OK : MAC_TX_COLLISION;
+  }
+
+#if RDC_CONF_HARDWARE_ACK
+  switch(ret) {
+  case RADIO_TX_OK:
+    return MAC_TX_OK;
+  case RADIO_TX_NOACK:
+    return MAC_TX_NOACK;
+  default:
+    return MAC_TX_COLLISION;
+  }
+#else /* RDC_CONF_HARDWARE_ACK */
+  if(ret != RADIO_TX_OK) {
+    return MAC_TX_COLLISION;
+  }
+
+  seqno = buf[2];
+  wt = RTIMER_NOW();
+  BUSYWAIT_UNTIL_ABS(0, wt + ACK_WAIT_TIME);
+
+  if(!NETSTACK_RADIO.receiving_packet() &&
+     !NETSTACK_RADIO.pending_packet() &&
+     NETSTACK_RADIO.channel_clear()) {
+    return MAC_TX_NOACK;
+  }
+
+  wt = RTIMER_NOW();
+  BUSYWAIT_UNTIL_ABS(NETSTACK_RADIO.pending_packet(),
+                     wt + AFTER_ACK_DETECTED_WAIT_TIME);
+  if(NETSTACK_RADIO.pending_packet() &&
+     NETSTACK_RADIO.read(ackbuf, ACK_LEN) == ACK_LEN &&
+     ackbuf[ACK_LEN - 1] == seqno) {
+    return MAC_TX_OK;
+  }
+  /* Not an acknowledgement, or not ours. */
+  return MAC_TX_COLLISION;
+#endif /* RDC_CONF_HARDWARE_ACK */
+}
+/*---------------------------------------------------------------------------*/
+#if !RDC_CONF_HARDWARE_SEND_ACK
+/**
+ * Acknowledge a received frame if it is a unicast frame for us. This
+ * is called by the slot operation as soon as the frame has been
+ * received, while its sender waits for the acknowledgement.
+ */
+static void
+send_ack(uint8_t *frame, uint8_t len)
+{
+  frame802154_t f;
+  uint8_t ackbuf[ACK_LEN];
+
+  if(frame802154_parse(frame, len, &f) == 0 ||
+     f.fcf.frame_type != FRAME802154_DATAFRAME ||
+     f.fcf.dest_addr_mode == FRAME802154_NOADDR ||
+     !rimeaddr_cmp((rimeaddr_t *)&f.dest_addr, &rimeaddr_node_addr)) {
+    return;
+  }
+
+  memset(ackbuf, 0, sizeof(ackbuf));
+  ackbuf[ACK_LEN - 1] = f.seq;
+  NETSTACK_RADIO.send(ackbuf, ACK_LEN);
+}
+#endif /* !RDC_CONF_HARDWARE_SEND_ACK */
+/*---------------------------------------------------------------------------*/
+static void
+flush_queues(void)
+{
+  struct tsch_neighbor *n;
+
+  for(n = &neighbors[0]; n <= &neighbors[MAX_NEIGHBOR_QUEUES]; n++) {
+    while(has_packet_to_send(n)) {
+      packet_done(n, MAC_TX_ERR);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * Run the cells of the schedule. This function is called by an
+ * rtimer at the start of every slot, and at the points within the
+ * slot where something has to be done.
+ */
+static char
+slot_operation(struct rtimer *t, void *ptr)
+{
+  static struct tsch_neighbor *n;
+  static struct tsch_packet *p;
+  static const uint8_t *buf;
+  static uint8_t len;
+  static uint8_t slot;
+  static uint8_t is_eb;
+  static uint8_t is_rx;
+  static rtimer_clock_t expected_rx;
+  static rtimer_clock_t guard;
+  rtimer_clock_t rx_start;
+  int ret;
+
+  PT_BEGIN(&slot_pt);
+
+  while(associated) {
+    slot = asn % SLOTFRAME_LENGTH;
+    n = NULL;
+    is_eb = 0;
+    is_rx = 0;
+
+    if(slot == 0) {
+      /* The shared cell. EBs go first, then broadcast packets. */
+      if(eb_due && eb_len > 0) {
+        is_eb = 1;
+      } else if(has_packet_to_send(BROADCAST_QUEUE) &&
+                BROADCAST_QUEUE->backoff_window == 0) {
+        n = BROADCAST_QUEUE;
+      } else {
+        if(BROADCAST_QUEUE->backoff_window > 0) {
+          BROADCAST_QUEUE->backoff_window--;
+        }
+#if !WITH_RECEIVER_CELLS
+        n = select_unicast_queue(0);
+#endif /* !WITH_RECEIVER_CELLS */
+      }
+      is_rx = !is_eb && n == NULL;
+#if WITH_RECEIVER_CELLS
+    } else if(slot == own_slot) {
+      is_rx = 1;
+    } else {
+      n = select_unicast_queue(slot);
+#endif /* WITH_RECEIVER_CELLS */
+    }
+
+    if(is_eb || n != NULL) {
+      /* Transmit. */
+      if(is_eb) {
+        eb_buf[eb_hdr_len + EB_ASN_OFFSET] = asn & 0xff;
+        eb_buf[eb_hdr_len + EB_ASN_OFFSET + 1] = (asn >> 8) & 0xff;
+        eb_buf[eb_hdr_len + EB_ASN_OFFSET + 2] = (asn >> 16) & 0xff;
+        eb_buf[eb_hdr_len + EB_ASN_OFFSET + 3] = (asn >> 24) & 0xff;
+        buf = eb_buf;
+        len = eb_len;
+      } else {
+        p = &n->packets[n->tx % QUEUE_SIZE];
+        /* The queuebufs must be in RAM, as we are in interrupt
+           context. */
+        buf = queuebuf_dataptr(p->qb);
+        len = queuebuf_datalen(p->qb);
+      }
+
+      SET_CHANNEL(channel(slot));
+      NETSTACK_RADIO.prepare(buf, len);
+
+      schedule_slot_operation(t, slot_start + TX_OFFSET);
+      PT_YIELD(&slot_pt);
+
+      ret = transmit(buf, len, is_eb || n == BROADCAST_QUEUE);
+      NETSTACK_RADIO.off();
+
+      if(is_eb) {
+        eb_due = 0;
+      } else if(associated) {
+        p->transmissions++;
+        if(n == BROADCAST_QUEUE) {
+          /* Do not send the next broadcast packet in the same slot as
+             the neighbors that also have one. */
+          n->backoff_window = random_rand() % (1 << MIN_BACKOFF_EXPONENT);
+          packet_done(n, MAC_TX_OK);
+        } else if(ret == MAC_TX_OK) {
+          update_backoff(n, 1);
+          packet_done(n, MAC_TX_OK);
+        } else {
+          PRINTF("tsch: no ack from %d.%d, transmission %d\n",
+                 n->addr.u8[0], n->addr.u8[1], p->transmissions);
+          update_backoff(n, 0);
+          if(p->transmissions >= p->max_transmissions) {
+            packet_done(n, ret);
+          }
+        }
+      }
+    } else if(is_rx) {
+      /* Listen. Until we are synchronized with our time source, we
+         listen for as long as the slot allows. */
+      guard = synchronized ? GUARD_TIME : TX_OFFSET;
+      expected_rx = slot_start + TX_OFFSET + TX_DELAY;
+
+      SET_CHANNEL(channel(slot));
+      schedule_slot_operation(t, expected_rx - guard);
+      PT_YIELD(&slot_pt);
+
+      NETSTACK_RADIO.on();
+      BUSYWAIT_UNTIL_ABS(NETSTACK_RADIO.receiving_packet() ||
+                         NETSTACK_RADIO.pending_packet(),
+                         expected_rx + guard);
+
+      if(NETSTACK_RADIO.receiving_packet()) {
+        rx_start = RTIMER_NOW();
+        rx_offset = (int16_t)(rx_start - expected_rx);
+        rx_offset_valid = 1;
+        BUSYWAIT_UNTIL_ABS(!NETSTACK_RADIO.receiving_packet(),
+                           rx_start + MAX_FRAME_TIME);
+      } else if(NETSTACK_RADIO.pending_packet()) {
+        /* The frame arrived before we could see when. */
+        rx_offset_valid = 0;
+      }
+
+#if RDC_CONF_HARDWARE_SEND_ACK
+      if(NETSTACK_RADIO.pending_packet()) {
+        /* Keep the radio on while the radio acknowledges the frame
+           and until the radio driver has read it. */
+        schedule_slot_operation(t, RTIMER_NOW() + ACK_WAIT_TIME +
+                                AFTER_ACK_DETECTED_WAIT_TIME);
+        PT_YIELD(&slot_pt);
+        while(NETSTACK_RADIO.pending_packet() &&
+              RTIMER_CLOCK_LT(RTIMER_NOW(), slot_start + SLOT_DURATION -
+                              ACK_WAIT_TIME)) {
+          schedule_slot_operation(t, RTIMER_NOW() + ACK_WAIT_TIME);
+          PT_YIELD(&slot_pt);
+        }
+      }
+#else /* RDC_CONF_HARDWARE_SEND_ACK */
+      /* Read the frame and acknowledge it within the slot, as its
+         sender only waits ACK_WAIT_TIME for the acknowledgement. If
+         the previous frame has not been processed yet, the frame is
+         left to the radio driver and is not acknowledged. */
+      if(NETSTACK_RADIO.pending_packet() && rx_len == 0) {
+        ret = NETSTACK_RADIO.read(rx_buf, sizeof(rx_buf));
+        if(ret > 0) {
+          send_ack(rx_buf, ret);
+          rx_len = ret;
+          process_poll(&tsch_process);
+        }
+      }
+#endif /* RDC_CONF_HARDWARE_SEND_ACK */
+      NETSTACK_RADIO.off();
+    }
+
+    /* Move to the next slot, and skip the slots that are already
+       over. */
+    if(sync_correction != 0) {
+      slot_start += sync_correction;
+      sync_correction = 0;
+    }
+    do {
+      slot_start += SLOT_DURATION;
+      asn++;
+    } while(RTIMER_CLOCK_LT(slot_start, RTIMER_NOW() + 2));
+
+    schedule_slot_operation(t, slot_start);
+    PT_YIELD(&slot_pt);
+  }
+
+  /* We have left the network: the queued packets cannot be sent until
+     we join again. The radio stays on to scan for EBs, unless we were
+     turned off. */
+  if(tsch_is_on || tsch_keep_radio_on) {
+    NETSTACK_RADIO.on();
+  } else {
+    NETSTACK_RADIO.off();
+  }
+  flush_queues();
+
+  PT_END(&slot_pt);
+}
+/*---------------------------------------------------------------------------*/
+static void
+start_slot_operation(void)
+{
+  own_slot = receiver_slot(&rimeaddr_node_addr);
+  while(RTIMER_CLOCK_LT(slot_start, RTIMER_NOW() + 2)) {
+    slot_start += SLOT_DURATION;
+    asn++;
+  }
+  NETSTACK_RADIO.off();
+  PT_INIT(&slot_pt);
+  schedule_slot_operation(&slot_timer, slot_start);
+}
+/*---------------------------------------------------------------------------*/
+static void
+start_network(void)
+{
+  PRINTF("tsch: starting a network\n");
+  asn = 0;
+  join_priority = 0;
+  slot_start = RTIMER_NOW();
+  sync_correction = 0;
+  eb_len = 0;
+  synchronized = 1;
+  associated = 1;
+  start_slot_operation();
+}
+/*---------------------------------------------------------------------------*/
+static void
+leave_network(void)
+{
+  if(associated) {
+    PRINTF("tsch: leaving the network\n");
+  }
+  /* The slot operation stops at the start of the next slot. */
+  associated = 0;
+  synchronized = 0;
+  eb_len = 0;
+  eb_due = 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+build_eb(void)
+{
+  uint8_t *hdr;
+
+  packetbuf_clear();
+  packetbuf_set_datalen(EB_LEN);
+  hdr = packetbuf_dataptr();
+  memset(hdr, 0, EB_LEN);
+  hdr[0] = TYPE_EB;
+  hdr[EB_JP_OFFSET] = join_priority;
+
+  packetbuf_set_addr(PACKETBUF_ADDR_SENDER, &rimeaddr_node_addr);
+  packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, &rimeaddr_null);
+  if(NETSTACK_FRAMER.create() < 0 || packetbuf_totlen() > EB_BUF_SIZE) {
+    PRINTF("tsch: failed to create an EB\n");
+    return;
+  }
+
+  /* The slot operation does not use the EB while eb_len is zero. */
+  eb_len = 0;
+  memcpy(eb_buf, packetbuf_hdrptr(), packetbuf_totlen());
+  eb_hdr_len = packetbuf_hdrlen();
+  eb_len = packetbuf_totlen();
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_eb(void *ptr)
+{
+  /* Only nodes that are synchronized can be the time source of
+     other nodes. */
+  if(tsch_is_on && associated && synchronized) {
+    if(eb_len == 0) {
+      build_eb();
+    }
+    eb_due = 1;
+  }
+  ctimer_set(&eb_timer, EB_PERIOD - EB_PERIOD / 4 +
+             random_rand() % (EB_PERIOD / 2 + 1), send_eb, NULL);
+}
+/*---------------------------------------------------------------------------*/
+static void
+housekeeping(void *ptr)
+{
+  if(tsch_is_on && !is_coordinator) {
+    if(associated && clock_time() - last_sync > DESYNC_TIMEOUT) {
+      PRINTF("tsch: lost the time source\n");
+      leave_network();
+    }
+    if(!associated) {
+      /* Scan for EBs on the next channel of the hopping sequence. */
+      scan_channel = (scan_channel + 1) % sizeof(hopping_sequence);
+      SET_CHANNEL(hopping_sequence[scan_channel]);
+      NETSTACK_RADIO.on();
+    }
+  }
+  ctimer_set(&housekeeping_timer, SCAN_CHANNEL_TIME, housekeeping, NULL);
+}
+/*---------------------------------------------------------------------------*/
+static void
+synchronize(const rimeaddr_t *sender)
+{
+  if(!associated || is_coordinator ||
+     !rimeaddr_cmp(sender, &time_source) || !rx_offset_valid) {
+    return;
+  }
+
+  rx_offset_valid = 0;
+  sync_correction = rx_offset;
+  synchronized = 1;
+  last_sync = clock_time();
+  PRINTF("tsch: sync correction %d\n", rx_offset);
+}
+/*---------------------------------------------------------------------------*/
+static void
+eb_input(void)
+{
+  uint8_t *eb;
+  rtimer_clock_t rx_time;
+  uint16_t timestamp;
+
+  if(packetbuf_datalen() < EB_LEN) {
+    return;
+  }
+
+  if(associated || is_coordinator || !tsch_is_on) {
+    synchronize(packetbuf_addr(PACKETBUF_ADDR_SENDER));
+    return;
+  }
+
+  /* Join the network of the sender. The EB was sent at the transmit
+     offset of the slot given in the EB, and the radio driver took the
+     time at which it started to arrive when it received it. */
+  timestamp = packetbuf_attr(PACKETBUF_ATTR_TIMESTAMP);
+  if(timestamp == 0) {
+    PRINTF("tsch: EB without a timestamp\n");
+    return;
+  }
+  /* The timestamp only has the low 16 bits of the rtimer; the EB
+     arrived within the last 65536 ticks. */
+  rx_time = RTIMER_NOW();
+  rx_time -= (uint16_t)((uint16_t)rx_time - timestamp);
+
+  eb = packetbuf_dataptr();
+  asn = (uint32_t)eb[EB_ASN_OFFSET] |
+    ((uint32_t)eb[EB_ASN_OFFSET + 1] << 8) |
+    ((uint32_t)eb[EB_ASN_OFFSET + 2] << 16) |
+    ((uint32_t)eb[EB_ASN_OFFSET + 3] << 24);
+  join_priority = eb[EB_JP_OFFSET] + 1;
+  slot_start = rx_time - TX_DELAY - TX_OFFSET;
+
+  rimeaddr_copy(&time_source, packetbuf_addr(PACKETBUF_ADDR_SENDER));
+  PRINTF("tsch: joining the network of %d.%d at ASN %lu\n",
+         time_source.u8[0], time_source.u8[1], (unsigned long)asn);
+
+  last_sync = clock_time();
+  rx_offset_valid = 0;
+  sync_correction = 0;
+  synchronized = 0;
+  eb_len = 0;
+  associated = 1;
+  start_slot_operation();
+}
+/*---------------------------------------------------------------------------*/
+static void
+data_input(void)
+{
+  int duplicate;
+
+  if(!rimeaddr_cmp(packetbuf_addr(PACKETBUF_ADDR_RECEIVER),
+                   &rimeaddr_node_addr) &&
+     !rimeaddr_cmp(packetbuf_addr(PACKETBUF_ADDR_RECEIVER),
+                   &rimeaddr_null)) {
+    PRINTF("tsch: not for us\n");
+    return;
+  }
+
+  synchronize(packetbuf_addr(PACKETBUF_ADDR_SENDER));
+
+  duplicate = mac_sequence_is_duplicate();
+  if(duplicate) {
+    PRINTF("tsch: drop duplicate link layer packet %u\n",
+           packetbuf_attr(PACKETBUF_ATTR_PACKET_ID));
+    return;
+  }
+  mac_sequence_register_seqno();
+
+  NETSTACK_MAC.input();
+}
+/*---------------------------------------------------------------------------*/
+static void
+input_packet(void)
+{
+  uint8_t type;
+
+  if(packetbuf_datalen() == ACK_LEN) {
+    /* A late acknowledgement. */
+    return;
+  }
+
+  if(NETSTACK_FRAMER.parse() < 0) {
+    PRINTF("tsch: failed to parse %u\n", packetbuf_datalen());
+    return;
+  }
+
+  if(packetbuf_datalen() < 1) {
+    PRINTF("tsch: too short packet\n");
+    return;
+  }
+  type = *(uint8_t *)packetbuf_dataptr();
+
+  if(type == TYPE_EB) {
+    eb_input();
+  } else if(type == TYPE_DATA) {
+    packetbuf_hdrreduce(1);
+    data_input();
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_packet(mac_callback_t sent, void *ptr)
+{
+  struct tsch_neighbor *n;
+  struct tsch_packet *p;
+  int is_broadcast;
+
+  if(!associated) {
+    mac_call_sent_callback(sent, ptr, MAC_TX_ERR, 0);
+    return;
+  }
+
+  if(!packetbuf_hdralloc(1)) {
+    mac_call_sent_callback(sent, ptr, MAC_TX_ERR_FATAL, 0);
+    return;
+  }
+  *(uint8_t *)packetbuf_hdrptr() = TYPE_DATA;
+  packetbuf_compact();
+
+  is_broadcast = rimeaddr_cmp(packetbuf_addr(PACKETBUF_ADDR_RECEIVER),
+                              &rimeaddr_null);
+  packetbuf_set_addr(PACKETBUF_ADDR_SENDER, &rimeaddr_node_addr);
+  packetbuf_set_attr(PACKETBUF_ATTR_MAC_ACK, !is_broadcast);
+
+  if(NETSTACK_FRAMER.create() < 0) {
+    PRINTF("tsch: send failed, too large header\n");
+    mac_call_sent_callback(sent, ptr, MAC_TX_ERR_FATAL, 0);
+    return;
+  }
+
+  n = get_neighbor(packetbuf_addr(PACKETBUF_ADDR_RECEIVER));
+  if(n == NULL || (uint8_t)(n->put - n->done) >= QUEUE_SIZE) {
+    PRINTF("tsch: queue full\n");
+    mac_call_sent_callback(sent, ptr, MAC_TX_ERR, 0);
+    return;
+  }
+
+  p = &n->packets[n->put % QUEUE_SIZE];
+  p->qb = queuebuf_new_from_packetbuf();
+  if(p->qb == NULL) {
+    PRINTF("tsch: could not allocate queuebuf\n");
+    mac_call_sent_callback(sent, ptr, MAC_TX_ERR, 0);
+    return;
+  }
+  p->sent = sent;
+  p->ptr = ptr;
+  p->transmissions = 0;
+  p->max_transmissions = is_broadcast ? 1 :
+    packetbuf_attr(PACKETBUF_ATTR_MAX_MAC_TRANSMISSIONS);
+  if(p->max_transmissions == 0) {
+    p->max_transmissions = MAX_TRANSMISSIONS;
+  }
+  p->ret = MAC_TX_DEFERRED;
+
+  /* The packet is visible to the slot operation from now on. */
+  n->put++;
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_list(mac_callback_t sent, void *ptr, struct rdc_buf_list *buf_list)
+{
+  /* The next packets of the list are sent by the MAC layer when this
+     one is done. */
+  if(buf_list != NULL) {
+    queuebuf_to_packetbuf(buf_list->buf);
+    send_packet(sent, ptr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(tsch_process, ev, data)
+{
+  struct tsch_neighbor *n;
+  struct tsch_packet *p;
+  mac_callback_t sent;
+  void *ptr;
+  int ret;
+  int transmissions;
+
+  PROCESS_BEGIN();
+
+  while(1) {
+    PROCESS_YIELD_UNTIL(ev == PROCESS_EVENT_POLL);
+
+    /* Call the sent callbacks of the packets the slot operation is
+       done with. */
+    for(n = &neighbors[0]; n <= &neighbors[MAX_NEIGHBOR_QUEUES]; n++) {
+      while(n->done != n->tx) {
+        p = &n->packets[n->done % QUEUE_SIZE];
+        queuebuf_to_packetbuf(p->qb);
+        queuebuf_free(p->qb);
+        sent = p->sent;
+        ptr = p->ptr;
+        ret = p->ret;
+        transmissions = p->transmissions;
+        n->done++;
+        mac_call_sent_callback(sent, ptr, ret, transmissions);
+      }
+    }
+
+#if !RDC_CONF_HARDWARE_SEND_ACK
+    /* Pass up the frame that the slot operation has received. */
+    if(rx_len > 0) {
+      packetbuf_clear();
+      memcpy(packetbuf_dataptr(), rx_buf, rx_len);
+      packetbuf_set_datalen(rx_len);
+      rx_len = 0;
+      input_packet();
+    }
+#endif /* !RDC_CONF_HARDWARE_SEND_ACK */
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_set_coordinator(int enable)
+{
+  if(is_coordinator == (enable != 0)) {
+    return;
+  }
+  is_coordinator = enable != 0;
+  leave_network();
+  if(is_coordinator && tsch_is_on) {
+    start_network();
+  }
+}
+/*---------------------------------------------------------------------------*/
+int
+tsch_is_associated(void)
+{
+  return associated;
+}
+/*---------------------------------------------------------------------------*/
+static int
+on(void)
+{
+  if(!tsch_is_on) {
+    tsch_is_on = 1;
+    tsch_keep_radio_on = 0;
+    if(is_coordinator) {
+      start_network();
+    } else {
+      /* Scan for EBs until we join a network. */
+      NETSTACK_RADIO.on();
+    }
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+off(int keep_radio_on)
+{
+  tsch_is_on = 0;
+  tsch_keep_radio_on = keep_radio_on;
+  leave_network();
+  if(keep_radio_on) {
+    NETSTACK_RADIO.on();
+  } else {
+    NETSTACK_RADIO.off();
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned short
+channel_check_interval(void)
+{
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+init(void)
+{
+  memset(neighbors, 0, sizeof(neighbors));
+  process_start(&tsch_process, NULL);
+
+  tsch_is_on = 1;
+  scan_channel = 0;
+  SET_CHANNEL(hopping_sequence[scan_channel]);
+  NETSTACK_RADIO.on();
+
+  ctimer_set(&housekeeping_timer, SCAN_CHANNEL_TIME, housekeeping, NULL);
+  ctimer_set(&eb_timer, random_rand() % EB_PERIOD, send_eb, NULL);
+}
+/*---------------------------------------------------------------------------*/
+const struct rdc_driver tsch_driver = {
+  "TSCH",
+  init,
+  send_packet,
+  send_list,
+  input_packet,
+  on,
+  off,
+  channel_check_interval,
+};
+/*---------------------------------------------------------------------------*/
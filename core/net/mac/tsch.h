@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2013, the Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         A time-slotted channel hopping radio duty cycling protocol,
+ *         in the spirit of the TSCH mode of IEEE 802.15.4e
+ *
+ *         TSCH does its own queueing and retransmissions, so it is
+ *         meant to be used with nullmac_driver as the MAC layer. The
+ *         coordinator of the network must be set with
+ *         tsch_set_coordinator(); all other nodes join the network
+ *         when they hear one of its enhanced beacons.
+ */
+
+#ifndef TSCH_H_
+#define TSCH_H_
+
+#include "net/mac/rdc.h"
+#include "dev/radio.h"
+
+extern const struct rdc_driver tsch_driver;
+
+/**
+ * \brief      Make this node the coordinator of the network, or stop
+ *             being it
+ * \param enable Non-zero to start a network, zero to join one
+ *
+ *             The coordinator starts the slot counter of the network
+ *             and is the root of the time synchronization.
+ */
+void tsch_set_coordinator(int enable);
+
+/**
+ * \brief      Check whether the node is synchronized with a network
+ * \return     Non-zero if the node follows the schedule of a network
+ */
+int tsch_is_associated(void);
+
+#endif /* TSCH_H_ */
@@ -62,6 +62,21 @@ static unsigned num_tables;
 MEMB(neighbor_addr_mem, nbr_table_key_t, NBR_TABLE_MAX_NEIGHBORS);
 LIST(nbr_table_keys);
 
+#if NBR_TABLE_HASH_LOOKUP
+/* Open-addressing hash table over the link-layer addresses in
+ * nbr_table_keys, with linear probing. Each slot holds a neighbor
+ * index plus one, zero marks an empty slot. */
+#if NBR_TABLE_MAX_NEIGHBORS < 255
+typedef uint8_t nbr_hash_slot_t;
+#else
+typedef uint16_t nbr_hash_slot_t;
+#endif
+#if NBR_TABLE_HASH_SIZE <= NBR_TABLE_MAX_NEIGHBORS
+#error NBR_TABLE_HASH_SIZE must be larger than NBR_TABLE_MAX_NEIGHBORS
+#endif
+static nbr_hash_slot_t nbr_hash[NBR_TABLE_HASH_SIZE];
+#endif /* NBR_TABLE_HASH_LOOKUP */
+
 /*---------------------------------------------------------------------------*/
 /* Get a key from a neighbor index */
 static nbr_table_key_t *
@@ -104,17 +119,96 @@ key_from_item(nbr_table_t *table, const nbr_table_item_t *item)
 {
   return key_from_index(index_from_item(table, item));
 }
+#if NBR_TABLE_HASH_LOOKUP
+/*---------------------------------------------------------------------------*/
+/* Get the home slot of a link-layer address in the hash table */
+static int
+hash_slot(const rimeaddr_t *lladdr)
+{
+  uint16_t h = 0;
+  int i;
+  for(i = 0; i < RIMEADDR_SIZE; i++) {
+    h = h * 31 + lladdr->u8[i];
+  }
+  return h % NBR_TABLE_HASH_SIZE;
+}
+/*---------------------------------------------------------------------------*/
+/* Get the slot in the hash table that refers to a neighbor index */
+static int
+hash_find(int index)
+{
+  int slot = hash_slot(&key_from_index(index)->lladdr);
+  while(nbr_hash[slot] != index + 1) {
+    slot = (slot + 1) % NBR_TABLE_HASH_SIZE;
+  }
+  return slot;
+}
+/*---------------------------------------------------------------------------*/
+/* Add a key to the hash table */
+static void
+hash_add(nbr_table_key_t *key)
+{
+  int slot = hash_slot(&key->lladdr);
+  while(nbr_hash[slot] != 0) {
+    slot = (slot + 1) % NBR_TABLE_HASH_SIZE;
+  }
+  nbr_hash[slot] = index_from_key(key) + 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Remove a key from the hash table. The following entries of the probe
+ * sequence are shifted back so that lookups never stop at the hole */
+static void
+hash_remove(nbr_table_key_t *key)
+{
+  int hole = hash_find(index_from_key(key));
+  int slot = hole;
+  int home;
+
+  while(1) {
+    slot = (slot + 1) % NBR_TABLE_HASH_SIZE;
+    if(nbr_hash[slot] == 0) {
+      break;
+    }
+    home = hash_slot(&key_from_index(nbr_hash[slot] - 1)->lladdr);
+    /* Move the entry into the hole unless its home slot lies
+     * cyclically in (hole, slot] */
+    if((hole < slot && (home <= hole || home > slot)) ||
+       (hole > slot && (home <= hole && home > slot))) {
+      nbr_hash[hole] = nbr_hash[slot];
+      hole = slot;
+    }
+  }
+  nbr_hash[hole] = 0;
+}
+#endif /* NBR_TABLE_HASH_LOOKUP */
 /*---------------------------------------------------------------------------*/
 /* Get the index of a neighbor from its link-layer address */
 static int
 index_from_lladdr(const rimeaddr_t *lladdr)
 {
   nbr_table_key_t *key;
+#if NBR_TABLE_HASH_LOOKUP
+  int slot;
+  int probes;
+#endif /* NBR_TABLE_HASH_LOOKUP */
   /* Allow lladdr-free insertion, useful e.g. for IPv6 ND.
    * Only one such entry is possible at a time, indexed by rimeaddr_null. */
   if(lladdr == NULL) {
     lladdr = &rimeaddr_null;
   }
+#if NBR_TABLE_HASH_LOOKUP
+  slot = hash_slot(lladdr);
+  /* The table always has an empty slot, but never probe more than
+   * one full round */
+  for(probes = 0; probes < NBR_TABLE_HASH_SIZE && nbr_hash[slot] != 0;
+      probes++) {
+    key = key_from_index(nbr_hash[slot] - 1);
+    if(rimeaddr_cmp(lladdr, &key->lladdr)) {
+      return nbr_hash[slot] - 1;
+    }
+    slot = (slot + 1) % NBR_TABLE_HASH_SIZE;
+  }
+#else /* NBR_TABLE_HASH_LOOKUP */
   key = list_head(nbr_table_keys);
   while(key != NULL) {
     if(lladdr && rimeaddr_cmp(lladdr, &key->lladdr)) {
@@ -122,6 +216,7 @@ index_from_lladdr(const rimeaddr_t *lladdr)
     }
     key = list_item_next(key);
   }
+#endif /* NBR_TABLE_HASH_LOOKUP */
   return -1;
 }
 /*---------------------------------------------------------------------------*/
@@ -157,14 +252,14 @@ nbr_set_bit(uint8_t *bitmap, nbr_table_t *table, nbr_table_item_t *item, int val
 }
 /*---------------------------------------------------------------------------*/
 static nbr_table_key_t *
-nbr_table_allocate(void)
+nbr_table_allocate(int replace)
 {
   nbr_table_key_t *key;
   int least_used_count = 0;
   nbr_table_key_t *least_used_key = NULL;
 
   key = memb_alloc(&neighbor_addr_mem);
-  if(key != NULL) {
+  if(key != NULL || !replace) {
     return key;
   } else { /* No more space, try to free a neighbor.
             * The replacement policy is the following: remove neighbor that is:
@@ -218,6 +313,9 @@ nbr_table_allocate(void)
       used_map[index_from_key(least_used_key)] = 0;
       /* Remove neighbor from list */
       list_remove(nbr_table_keys, least_used_key);
+#if NBR_TABLE_HASH_LOOKUP
+      hash_remove(least_used_key);
+#endif /* NBR_TABLE_HASH_LOOKUP */
       /* Return associated key */
       return least_used_key;
     }
@@ -267,9 +365,8 @@ nbr_table_next(nbr_table_t *table, nbr_table_item_t *item)
   return item;
 }
 /*---------------------------------------------------------------------------*/
-/* Add a neighbor indexed with its link-layer address */
-nbr_table_item_t *
-nbr_table_add_lladdr(nbr_table_t *table, const rimeaddr_t *lladdr)
+static nbr_table_item_t *
+add_lladdr(nbr_table_t *table, const rimeaddr_t *lladdr, int replace)
 {
   int index;
   nbr_table_item_t *item;
@@ -283,7 +380,7 @@ nbr_table_add_lladdr(nbr_table_t *table, const rimeaddr_t *lladdr)
 
   if((index = index_from_lladdr(lladdr)) == -1) {
      /* Neighbor not yet in table, let's try to allocate one */
-    key = nbr_table_allocate();
+    key = nbr_table_allocate(replace);
 
     /* No space available for new entry */
     if(key == NULL) {
@@ -298,6 +395,9 @@ nbr_table_add_lladdr(nbr_table_t *table, const rimeaddr_t *lladdr)
 
     /* Set link-layer address */
     rimeaddr_copy(&key->lladdr, lladdr);
+#if NBR_TABLE_HASH_LOOKUP
+    hash_add(key);
+#endif /* NBR_TABLE_HASH_LOOKUP */
   }
 
   /* Get item in the current table */
@@ -310,6 +410,20 @@ nbr_table_add_lladdr(nbr_table_t *table, const rimeaddr_t *lladdr)
   return item;
 }
 /*---------------------------------------------------------------------------*/
+/* Add a neighbor indexed with its link-layer address */
+nbr_table_item_t *
+nbr_table_add_lladdr(nbr_table_t *table, const rimeaddr_t *lladdr)
+{
+  return add_lladdr(table, lladdr, 1);
+}
+/*---------------------------------------------------------------------------*/
+/* Add a neighbor only if that does not replace another neighbor */
+nbr_table_item_t *
+nbr_table_try_add_lladdr(nbr_table_t *table, const rimeaddr_t *lladdr)
+{
+  return add_lladdr(table, lladdr, 0);
+}
+/*---------------------------------------------------------------------------*/
 /* Get an item from its link-layer address */
 void *
 nbr_table_get_from_lladdr(nbr_table_t *table, const rimeaddr_t *lladdr)
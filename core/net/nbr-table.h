@@ -46,6 +46,23 @@
 #define NBR_TABLE_MAX_NEIGHBORS 8
 #endif /* NBR_TABLE_CONF_MAX_NEIGHBORS */
 
+/* Index neighbors by link-layer address in a hash table, for constant
+ * time lookups in tables with many neighbors. Costs
+ * NBR_TABLE_HASH_SIZE bytes of RAM (two per entry above 255 neighbors) */
+#ifdef NBR_TABLE_CONF_HASH_LOOKUP
+#define NBR_TABLE_HASH_LOOKUP NBR_TABLE_CONF_HASH_LOOKUP
+#else /* NBR_TABLE_CONF_HASH_LOOKUP */
+#define NBR_TABLE_HASH_LOOKUP 0
+#endif /* NBR_TABLE_CONF_HASH_LOOKUP */
+
+/* Number of slots in the hash table, must be larger than
+ * NBR_TABLE_MAX_NEIGHBORS */
+#ifdef NBR_TABLE_CONF_HASH_SIZE
+#define NBR_TABLE_HASH_SIZE NBR_TABLE_CONF_HASH_SIZE
+#else /* NBR_TABLE_CONF_HASH_SIZE */
+#define NBR_TABLE_HASH_SIZE (2 * NBR_TABLE_MAX_NEIGHBORS)
+#endif /* NBR_TABLE_CONF_HASH_SIZE */
+
 /* An item in a neighbor table */
 typedef void nbr_table_item_t;
 
@@ -85,6 +102,7 @@ nbr_table_item_t *nbr_table_next(nbr_table_t *table, nbr_table_item_t *item);
 /** \name Neighbor tables: add and get data */
 /** @{ */
 nbr_table_item_t *nbr_table_add_lladdr(nbr_table_t *table, const rimeaddr_t *lladdr);
+nbr_table_item_t *nbr_table_try_add_lladdr(nbr_table_t *table, const rimeaddr_t *lladdr);
 nbr_table_item_t *nbr_table_get_from_lladdr(nbr_table_t *table, const rimeaddr_t *lladdr);
 /** @} */
 
@@ -331,6 +331,7 @@ struct packetbuf_addr {
 #define PACKETBUF_ATTR_PACKET_TYPE_STREAM    2
 #define PACKETBUF_ATTR_PACKET_TYPE_STREAM_END 3
 #define PACKETBUF_ATTR_PACKET_TYPE_TIMESTAMP 4
+#define PACKETBUF_ATTR_PACKET_TYPE_CONTROL   5
 
 enum {
   PACKETBUF_ATTR_NONE,
@@ -121,6 +121,13 @@ static int next_swap_id = 0;
 static struct qbuf_file qbuf_files[NQBUF_FILES];
 /* The timer used to renew files during inactivity periods */
 static struct ctimer renew_timer;
+#if CFS_SUBMIT
+/* The write of tmpdata to the swap, which is done in the background
+   when the file system supports it. tmpdata is not modified until the
+   write is done. */
+static struct cfs_request swap_request;
+static uint8_t swap_pending;
+#endif /* CFS_SUBMIT */
 
 #endif
 
@@ -149,11 +156,34 @@ uint8_t queuebuf_len, queuebuf_ref_len, queuebuf_max_len;
 
 #if WITH_SWAP
 /*---------------------------------------------------------------------------*/
+#if CFS_SUBMIT
+static void
+swap_written(struct cfs_request *req)
+{
+  swap_pending = 0;
+  if(req->result != sizeof(struct queuebuf_data)) {
+    PRINTF("swap_written: cfs write error\n");
+  }
+}
+#endif /* CFS_SUBMIT */
+/*---------------------------------------------------------------------------*/
+/* Wait until tmpdata has been written to the swap */
+static void
+swap_wait(void)
+{
+#if CFS_SUBMIT
+  if(swap_pending) {
+    cfs_wait(&swap_request);
+  }
+#endif /* CFS_SUBMIT */
+}
+/*---------------------------------------------------------------------------*/
 static void
 qbuf_renew_file(int file)
 {
   int ret;
   char name[2];
+  swap_wait();
   name[0] = 'a' + file;
   name[1] = '\0';
   if(qbuf_files[file].renewable == 1) {
@@ -237,6 +267,21 @@ queuebuf_flush_tmpdata(void)
     fileid = tmpdata_qbuf->swap_id / NQBUF_PER_FILE;
     offset = (tmpdata_qbuf->swap_id % NQBUF_PER_FILE) * sizeof(struct queuebuf_data);
     fd = qbuf_files[fileid].fd;
+#if CFS_SUBMIT
+    swap_request.fd = fd;
+    swap_request.offset = offset;
+    swap_request.buf = &tmpdata;
+    swap_request.len = sizeof(struct queuebuf_data);
+    swap_request.write = 1;
+    swap_request.callback = swap_written;
+    swap_pending = 1;
+    ret = cfs_submit(&swap_request);
+    if(ret == -1) {
+      swap_pending = 0;
+      PRINTF("queuebuf_flush_tmpdata: cfs submit error\n");
+      return -1;
+    }
+#else /* CFS_SUBMIT */
     ret = cfs_seek(fd, offset, CFS_SEEK_SET);
     if(ret == -1) {
       PRINTF("queuebuf_flush_tmpdata: cfs seek error\n");
@@ -247,6 +292,7 @@ queuebuf_flush_tmpdata(void)
       PRINTF("queuebuf_flush_tmpdata: cfs write error\n");
       return -1;
     }
+#endif /* CFS_SUBMIT */
   }
   return 0;
 }
@@ -263,6 +309,7 @@ queuebuf_load_to_ram(struct queuebuf *b)
     if(tmpdata_qbuf && tmpdata_qbuf->swap_id == b->swap_id) { /* the qbuf is already in tmpdata */
       return &tmpdata;
     } else { /* the qbuf needs to be loaded from CFS */
+      swap_wait();
       tmpdata_qbuf = b;
       /* read the qbuf from CFS */
       fileid = b->swap_id / NQBUF_PER_FILE;
@@ -350,6 +397,7 @@ queuebuf_new_from_packetbuf(void)
       } else {
         buf->location = IN_CFS;
         buf->swap_id = -1;
+        swap_wait();
         tmpdata_qbuf = buf;
         buframptr = &tmpdata;
       }
@@ -396,6 +444,11 @@ void
 queuebuf_update_attr_from_packetbuf(struct queuebuf *buf)
 {
   struct queuebuf_data *buframptr = queuebuf_load_to_ram(buf);
+#if WITH_SWAP
+  if(buf->location == IN_CFS) {
+    swap_wait();
+  }
+#endif
   packetbuf_attr_copyto(buframptr->attrs, buframptr->addrs);
 #if WITH_SWAP
   if(buf->location == IN_CFS) {
@@ -87,6 +87,71 @@
 #define RPL_LEAF_ONLY 0
 #endif
 
+/*
+ * Set to 1 to support DAGs in non-storing mode (RFC 6550, Section
+ * 9.7). Nodes send their DAOs to the DAG root, which keeps the DAG
+ * parent of every node and source routes downward traffic with RFC
+ * 6554 routing headers. Routers keep no downward routes. The mode of
+ * operation of a DAG is chosen by its root, see RPL_CONF_MOP.
+ */
+#ifdef RPL_CONF_WITH_NON_STORING
+#define RPL_WITH_NON_STORING RPL_CONF_WITH_NON_STORING
+#else
+#define RPL_WITH_NON_STORING 0
+#endif
+
+/*
+ * Number of nodes the root of a non-storing DAG can keep track of.
+ */
+#ifdef RPL_NS_CONF_LINK_NUM
+#define RPL_NS_LINK_NUM RPL_NS_CONF_LINK_NUM
+#else
+#define RPL_NS_LINK_NUM 32
+#endif
+
+/*
+ * Set to 1 to aggregate DAOs in storing mode. Instead of forwarding
+ * every DAO it receives right away, a router collects the targets for
+ * RPL_DAO_AGGREGATION_WINDOW and sends them to its preferred parent
+ * in a single DAO with several target options. A target that is
+ * advertised again before the DAO is sent only takes one slot.
+ */
+#ifdef RPL_CONF_WITH_DAO_AGGREGATION
+#define RPL_WITH_DAO_AGGREGATION RPL_CONF_WITH_DAO_AGGREGATION
+#else
+#define RPL_WITH_DAO_AGGREGATION 0
+#endif
+
+/*
+ * Maximum number of targets in an aggregated DAO. The default keeps
+ * the DAO within a single 802.15.4 frame.
+ */
+#ifdef RPL_CONF_DAO_AGGREGATION_TARGETS
+#define RPL_DAO_AGGREGATION_TARGETS RPL_CONF_DAO_AGGREGATION_TARGETS
+#else
+#define RPL_DAO_AGGREGATION_TARGETS 3
+#endif
+
+/*
+ * Time during which a router collects targets before sending an
+ * aggregated DAO.
+ */
+#ifdef RPL_CONF_DAO_AGGREGATION_WINDOW
+#define RPL_DAO_AGGREGATION_WINDOW RPL_CONF_DAO_AGGREGATION_WINDOW
+#else
+#define RPL_DAO_AGGREGATION_WINDOW (CLOCK_SECOND / 2)
+#endif
+
+/*
+ * Minimum time between two aggregated DAOs from the same router. A
+ * full aggregation queue is sent regardless.
+ */
+#ifdef RPL_CONF_DAO_AGGREGATION_INTERVAL
+#define RPL_DAO_AGGREGATION_INTERVAL RPL_CONF_DAO_AGGREGATION_INTERVAL
+#else
+#define RPL_DAO_AGGREGATION_INTERVAL (CLOCK_SECOND * 2)
+#endif
+
 /*
  * Maximum of concurent RPL instances.
  */
@@ -88,6 +88,9 @@ void
 rpl_dag_init(void)
 {
   nbr_table_register(rpl_parents, (nbr_table_callback *)nbr_callback);
+#if RPL_WITH_NON_STORING
+  rpl_ns_init();
+#endif /* RPL_WITH_NON_STORING */
 }
 /*---------------------------------------------------------------------------*/
 rpl_rank_t
@@ -528,6 +531,9 @@ rpl_free_dag(rpl_dag_t *dag)
 
     /* Remove routes installed by DAOs. */
     rpl_remove_routes(dag);
+#if RPL_WITH_NON_STORING
+    rpl_ns_remove_nodes(dag);
+#endif /* RPL_WITH_NON_STORING */
 
    /* Remove autoconfigured address */
     if((dag->prefix_info.flags & UIP_ND6_RA_FLAG_AUTONOMOUS)) {
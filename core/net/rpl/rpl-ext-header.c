@@ -61,6 +61,12 @@
 #define UIP_EXT_HDR_OPT_BUF       ((struct uip_ext_hdr_opt *)&uip_buf[uip_l2_l3_hdr_len + uip_ext_opt_offset])
 #define UIP_EXT_HDR_OPT_PADN_BUF  ((struct uip_ext_hdr_opt_padn *)&uip_buf[uip_l2_l3_hdr_len + uip_ext_opt_offset])
 #define UIP_EXT_HDR_OPT_RPL_BUF   ((struct uip_ext_hdr_opt_rpl *)&uip_buf[uip_l2_l3_hdr_len + uip_ext_opt_offset])
+#define UIP_RH_BUF                ((struct uip_routing_hdr *)&uip_buf[uip_l2_l3_hdr_len])
+#define UIP_IP_PAYLOAD_BUF        ((uint8_t *)&uip_buf[UIP_LLH_LEN + UIP_IPH_LEN])
+
+/* RFC 6554 source routing header. */
+#define RPL_RH_TYPE_SRH           3
+#define RPL_SRH_LEN               8
 /*---------------------------------------------------------------------------*/
 #if UIP_CONF_IPV6
 int
@@ -356,4 +362,207 @@ rpl_insert_header(void)
   }
 }
 /*---------------------------------------------------------------------------*/
+#if RPL_WITH_NON_STORING
+static uip_ipaddr_t srh_nexthop;
+
+/* The destination that rpl_process_srh_header() last took from a
+   source routing header, which is one of our neighbors. */
+static uip_ipaddr_t srh_forward_addr;
+static uint8_t srh_forwarding;
+
+static uip_ipaddr_t *
+link_local_nexthop(const uip_ipaddr_t *addr)
+{
+  uip_ip6addr(&srh_nexthop, 0xfe80, 0, 0, 0, 0, 0, 0, 0);
+  memcpy(((uint8_t *)&srh_nexthop) + 8, ((const uint8_t *)addr) + 8, 8);
+  return &srh_nexthop;
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t
+common_prefix_len(const uip_ipaddr_t *a, const uip_ipaddr_t *b)
+{
+  uint8_t i;
+
+  /* The compression fields of the header can elide at most 15 bytes. */
+  for(i = 0; i < 15 && a->u8[i] == b->u8[i]; i++);
+  return i;
+}
+/*---------------------------------------------------------------------------*/
+uip_ipaddr_t *
+rpl_update_header_srh(void)
+{
+  rpl_dag_t *dag;
+  rpl_ns_node_t *node;
+  uip_ipaddr_t addr;
+  uint8_t *srh;
+  uint8_t cmpr;
+  uint8_t addr_len;
+  uint8_t pad;
+  uint8_t n;
+  uint8_t i;
+  int srh_len;
+
+  /* A packet that already has a source routing header is only sent to
+     its destination directly if we are forwarding it along the route,
+     in which case rpl_process_srh_header() has set a neighbor as the
+     destination. */
+  if(UIP_IP_BUF->proto == UIP_PROTO_ROUTING) {
+    if(srh_forwarding &&
+       ((struct uip_routing_hdr *)UIP_IP_PAYLOAD_BUF)->routing_type ==
+       RPL_RH_TYPE_SRH &&
+       uip_ipaddr_cmp(&UIP_IP_BUF->destipaddr, &srh_forward_addr)) {
+      srh_forwarding = 0;
+      return link_local_nexthop(&UIP_IP_BUF->destipaddr);
+    }
+    return NULL;
+  }
+
+  /* Otherwise, only the root of a non-storing DAG adds one. */
+  if(default_instance == NULL || !RPL_IS_NON_STORING(default_instance)) {
+    return NULL;
+  }
+  dag = default_instance->current_dag;
+  if(dag == NULL || !dag->joined ||
+     dag->rank != ROOT_RANK(default_instance) ||
+     !rpl_ns_is_node_reachable(dag, &UIP_IP_BUF->destipaddr)) {
+    return NULL;
+  }
+
+  /* Count the hops to the destination and find out how many leading
+     bytes all addresses on the path share with the destination. */
+  n = 0;
+  cmpr = 15;
+  for(node = rpl_ns_get_node(dag, &UIP_IP_BUF->destipaddr);
+      node != NULL; node = node->parent) {
+    rpl_ns_get_node_global_addr(&addr, node);
+    i = common_prefix_len(&addr, &UIP_IP_BUF->destipaddr);
+    if(i < cmpr) {
+      cmpr = i;
+    }
+    n++;
+  }
+
+  if(n == 1) {
+    /* The destination is one of our children. */
+    return link_local_nexthop(&UIP_IP_BUF->destipaddr);
+  }
+
+  /* The first hop goes in the IPv6 destination field, the n - 1 other
+     addresses in the routing header. */
+  n--;
+  addr_len = 16 - cmpr;
+  pad = (8 - (n * addr_len) % 8) % 8;
+  srh_len = RPL_SRH_LEN + n * addr_len + pad;
+
+  if(uip_len + srh_len > UIP_BUFSIZE) {
+    PRINTF("RPL: Packet too long: impossible to add a source routing header\n");
+    return NULL;
+  }
+
+  /* The hop-by-hop option is not used on source routed packets. */
+  if(UIP_IP_BUF->proto == UIP_PROTO_HBHO) {
+    rpl_remove_header();
+  }
+
+  srh = UIP_IP_PAYLOAD_BUF;
+  memmove(srh + srh_len, srh, uip_len - UIP_IPH_LEN);
+  srh[0] = UIP_IP_BUF->proto;
+  srh[1] = (srh_len >> 3) - 1;
+  srh[2] = RPL_RH_TYPE_SRH;
+  srh[3] = n;
+  srh[4] = (cmpr << 4) | cmpr;
+  srh[5] = pad << 4;
+  srh[6] = 0;
+  srh[7] = 0;
+  memset(srh + srh_len - pad, 0, pad);
+
+  /* The path is walked from the destination up, so the addresses are
+     filled in from the end of the header. */
+  i = n;
+  for(node = rpl_ns_get_node(dag, &UIP_IP_BUF->destipaddr);
+      node != NULL; node = node->parent) {
+    rpl_ns_get_node_global_addr(&addr, node);
+    if(i > 0) {
+      i--;
+      memcpy(srh + RPL_SRH_LEN + i * addr_len, &addr.u8[cmpr], addr_len);
+    } else {
+      uip_ipaddr_copy(&UIP_IP_BUF->destipaddr, &addr);
+    }
+  }
+
+  UIP_IP_BUF->proto = UIP_PROTO_ROUTING;
+  uip_len += srh_len;
+  UIP_IP_BUF->len[0] = (uip_len - UIP_IPH_LEN) >> 8;
+  UIP_IP_BUF->len[1] = (uip_len - UIP_IPH_LEN) & 0xff;
+
+  PRINTF("RPL: Added a source routing header with %u addresses, first hop ",
+         n);
+  PRINT6ADDR(&UIP_IP_BUF->destipaddr);
+  PRINTF("\n");
+
+  return link_local_nexthop(&UIP_IP_BUF->destipaddr);
+}
+/*---------------------------------------------------------------------------*/
+int
+rpl_process_srh_header(void)
+{
+  uint8_t *srh;
+  uint8_t cmpri, cmpre, cmpr;
+  uint8_t segments_left;
+  uint8_t addr_len;
+  uint8_t *slot;
+  int path_len;
+  int n;
+  uip_ipaddr_t next;
+
+  srh_forwarding = 0;
+
+  srh = (uint8_t *)UIP_RH_BUF;
+  if(UIP_RH_BUF->routing_type != RPL_RH_TYPE_SRH ||
+     UIP_IPH_LEN + uip_ext_len + ((srh[1] + 1) << 3) > uip_len) {
+    return 0;
+  }
+
+  segments_left = srh[3];
+  cmpri = srh[4] >> 4;
+  cmpre = srh[4] & 0x0f;
+
+  /* Number of addresses, from the length of the header */
+  path_len = ((srh[1] + 1) << 3) - RPL_SRH_LEN - (srh[5] >> 4) - (16 - cmpre);
+  if(path_len < 0 || path_len % (16 - cmpri) != 0) {
+    PRINTF("RPL: Malformed source routing header\n");
+    return 0;
+  }
+  n = path_len / (16 - cmpri) + 1;
+  if(segments_left > n) {
+    PRINTF("RPL: Bad segments left in source routing header\n");
+    return 0;
+  }
+
+  /* Swap the next address with the destination, which is us. */
+  cmpr = segments_left == 1 ? cmpre : cmpri;
+  addr_len = 16 - cmpr;
+  slot = srh + RPL_SRH_LEN + (n - segments_left) * (16 - cmpri);
+
+  memcpy(&next, &UIP_IP_BUF->destipaddr, cmpr);
+  memcpy(&next.u8[cmpr], slot, addr_len);
+  if(uip_is_addr_mcast(&next) || uip_ds6_is_my_addr(&next)) {
+    PRINTF("RPL: Bad address in source routing header\n");
+    return 0;
+  }
+  memcpy(slot, &UIP_IP_BUF->destipaddr.u8[cmpr], addr_len);
+  uip_ipaddr_copy(&UIP_IP_BUF->destipaddr, &next);
+  srh[3] = segments_left - 1;
+
+  uip_ipaddr_copy(&srh_forward_addr, &next);
+  srh_forwarding = 1;
+
+  PRINTF("RPL: Source routing to ");
+  PRINT6ADDR(&UIP_IP_BUF->destipaddr);
+  PRINTF(", %u segments left\n", srh[3]);
+
+  return 1;
+}
+#endif /* RPL_WITH_NON_STORING */
+/*---------------------------------------------------------------------------*/
 #endif /* UIP_CONF_IPV6 */
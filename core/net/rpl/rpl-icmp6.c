@@ -554,36 +554,135 @@ dio_output(rpl_instance_t *instance, uip_ipaddr_t *uc_addr)
 #endif /* RPL_LEAF_ONLY */
 }
 /*---------------------------------------------------------------------------*/
+#if RPL_WITH_DAO_AGGREGATION
+#define DAO_MAX_TARGETS RPL_DAO_AGGREGATION_TARGETS
+#else
+#define DAO_MAX_TARGETS 1
+#endif /* RPL_WITH_DAO_AGGREGATION */
+
+struct dao_target {
+  uip_ipaddr_t prefix;
+  uint8_t prefixlen;
+  uint8_t lifetime;
+};
+
+#if RPL_WITH_DAO_AGGREGATION
+/* Targets waiting to be sent in the next aggregated DAO. */
+static struct {
+  rpl_dag_t *dag;
+  struct dao_target target;
+} aggregated[DAO_MAX_TARGETS];
+static uint8_t num_aggregated;
+
+static void dao_aggregate(rpl_dag_t *dag, struct dao_target *target);
+#endif /* RPL_WITH_DAO_AGGREGATION */
+/*---------------------------------------------------------------------------*/
+static int
+dao_register_sender(rpl_dag_t *dag, uip_ipaddr_t *addr,
+                    uip_lladdr_t *lladdr, int learned_from)
+{
+  rpl_instance_t *instance;
+  rpl_parent_t *p;
+  uip_ds6_nbr_t *nbr;
+
+  instance = dag->instance;
+  p = NULL;
+
+  if(learned_from == RPL_ROUTE_FROM_UNICAST_DAO) {
+    /* Check whether this is a DAO forwarding loop. */
+    p = rpl_find_parent(dag, addr);
+    /* check if this is a new DAO registration with an "illegal" rank */
+    /* if we already route to this node it is likely */
+    if(p != NULL &&
+       DAG_RANK(p->rank, instance) < DAG_RANK(dag->rank, instance)) {
+      PRINTF("RPL: Loop detected when receiving a unicast DAO from a node with a lower rank! (%u < %u)\n",
+          DAG_RANK(p->rank, instance), DAG_RANK(dag->rank, instance));
+      p->rank = INFINITE_RANK;
+      p->updated = 1;
+      return 0;
+    }
+
+    /* If we get the DAO from our parent, we also have a loop. */
+    if(p != NULL && p == dag->preferred_parent) {
+      PRINTF("RPL: Loop detected when receiving a unicast DAO from our parent\n");
+      p->rank = INFINITE_RANK;
+      p->updated = 1;
+      return 0;
+    }
+  }
+
+  PRINTF("RPL: adding DAO route\n");
+
+  if((nbr = uip_ds6_nbr_lookup(addr)) == NULL) {
+    if((nbr = uip_ds6_nbr_add(addr, lladdr, 0, NBR_REACHABLE)) != NULL) {
+      /* set reachable timer */
+      stimer_set(&nbr->reachable, UIP_ND6_REACHABLE_TIME / 1000);
+      PRINTF("RPL: Neighbor added to neighbor cache ");
+      PRINT6ADDR(addr);
+      PRINTF(", ");
+      PRINTLLADDR(lladdr);
+      PRINTF("\n");
+    } else {
+      PRINTF("RPL: Out of Memory, dropping DAO from ");
+      PRINT6ADDR(addr);
+      PRINTF(", ");
+      PRINTLLADDR(lladdr);
+      PRINTF("\n");
+      return 0;
+    }
+  } else {
+    PRINTF("RPL: Neighbor already in neighbor cache\n");
+  }
+
+  rpl_lock_parent(p);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
 static void
 dao_input(void)
 {
   uip_ipaddr_t dao_sender_addr;
+  uip_lladdr_t dao_sender_lladdr;
   rpl_dag_t *dag;
   rpl_instance_t *instance;
   unsigned char *buffer;
   uint16_t sequence;
   uint8_t instance_id;
   uint8_t lifetime;
-  uint8_t prefixlen;
   uint8_t flags;
   uint8_t subopt_type;
   /*
   uint8_t pathcontrol;
   uint8_t pathsequence;
   */
-  uip_ipaddr_t prefix;
+  struct dao_target targets[DAO_MAX_TARGETS];
+  struct dao_target *t;
+  uint8_t num_targets;
+  uint8_t num_target_options;
+  uint8_t num_transit;
   uip_ds6_route_t *rep;
   uint8_t buffer_length;
   int pos;
   int len;
   int i;
   int learned_from;
-  rpl_parent_t *p;
-  uip_ds6_nbr_t *nbr;
+  int registered;
+  int forward;
+#if RPL_WITH_NON_STORING
+  uip_ipaddr_t parent_addr;
+
+  memset(&parent_addr, 0, sizeof(parent_addr));
+#endif /* RPL_WITH_NON_STORING */
 
-  prefixlen = 0;
+  num_targets = 0;
+  num_target_options = 0;
+  num_transit = 0;
 
   uip_ipaddr_copy(&dao_sender_addr, &UIP_IP_BUF->srcipaddr);
+  /* An aggregated DAO may be sent while the targets are processed,
+     which clears the packetbuf, so keep the link-layer sender. */
+  memcpy(&dao_sender_lladdr, packetbuf_addr(PACKETBUF_ADDR_SENDER),
+         sizeof(dao_sender_lladdr));
 
   /* Destination Advertisement Object */
   PRINTF("RPL: Received a DAO from ");
@@ -634,138 +733,315 @@ dao_input(void)
 
     switch(subopt_type) {
     case RPL_OPTION_TARGET:
-      /* Handle the target option. */
-      prefixlen = buffer[i + 3];
-      memset(&prefix, 0, sizeof(prefix));
-      memcpy(&prefix, buffer + i + 4, (prefixlen + 7) / CHAR_BIT);
+      /* Handle the target option. When there is no room left, the
+         last target is replaced. */
+      num_target_options++;
+      if(num_targets < DAO_MAX_TARGETS) {
+        num_targets++;
+      }
+      if(num_transit >= num_targets) {
+        num_transit = num_targets - 1;
+      }
+      t = &targets[num_targets - 1];
+      t->prefixlen = buffer[i + 3];
+      t->lifetime = instance->default_lifetime;
+      memset(&t->prefix, 0, sizeof(t->prefix));
+      memcpy(&t->prefix, buffer + i + 4, (t->prefixlen + 7) / CHAR_BIT);
       break;
     case RPL_OPTION_TRANSIT:
       /* The path sequence and control are ignored. */
       /*      pathcontrol = buffer[i + 3];
               pathsequence = buffer[i + 4];*/
       lifetime = buffer[i + 5];
-      /* The parent address is also ignored. */
+      /* The transit information applies to the targets preceding it. */
+      for(; num_transit < num_targets; num_transit++) {
+        targets[num_transit].lifetime = lifetime;
+      }
+#if RPL_WITH_NON_STORING
+      /* The parent address is only used in non-storing mode. */
+      if(buffer[i + 1] >= 4 + sizeof(parent_addr)) {
+        memcpy(&parent_addr, buffer + i + 6, sizeof(parent_addr));
+      }
+#endif /* RPL_WITH_NON_STORING */
       break;
     }
   }
 
-  PRINTF("RPL: DAO lifetime: %u, prefix length: %u prefix: ",
-          (unsigned)lifetime, (unsigned)prefixlen);
-  PRINT6ADDR(&prefix);
-  PRINTF("\n");
+  if(num_targets == 0) {
+    PRINTF("RPL: Ignoring a DAO without a target\n");
+    return;
+  }
 
-  rep = uip_ds6_route_lookup(&prefix);
-
-  if(lifetime == RPL_ZERO_LIFETIME) {
-    PRINTF("RPL: No-Path DAO received\n");
-    /* No-Path DAO received; invoke the route purging routine. */
-    if(rep != NULL &&
-       rep->state.nopath_received == 0 &&
-       rep->length == prefixlen &&
-       uip_ds6_route_nexthop(rep) != NULL &&
-       uip_ipaddr_cmp(uip_ds6_route_nexthop(rep), &dao_sender_addr)) {
-      PRINTF("RPL: Setting expiration timer for prefix ");
-      PRINT6ADDR(&prefix);
-      PRINTF("\n");
-      rep->state.nopath_received = 1;
-      rep->state.lifetime = DAO_EXPIRATION_TIMEOUT;
-
-      /* We forward the incoming no-path DAO to our parent, if we have
-         one. */
-      if(dag->preferred_parent != NULL &&
-         rpl_get_parent_ipaddr(dag->preferred_parent) != NULL) {
-        PRINTF("RPL: Forwarding no-path DAO to parent ");
-        PRINT6ADDR(rpl_get_parent_ipaddr(dag->preferred_parent));
-        PRINTF("\n");
-        uip_icmp6_send(rpl_get_parent_ipaddr(dag->preferred_parent),
-                       ICMP6_RPL, RPL_CODE_DAO, buffer_length);
-      }
-      if(flags & RPL_DAO_K_FLAG) {
-        dao_ack_output(instance, &dao_sender_addr, sequence);
+  for(i = 0; i < num_targets; i++) {
+    PRINTF("RPL: DAO lifetime: %u, prefix length: %u prefix: ",
+           (unsigned)targets[i].lifetime, (unsigned)targets[i].prefixlen);
+    PRINT6ADDR(&targets[i].prefix);
+    PRINTF("\n");
+  }
+
+#if RPL_WITH_NON_STORING
+  if(RPL_IS_NON_STORING(instance)) {
+    /* Non-storing DAOs are addressed to the root, which records the
+       DAG parent of the target instead of installing a route. */
+    if(dag->rank != ROOT_RANK(instance) ||
+       uip_is_addr_unspecified(&parent_addr)) {
+      PRINTF("RPL: Ignoring a non-storing DAO\n");
+      return;
+    }
+    for(i = 0; i < num_targets; i++) {
+      t = &targets[i];
+      if(t->lifetime == RPL_ZERO_LIFETIME) {
+        PRINTF("RPL: No-Path DAO received\n");
+        rpl_ns_expire_parent(dag, &t->prefix, &parent_addr);
+      } else if(rpl_ns_update_node(dag, &t->prefix, &parent_addr,
+                                   RPL_LIFETIME(instance, t->lifetime)) == NULL) {
+        RPL_STAT(rpl_stats.mem_overflows++);
+        PRINTF("RPL: Could not add a non-storing node after receiving a DAO\n");
+        return;
       }
     }
+    if(flags & RPL_DAO_K_FLAG) {
+      dao_ack_output(instance, &dao_sender_addr, sequence);
+    }
     return;
   }
+#endif /* RPL_WITH_NON_STORING */
 
   learned_from = uip_is_addr_mcast(&dao_sender_addr) ?
                  RPL_ROUTE_FROM_MULTICAST_DAO : RPL_ROUTE_FROM_UNICAST_DAO;
 
   PRINTF("RPL: DAO from %s\n",
          learned_from == RPL_ROUTE_FROM_UNICAST_DAO? "unicast": "multicast");
-  if(learned_from == RPL_ROUTE_FROM_UNICAST_DAO) {
-    /* Check whether this is a DAO forwarding loop. */
-    p = rpl_find_parent(dag, &dao_sender_addr);
-    /* check if this is a new DAO registration with an "illegal" rank */
-    /* if we already route to this node it is likely */
-    if(p != NULL &&
-       DAG_RANK(p->rank, instance) < DAG_RANK(dag->rank, instance)) {
-      PRINTF("RPL: Loop detected when receiving a unicast DAO from a node with a lower rank! (%u < %u)\n",
-          DAG_RANK(p->rank, instance), DAG_RANK(dag->rank, instance));
-      p->rank = INFINITE_RANK;
-      p->updated = 1;
-      return;
+
+  registered = 0;
+  forward = 0;
+  for(i = 0; i < num_targets; i++) {
+    t = &targets[i];
+    rep = uip_ds6_route_lookup(&t->prefix);
+
+    if(t->lifetime == RPL_ZERO_LIFETIME) {
+      PRINTF("RPL: No-Path DAO received\n");
+      /* No-Path DAO received; invoke the route purging routine. */
+      if(rep != NULL &&
+         rep->state.nopath_received == 0 &&
+         rep->length == t->prefixlen &&
+         uip_ds6_route_nexthop(rep) != NULL &&
+         uip_ipaddr_cmp(uip_ds6_route_nexthop(rep), &dao_sender_addr)) {
+        PRINTF("RPL: Setting expiration timer for prefix ");
+        PRINT6ADDR(&t->prefix);
+        PRINTF("\n");
+        rep->state.nopath_received = 1;
+        rep->state.lifetime = DAO_EXPIRATION_TIMEOUT;
+
+        /* We forward the incoming no-path DAO to our parent, if we
+           have one. */
+        forward = 1;
+#if RPL_WITH_DAO_AGGREGATION
+        dao_aggregate(dag, t);
+#endif /* RPL_WITH_DAO_AGGREGATION */
+      }
+      continue;
     }
 
-    /* If we get the DAO from our parent, we also have a loop. */
-    if(p != NULL && p == dag->preferred_parent) {
-      PRINTF("RPL: Loop detected when receiving a unicast DAO from our parent\n");
-      p->rank = INFINITE_RANK;
-      p->updated = 1;
-      return;
+    if(!registered) {
+      if(!dao_register_sender(dag, &dao_sender_addr, &dao_sender_lladdr,
+                              learned_from)) {
+        return;
+      }
+      registered = 1;
+    }
+
+    rep = rpl_add_route(dag, &t->prefix, t->prefixlen, &dao_sender_addr);
+    if(rep == NULL) {
+      RPL_STAT(rpl_stats.mem_overflows++);
+      PRINTF("RPL: Could not add a route after receiving a DAO\n");
+      continue;
+    }
+
+    rep->state.lifetime = RPL_LIFETIME(instance, t->lifetime);
+    rep->state.learned_from = learned_from;
+
+    if(learned_from == RPL_ROUTE_FROM_UNICAST_DAO) {
+      forward = 1;
+#if RPL_WITH_DAO_AGGREGATION
+      dao_aggregate(dag, t);
+#endif /* RPL_WITH_DAO_AGGREGATION */
     }
   }
 
-  PRINTF("RPL: adding DAO route\n");
+  if(!forward) {
+    return;
+  }
 
-  if((nbr = uip_ds6_nbr_lookup(&dao_sender_addr)) == NULL) {
-    if((nbr = uip_ds6_nbr_add(&dao_sender_addr,
-                              (uip_lladdr_t *)packetbuf_addr(PACKETBUF_ADDR_SENDER),
-                              0, NBR_REACHABLE)) != NULL) {
-      /* set reachable timer */
-      stimer_set(&nbr->reachable, UIP_ND6_REACHABLE_TIME / 1000);
-      PRINTF("RPL: Neighbor added to neighbor cache ");
-      PRINT6ADDR(&dao_sender_addr);
-      PRINTF(", ");
-      PRINTLLADDR((uip_lladdr_t *)packetbuf_addr(PACKETBUF_ADDR_SENDER));
-      PRINTF("\n");
-    } else {
-      PRINTF("RPL: Out of Memory, dropping DAO from ");
-      PRINT6ADDR(&dao_sender_addr);
-      PRINTF(", ");
-      PRINTLLADDR((uip_lladdr_t *)packetbuf_addr(PACKETBUF_ADDR_SENDER));
-      PRINTF("\n");
+#if !RPL_WITH_DAO_AGGREGATION
+  if(dag->preferred_parent != NULL &&
+     rpl_get_parent_ipaddr(dag->preferred_parent) != NULL) {
+    PRINTF("RPL: Forwarding DAO to parent ");
+    PRINT6ADDR(rpl_get_parent_ipaddr(dag->preferred_parent));
+    PRINTF("\n");
+    RPL_STAT(rpl_stats.dao_sent++);
+    /* The DAO is forwarded as received, with all of its targets. */
+    RPL_STAT(rpl_stats.dao_targets_sent += num_target_options);
+    uip_icmp6_send(rpl_get_parent_ipaddr(dag->preferred_parent),
+                   ICMP6_RPL, RPL_CODE_DAO, buffer_length);
+  }
+#endif /* !RPL_WITH_DAO_AGGREGATION */
+  if(flags & RPL_DAO_K_FLAG) {
+    dao_ack_output(instance, &dao_sender_addr, sequence);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+dao_output_header(rpl_dag_t *dag, unsigned char *buffer)
+{
+  int pos;
+
+  RPL_LOLLIPOP_INCREMENT(dao_sequence);
+  pos = 0;
+
+  buffer[pos++] = dag->instance->instance_id;
+  buffer[pos] = 0;
+#if RPL_DAO_SPECIFY_DAG
+  buffer[pos] |= RPL_DAO_D_FLAG;
+#endif /* RPL_DAO_SPECIFY_DAG */
+#if RPL_CONF_DAO_ACK
+  buffer[pos] |= RPL_DAO_K_FLAG;
+#endif /* RPL_CONF_DAO_ACK */
+  ++pos;
+  buffer[pos++] = 0; /* reserved */
+  buffer[pos++] = dao_sequence;
+#if RPL_DAO_SPECIFY_DAG
+  memcpy(buffer + pos, &dag->dag_id, sizeof(dag->dag_id));
+  pos+=sizeof(dag->dag_id);
+#endif /* RPL_DAO_SPECIFY_DAG */
+
+  return pos;
+}
+/*---------------------------------------------------------------------------*/
+static int
+dao_output_target_option(unsigned char *buffer, int pos,
+                         uip_ipaddr_t *prefix, uint8_t prefixlen)
+{
+  buffer[pos++] = RPL_OPTION_TARGET;
+  buffer[pos++] = 2 + ((prefixlen + 7) / CHAR_BIT);
+  buffer[pos++] = 0; /* reserved */
+  buffer[pos++] = prefixlen;
+  memcpy(buffer + pos, prefix, (prefixlen + 7) / CHAR_BIT);
+  pos += ((prefixlen + 7) / CHAR_BIT);
+
+  return pos;
+}
+/*---------------------------------------------------------------------------*/
+#if RPL_WITH_DAO_AGGREGATION
+static void
+dao_aggregate(rpl_dag_t *dag, struct dao_target *target)
+{
+  int i;
+
+  for(i = 0; i < num_aggregated; i++) {
+    if(aggregated[i].dag == dag &&
+       aggregated[i].target.prefixlen == target->prefixlen &&
+       uip_ipaddr_cmp(&aggregated[i].target.prefix, &target->prefix)) {
+      /* The latest advertisement of a target replaces the pending one. */
+      aggregated[i].target.lifetime = target->lifetime;
       return;
     }
-  } else {
-    PRINTF("RPL: Neighbor already in neighbor cache\n");
   }
 
-  rpl_lock_parent(p);
-
-  rep = rpl_add_route(dag, &prefix, prefixlen, &dao_sender_addr);
-  if(rep == NULL) {
-    RPL_STAT(rpl_stats.mem_overflows++);
-    PRINTF("RPL: Could not add a route after receiving a DAO\n");
-    return;
+  if(num_aggregated == DAO_MAX_TARGETS) {
+    dao_output_aggregated();
   }
 
-  rep->state.lifetime = RPL_LIFETIME(instance, lifetime);
-  rep->state.learned_from = learned_from;
+  aggregated[num_aggregated].dag = dag;
+  memcpy(&aggregated[num_aggregated].target, target, sizeof(*target));
+  num_aggregated++;
 
-  if(learned_from == RPL_ROUTE_FROM_UNICAST_DAO) {
-    if(dag->preferred_parent != NULL &&
-       rpl_get_parent_ipaddr(dag->preferred_parent) != NULL) {
-      PRINTF("RPL: Forwarding DAO to parent ");
-      PRINT6ADDR(rpl_get_parent_ipaddr(dag->preferred_parent));
-      PRINTF("\n");
-      uip_icmp6_send(rpl_get_parent_ipaddr(dag->preferred_parent),
-                     ICMP6_RPL, RPL_CODE_DAO, buffer_length);
+  rpl_schedule_dao_aggregation();
+}
+/*---------------------------------------------------------------------------*/
+void
+dao_output_aggregated(void)
+{
+  rpl_dag_t *dag;
+  unsigned char *buffer;
+  uip_ipaddr_t *dest;
+  uint8_t lifetime;
+  int pos;
+  int count;
+  int i;
+  int j;
+
+  while(num_aggregated > 0) {
+    dag = aggregated[0].dag;
+
+    dest = NULL;
+    if(dag->used && dag->preferred_parent != NULL &&
+       rpl_get_mode() != RPL_MODE_FEATHER) {
+      dest = rpl_get_parent_ipaddr(dag->preferred_parent);
     }
-    if(flags & RPL_DAO_K_FLAG) {
-      dao_ack_output(instance, &dao_sender_addr, sequence);
+
+    buffer = UIP_ICMP_PAYLOAD;
+    pos = 0;
+    if(dest != NULL) {
+#ifdef RPL_DEBUG_DAO_OUTPUT
+      RPL_DEBUG_DAO_OUTPUT(dag->preferred_parent);
+#endif
+      pos = dao_output_header(dag, buffer);
+    }
+
+    /* Group the targets of the DAG by lifetime. Each group is followed
+       by a transit information option. */
+    count = 0;
+    for(i = 0; i < num_aggregated; i++) {
+      if(aggregated[i].dag != dag) {
+        continue;
+      }
+      lifetime = aggregated[i].target.lifetime;
+      for(j = i; j < num_aggregated; j++) {
+        if(aggregated[j].dag == dag &&
+           aggregated[j].target.lifetime == lifetime) {
+          if(dest != NULL) {
+            pos = dao_output_target_option(buffer, pos,
+                                           &aggregated[j].target.prefix,
+                                           aggregated[j].target.prefixlen);
+          }
+          aggregated[j].dag = NULL;
+          count++;
+        }
+      }
+      if(dest != NULL) {
+        buffer[pos++] = RPL_OPTION_TRANSIT;
+        buffer[pos++] = 4;
+        buffer[pos++] = 0; /* flags - ignored */
+        buffer[pos++] = 0; /* path control - ignored */
+        buffer[pos++] = 0; /* path seq - ignored */
+        buffer[pos++] = lifetime;
+      }
     }
+
+    /* Remove the targets of the DAG from the queue. */
+    for(i = 0, j = 0; i < num_aggregated; i++) {
+      if(aggregated[i].dag != NULL) {
+        aggregated[j++] = aggregated[i];
+      }
+    }
+    num_aggregated = j;
+
+    if(dest == NULL) {
+      PRINTF("RPL: No DAO parent, dropping %d aggregated targets\n", count);
+      continue;
+    }
+
+    PRINTF("RPL: Sending an aggregated DAO with %d targets to ", count);
+    PRINT6ADDR(dest);
+    PRINTF("\n");
+
+    RPL_STAT(rpl_stats.dao_sent++);
+    RPL_STAT(rpl_stats.dao_targets_sent += count);
+    uip_icmp6_send(dest, ICMP6_RPL, RPL_CODE_DAO, pos);
   }
 }
+#endif /* RPL_WITH_DAO_AGGREGATION */
 /*---------------------------------------------------------------------------*/
 void
 dao_output(rpl_parent_t *parent, uint8_t lifetime)
@@ -790,6 +1066,7 @@ dao_output_target(rpl_parent_t *parent, uip_ipaddr_t *prefix, uint8_t lifetime)
   unsigned char *buffer;
   uint8_t prefixlen;
   int pos;
+  uip_ipaddr_t *dest;
 
   /* Destination Advertisement Object */
 
@@ -819,57 +1096,66 @@ dao_output_target(rpl_parent_t *parent, uip_ipaddr_t *prefix, uint8_t lifetime)
     PRINTF("RPL dao_output_target error prefix NULL\n");
     return;
   }
+#if RPL_WITH_DAO_AGGREGATION
+  if(!RPL_IS_NON_STORING(instance) && num_aggregated > 0 &&
+     parent == dag->preferred_parent) {
+    /* Send our own target along with the targets we are about to
+       forward to the same parent. */
+    struct dao_target target;
+
+    memcpy(&target.prefix, prefix, sizeof(target.prefix));
+    target.prefixlen = sizeof(*prefix) * CHAR_BIT;
+    target.lifetime = lifetime;
+    dao_aggregate(dag, &target);
+    return;
+  }
+#endif /* RPL_WITH_DAO_AGGREGATION */
+
 #ifdef RPL_DEBUG_DAO_OUTPUT
   RPL_DEBUG_DAO_OUTPUT(parent);
 #endif
 
   buffer = UIP_ICMP_PAYLOAD;
-
-  RPL_LOLLIPOP_INCREMENT(dao_sequence);
-  pos = 0;
-
-  buffer[pos++] = instance->instance_id;
-  buffer[pos] = 0;
-#if RPL_DAO_SPECIFY_DAG
-  buffer[pos] |= RPL_DAO_D_FLAG;
-#endif /* RPL_DAO_SPECIFY_DAG */
-#if RPL_CONF_DAO_ACK
-  buffer[pos] |= RPL_DAO_K_FLAG;
-#endif /* RPL_CONF_DAO_ACK */
-  ++pos;
-  buffer[pos++] = 0; /* reserved */
-  buffer[pos++] = dao_sequence;
-#if RPL_DAO_SPECIFY_DAG
-  memcpy(buffer + pos, &dag->dag_id, sizeof(dag->dag_id));
-  pos+=sizeof(dag->dag_id);
-#endif /* RPL_DAO_SPECIFY_DAG */
+  pos = dao_output_header(dag, buffer);
 
   /* create target subopt */
   prefixlen = sizeof(*prefix) * CHAR_BIT;
-  buffer[pos++] = RPL_OPTION_TARGET;
-  buffer[pos++] = 2 + ((prefixlen + 7) / CHAR_BIT);
-  buffer[pos++] = 0; /* reserved */
-  buffer[pos++] = prefixlen;
-  memcpy(buffer + pos, prefix, (prefixlen + 7) / CHAR_BIT);
-  pos += ((prefixlen + 7) / CHAR_BIT);
+  pos = dao_output_target_option(buffer, pos, prefix, prefixlen);
 
   /* Create a transit information sub-option. */
   buffer[pos++] = RPL_OPTION_TRANSIT;
-  buffer[pos++] = 4;
+  buffer[pos++] = RPL_IS_NON_STORING(instance) ? 4 + 16 : 4;
   buffer[pos++] = 0; /* flags - ignored */
   buffer[pos++] = 0; /* path control - ignored */
   buffer[pos++] = 0; /* path seq - ignored */
   buffer[pos++] = lifetime;
 
+  dest = rpl_get_parent_ipaddr(parent);
+  if(dest == NULL) {
+    return;
+  }
+
+#if RPL_WITH_NON_STORING
+  if(RPL_IS_NON_STORING(instance)) {
+    /* Report the global address of the parent, made from the DAG
+       prefix and the interface identifier of its link-local address,
+       and send the DAO to the root. */
+    memcpy(buffer + pos, &dag->prefix_info.prefix, 8);
+    memcpy(buffer + pos + 8, ((unsigned char *)dest) + 8, 8);
+    pos += 16;
+    dest = &dag->dag_id;
+  }
+#endif /* RPL_WITH_NON_STORING */
+
   PRINTF("RPL: Sending DAO with prefix ");
   PRINT6ADDR(prefix);
   PRINTF(" to ");
-  PRINT6ADDR(rpl_get_parent_ipaddr(parent));
+  PRINT6ADDR(dest);
   PRINTF("\n");
 
-  if(rpl_get_parent_ipaddr(parent) != NULL) {
-    uip_icmp6_send(rpl_get_parent_ipaddr(parent), ICMP6_RPL, RPL_CODE_DAO, pos);
-  }
+  RPL_STAT(rpl_stats.dao_sent++);
+  RPL_STAT(rpl_stats.dao_targets_sent++);
+  uip_icmp6_send(dest, ICMP6_RPL, RPL_CODE_DAO, pos);
 }
 /*---------------------------------------------------------------------------*/
 static void
@@ -0,0 +1,341 @@
+/**
+ * \addtogroup uip6
+ * @{
+ */
+/*
+ * Copyright (c) 2013, the Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+/**
+ * \file
+ *         DAG parent table of the root of a non-storing RPL DAG.
+ *
+ *         In non-storing mode, every node reports its preferred
+ *         parent to the DAG root in its DAOs. The root keeps one
+ *         entry per node and walks the parent links to build the
+ *         source routes of downward packets.
+ */
+
+#include "net/rpl/rpl-private.h"
+#include "lib/list.h"
+#include "lib/memb.h"
+
+#define DEBUG DEBUG_NONE
+#include "net/uip-debug.h"
+
+#include <string.h>
+
+#if UIP_CONF_IPV6 && RPL_WITH_NON_STORING
+
+LIST(nodelist);
+MEMB(nodememb, rpl_ns_node_t, RPL_NS_LINK_NUM);
+
+/* Set when a node has expired, so that the periodic function knows
+   that it may have to free nodes that nobody refers to anymore. */
+static uint8_t need_cleanup;
+/*---------------------------------------------------------------------------*/
+static int
+node_matches_address(const rpl_dag_t *dag, const rpl_ns_node_t *node,
+                     const uip_ipaddr_t *addr)
+{
+  return node->dag == dag &&
+    memcmp(node->link_identifier, ((const unsigned char *)addr) + 8, 8) == 0;
+}
+/*---------------------------------------------------------------------------*/
+static int
+in_dag_prefix(const rpl_dag_t *dag, const uip_ipaddr_t *addr)
+{
+  return dag->prefix_info.length > 0 &&
+    uip_ipaddr_prefixcmp(addr, &dag->prefix_info.prefix,
+                         dag->prefix_info.length);
+}
+/*---------------------------------------------------------------------------*/
+static int
+is_root_address(const uip_ipaddr_t *addr)
+{
+  uip_ds6_addr_t *lladdr;
+
+  /* Nodes build the address of their parent from the DAG prefix and
+     the link-local address of the parent, which need not be one of
+     the global addresses of the root. */
+  if(uip_ds6_is_my_addr((uip_ipaddr_t *)addr)) {
+    return 1;
+  }
+  lladdr = uip_ds6_get_link_local(-1);
+  return lladdr != NULL &&
+    memcmp(((unsigned char *)&lladdr->ipaddr) + 8,
+           ((const unsigned char *)addr) + 8, 8) == 0;
+}
+/*---------------------------------------------------------------------------*/
+void
+rpl_ns_init(void)
+{
+  list_init(nodelist);
+  memb_init(&nodememb);
+  need_cleanup = 0;
+}
+/*---------------------------------------------------------------------------*/
+rpl_ns_node_t *
+rpl_ns_get_node(const rpl_dag_t *dag, const uip_ipaddr_t *addr)
+{
+  rpl_ns_node_t *l;
+
+  if(!in_dag_prefix(dag, addr)) {
+    return NULL;
+  }
+
+  for(l = list_head(nodelist); l != NULL; l = list_item_next(l)) {
+    if(node_matches_address(dag, l, addr)) {
+      return l;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static rpl_ns_node_t *
+add_node(rpl_dag_t *dag, const uip_ipaddr_t *addr)
+{
+  rpl_ns_node_t *node;
+
+  node = memb_alloc(&nodememb);
+  if(node == NULL) {
+    PRINTF("RPL: No space for more non-storing nodes\n");
+    return NULL;
+  }
+
+  node->dag = dag;
+  node->parent = NULL;
+  node->lifetime = 0;
+  memcpy(node->link_identifier, ((const unsigned char *)addr) + 8, 8);
+  list_add(nodelist, node);
+  return node;
+}
+/*---------------------------------------------------------------------------*/
+rpl_ns_node_t *
+rpl_ns_update_node(rpl_dag_t *dag, const uip_ipaddr_t *child,
+                   const uip_ipaddr_t *parent, uint32_t lifetime)
+{
+  rpl_ns_node_t *child_node;
+  rpl_ns_node_t *parent_node;
+
+  if(!in_dag_prefix(dag, child)) {
+    PRINTF("RPL: Non-storing target outside of the DAG prefix\n");
+    return NULL;
+  }
+
+  child_node = rpl_ns_get_node(dag, child);
+  if(child_node == NULL) {
+    child_node = add_node(dag, child);
+    if(child_node == NULL) {
+      return NULL;
+    }
+  }
+
+  if(is_root_address(parent)) {
+    /* A direct child of the root. */
+    parent_node = NULL;
+  } else {
+    parent_node = rpl_ns_get_node(dag, parent);
+    if(parent_node == NULL) {
+      /* We learn about the parent before its own DAO arrives. */
+      parent_node = add_node(dag, parent);
+      if(parent_node == NULL) {
+        return NULL;
+      }
+    }
+  }
+
+  child_node->parent = parent_node;
+  child_node->lifetime = lifetime;
+
+  PRINTF("RPL: Non-storing node ");
+  PRINT6ADDR(child);
+  PRINTF(" has parent ");
+  PRINT6ADDR(parent);
+  PRINTF(", lifetime %lu\n", (unsigned long)lifetime);
+
+  return child_node;
+}
+/*---------------------------------------------------------------------------*/
+void
+rpl_ns_expire_parent(rpl_dag_t *dag, const uip_ipaddr_t *child,
+                     const uip_ipaddr_t *parent)
+{
+  rpl_ns_node_t *child_node;
+  rpl_ns_node_t *parent_node;
+
+  child_node = rpl_ns_get_node(dag, child);
+  if(child_node == NULL || child_node->lifetime == 0) {
+    return;
+  }
+
+  if(is_root_address(parent)) {
+    parent_node = NULL;
+  } else {
+    parent_node = rpl_ns_get_node(dag, parent);
+    if(parent_node == NULL) {
+      return;
+    }
+  }
+
+  /* Only forget the link if the node has not already reported a new
+     parent. */
+  if(child_node->parent == parent_node) {
+    child_node->lifetime = 0;
+    child_node->parent = NULL;
+    need_cleanup = 1;
+  }
+}
+/*---------------------------------------------------------------------------*/
+int
+rpl_ns_is_node_reachable(const rpl_dag_t *dag, const uip_ipaddr_t *addr)
+{
+  rpl_ns_node_t *node;
+  int hops;
+
+  node = rpl_ns_get_node(dag, addr);
+
+  /* Walk up to the root. The hop count protects against loops, which
+     may exist briefly while nodes change parents. */
+  for(hops = 0; node != NULL && hops < RPL_NS_LINK_NUM; hops++) {
+    if(node->lifetime == 0) {
+      return 0;
+    }
+    if(node->parent == NULL) {
+      return 1;
+    }
+    node = node->parent;
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+void
+rpl_ns_get_node_global_addr(uip_ipaddr_t *addr, const rpl_ns_node_t *node)
+{
+  memcpy(addr, &node->dag->prefix_info.prefix, 8);
+  memcpy(((unsigned char *)addr) + 8, node->link_identifier, 8);
+}
+/*---------------------------------------------------------------------------*/
+rpl_ns_node_t *
+rpl_ns_node_head(void)
+{
+  return list_head(nodelist);
+}
+/*---------------------------------------------------------------------------*/
+rpl_ns_node_t *
+rpl_ns_node_next(rpl_ns_node_t *node)
+{
+  return list_item_next(node);
+}
+/*---------------------------------------------------------------------------*/
+int
+rpl_ns_num_nodes(void)
+{
+  return list_length(nodelist);
+}
+/*---------------------------------------------------------------------------*/
+static void
+free_node(rpl_ns_node_t *node)
+{
+  rpl_ns_node_t *l;
+
+  for(l = list_head(nodelist); l != NULL; l = list_item_next(l)) {
+    if(l->parent == node) {
+      l->parent = NULL;
+      l->lifetime = 0;
+    }
+  }
+  list_remove(nodelist, node);
+  memb_free(&nodememb, node);
+}
+/*---------------------------------------------------------------------------*/
+void
+rpl_ns_remove_nodes(rpl_dag_t *dag)
+{
+  rpl_ns_node_t *l;
+
+  l = list_head(nodelist);
+  while(l != NULL) {
+    if(l->dag == dag) {
+      free_node(l);
+      l = list_head(nodelist);
+    } else {
+      l = list_item_next(l);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+is_parent(const rpl_ns_node_t *node)
+{
+  rpl_ns_node_t *l;
+
+  for(l = list_head(nodelist); l != NULL; l = list_item_next(l)) {
+    if(l->parent == node) {
+      return 1;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+void
+rpl_ns_periodic(void)
+{
+  rpl_ns_node_t *l;
+  rpl_ns_node_t *next;
+
+  for(l = list_head(nodelist); l != NULL; l = list_item_next(l)) {
+    if(l->lifetime > 0 && --l->lifetime == 0) {
+      l->parent = NULL;
+      need_cleanup = 1;
+    }
+  }
+
+  if(need_cleanup) {
+    /* Free the expired nodes that are nobody's parent. Nodes that are
+       still referenced stay in the table until their children report
+       a new parent or expire as well. */
+    need_cleanup = 0;
+    for(l = list_head(nodelist); l != NULL; l = next) {
+      next = list_item_next(l);
+      if(l->lifetime == 0) {
+        if(is_parent(l)) {
+          need_cleanup = 1;
+        } else {
+          list_remove(nodelist, l);
+          memb_free(&nodememb, l);
+        }
+      }
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+#endif /* UIP_CONF_IPV6 && RPL_WITH_NON_STORING */
@@ -177,10 +177,18 @@
 
 #ifdef  RPL_CONF_MOP
 #define RPL_MOP_DEFAULT                 RPL_CONF_MOP
+#elif RPL_WITH_NON_STORING
+#define RPL_MOP_DEFAULT                 RPL_MOP_NON_STORING
 #else
 #define RPL_MOP_DEFAULT                 RPL_MOP_STORING_NO_MULTICAST
 #endif
 
+#if RPL_WITH_NON_STORING
+#define RPL_IS_NON_STORING(instance)    ((instance)->mop == RPL_MOP_NON_STORING)
+#else
+#define RPL_IS_NON_STORING(instance)    0
+#endif /* RPL_WITH_NON_STORING */
+
 /*
  * The ETX in the metric container is expressed as a fixed-point value 
  * whose integer part can be obtained by dividing the value by 
@@ -248,6 +256,8 @@ struct rpl_stats {
   uint16_t malformed_msgs;
   uint16_t resets;
   uint16_t parent_switch;
+  uint16_t dao_sent;
+  uint16_t dao_targets_sent;
 };
 typedef struct rpl_stats rpl_stats_t;
 
@@ -272,6 +282,9 @@ void dio_output(rpl_instance_t *, uip_ipaddr_t *uc_addr);
 void dao_output(rpl_parent_t *, uint8_t lifetime);
 void dao_output_target(rpl_parent_t *, uip_ipaddr_t *, uint8_t lifetime);
 void dao_ack_output(rpl_instance_t *, uip_ipaddr_t *, uint8_t);
+#if RPL_WITH_DAO_AGGREGATION
+void dao_output_aggregated(void);
+#endif /* RPL_WITH_DAO_AGGREGATION */
 
 /* RPL logic functions. */
 void rpl_join_dag(uip_ipaddr_t *from, rpl_dio_t *dio);
@@ -314,6 +327,9 @@ rpl_of_t *rpl_find_of(rpl_ocp_t);
 void rpl_schedule_dao(rpl_instance_t *);
 void rpl_schedule_dao_immediately(rpl_instance_t *);
 void rpl_cancel_dao(rpl_instance_t *instance);
+#if RPL_WITH_DAO_AGGREGATION
+void rpl_schedule_dao_aggregation(void);
+#endif /* RPL_WITH_DAO_AGGREGATION */
 
 void rpl_reset_dio_timer(rpl_instance_t *);
 void rpl_reset_periodic_timer(void);
@@ -321,4 +337,33 @@ void rpl_reset_periodic_timer(void);
 /* Route poisoning. */
 void rpl_poison_routes(rpl_dag_t *, rpl_parent_t *);
 
+#if RPL_WITH_NON_STORING
+/* DAG parent table of the root of a non-storing DAG. A node is
+   identified by its interface identifier within the DAG prefix. Nodes
+   with a NULL parent are children of the root; nodes with a zero
+   lifetime are only known as the parent of another node. */
+struct rpl_ns_node {
+  struct rpl_ns_node *next;
+  uint32_t lifetime;
+  rpl_dag_t *dag;
+  struct rpl_ns_node *parent;
+  uint8_t link_identifier[8];
+};
+typedef struct rpl_ns_node rpl_ns_node_t;
+
+void rpl_ns_init(void);
+rpl_ns_node_t *rpl_ns_update_node(rpl_dag_t *dag, const uip_ipaddr_t *child,
+                                  const uip_ipaddr_t *parent, uint32_t lifetime);
+void rpl_ns_expire_parent(rpl_dag_t *dag, const uip_ipaddr_t *child,
+                          const uip_ipaddr_t *parent);
+rpl_ns_node_t *rpl_ns_get_node(const rpl_dag_t *dag, const uip_ipaddr_t *addr);
+int rpl_ns_is_node_reachable(const rpl_dag_t *dag, const uip_ipaddr_t *addr);
+void rpl_ns_get_node_global_addr(uip_ipaddr_t *addr, const rpl_ns_node_t *node);
+rpl_ns_node_t *rpl_ns_node_head(void);
+rpl_ns_node_t *rpl_ns_node_next(rpl_ns_node_t *node);
+int rpl_ns_num_nodes(void);
+void rpl_ns_remove_nodes(rpl_dag_t *dag);
+void rpl_ns_periodic(void);
+#endif /* RPL_WITH_NON_STORING */
+
 #endif /* RPL_PRIVATE_H */
@@ -66,6 +66,9 @@ static void
 handle_periodic_timer(void *ptr)
 {
   rpl_purge_routes();
+#if RPL_WITH_NON_STORING
+  rpl_ns_periodic();
+#endif /* RPL_WITH_NON_STORING */
   rpl_recalculate_ranks();
 
   /* handle DIS */
@@ -293,4 +296,42 @@ rpl_cancel_dao(rpl_instance_t *instance)
   ctimer_stop(&instance->dao_lifetime_timer);
 }
 /*---------------------------------------------------------------------------*/
+#if RPL_WITH_DAO_AGGREGATION
+static struct ctimer dao_aggregation_timer;
+static clock_time_t dao_aggregation_sent;
+
+static void
+handle_dao_aggregation_timer(void *ptr)
+{
+  dao_aggregation_sent = clock_time();
+  dao_output_aggregated();
+}
+/*---------------------------------------------------------------------------*/
+void
+rpl_schedule_dao_aggregation(void)
+{
+  clock_time_t expiration_time;
+  clock_time_t elapsed;
+
+  if(!ctimer_expired(&dao_aggregation_timer)) {
+    PRINTF("RPL: DAO aggregation timer already scheduled\n");
+    return;
+  }
+
+  /* Collect targets for the aggregation window, but do not send
+     aggregated DAOs more often than once per interval. */
+  expiration_time = RPL_DAO_AGGREGATION_WINDOW;
+  elapsed = clock_time() - dao_aggregation_sent;
+  if(elapsed < RPL_DAO_AGGREGATION_INTERVAL &&
+     RPL_DAO_AGGREGATION_INTERVAL - elapsed > expiration_time) {
+    expiration_time = RPL_DAO_AGGREGATION_INTERVAL - elapsed;
+  }
+
+  PRINTF("RPL: Scheduling DAO aggregation timer %u ticks in the future\n",
+         (unsigned)expiration_time);
+  ctimer_set(&dao_aggregation_timer, expiration_time,
+             handle_dao_aggregation_timer, NULL);
+}
+/*---------------------------------------------------------------------------*/
+#endif /* RPL_WITH_DAO_AGGREGATION */
 #endif /* UIP_CONF_IPV6 */
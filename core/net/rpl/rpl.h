@@ -240,6 +240,10 @@ int rpl_verify_header(int);
 void rpl_insert_header(void);
 void rpl_remove_header(void);
 uint8_t rpl_invert_header(void);
+#if RPL_WITH_NON_STORING
+uip_ipaddr_t *rpl_update_header_srh(void);
+int rpl_process_srh_header(void);
+#endif /* RPL_WITH_NON_STORING */
 uip_ipaddr_t *rpl_get_parent_ipaddr(rpl_parent_t *nbr);
 rpl_rank_t rpl_get_parent_rank(uip_lladdr_t *addr);
 uint16_t rpl_get_parent_link_metric(const uip_lladdr_t *addr);
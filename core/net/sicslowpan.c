@@ -63,6 +63,7 @@
 #include "net/tcpip.h"
 #include "net/uip.h"
 #include "net/uip-ds6.h"
+#include "net/uip-icmp6.h"
 #include "net/rime.h"
 #include "net/sicslowpan.h"
 #include "net/netstack.h"
@@ -212,6 +213,13 @@ static uint8_t uncomp_hdr_len;
  * the result of the last transmitted fragment
  */
 static int last_tx_status;
+
+/**
+ * The packetbuf attributes of the packet being sent, set before its
+ * header is compressed. They are applied again to every fragment.
+ */
+static struct packetbuf_attr out_attrs[PACKETBUF_NUM_ATTRS];
+static struct packetbuf_addr out_addrs[PACKETBUF_NUM_ADDRS];
 /** @} */
 
 #if SICSLOWPAN_CONF_FRAG
@@ -219,42 +227,96 @@ static int last_tx_status;
  *  @{
  */
 
-static uint16_t sicslowpan_len;
+/** The number of 8-byte units in the largest datagram reassembled. */
+#define SICSLOWPAN_REASS_UNITS ((UIP_BUFSIZE - UIP_LLH_LEN + 7) / 8)
 
 /**
- * The buffer used for the 6lowpan reassembly.
- * This buffer contains only the IPv6 packet (no MAC header, 6lowpan, etc).
- * It has a fix size as we do not use dynamic memory allocation.
+ * A 6lowpan reassembly context. Fragments are matched to a context by
+ * their sender, datagram tag and datagram size, so that datagrams from
+ * several senders can be reassembled at the same time.
  */
-static uip_buf_t sicslowpan_aligned_buf;
-#define sicslowpan_buf (sicslowpan_aligned_buf.u8)
+struct sicslowpan_reass {
+  /**
+   * The buffer used for the reassembly. This buffer contains only the
+   * IPv6 packet (no MAC header, 6lowpan, etc). It has a fix size as we
+   * do not use dynamic memory allocation.
+   */
+  uip_buf_t buf;
+  /** The total length of the IPv6 packet, zero if the context is unused. */
+  uint16_t len;
+  /**
+   * One bit for each 8-byte unit of the IP packet already received,
+   * so that a duplicate fragment is not counted twice.
+   */
+  uint8_t received[(SICSLOWPAN_REASS_UNITS + 7) / 8];
+  /** The tag in the fragments being merged. */
+  uint16_t tag;
+  /** The source address of the fragments being merged */
+  rimeaddr_t sender;
+  /** Reassembly %process %timer. */
+  struct timer timer;
+};
 
-/** The total length of the IPv6 packet in the sicslowpan_buf. */
+static struct sicslowpan_reass reass_contexts[SICSLOWPAN_REASS_CONTEXTS];
+
+/** The reassembly context of the fragment being processed. */
+static struct sicslowpan_reass *reass;
 
 /**
- * length of the ip packet already sent / received.
- * It includes IP and transport headers.
+ * The buffer the packet being processed is uncompressed into: the
+ * reassembly buffer for fragments, and uip_buf for packets that are
+ * not fragmented.
  */
-static uint16_t processed_ip_in_len;
+static uint8_t *sicslowpan_buf;
 
 /** Datagram tag to be put in the fragments I send. */
 static uint16_t my_tag;
 
-/** When reassembling, the tag in the fragments being merged. */
-static uint16_t reass_tag;
+static struct sicslowpan_frag_stats frag_stats;
+
+#if SICSLOWPAN_FRAG_TX_CONTEXTS > 0
+/**
+ * A fragmented datagram being sent. The next fragment is only handed
+ * to the MAC layer once the previous one has been reported as
+ * delivered, so each context holds its own copy of the datagram.
+ */
+struct sicslowpan_frag_tx {
+  /** The IPv6 packet being fragmented. */
+  uint8_t buf[UIP_BUFSIZE];
+  /** The total length of the IPv6 packet, zero if the context is unused. */
+  uint16_t len;
+  /** Length of the IPv6 packet already sent. */
+  uint16_t processed_len;
+  /** The tag of the fragments. */
+  uint16_t tag;
+  /** Identifies the fragment last handed to the MAC layer, so that a
+      late sent callback is not taken for one of a later datagram. */
+  uint16_t generation;
+  /** The payload length of the FRAGN fragments. */
+  int payload_len;
+  /** The link layer destination of the fragments. */
+  rimeaddr_t dest;
+  /** Non-zero if the datagram is a routing or neighbor discovery message. */
+  uint8_t is_control;
+  /** The packetbuf attributes of the first fragment. */
+  struct packetbuf_attr attrs[PACKETBUF_NUM_ATTRS];
+  struct packetbuf_addr addrs[PACKETBUF_NUM_ADDRS];
+  /** Paces the transmission of the fragments, and aborts the datagram
+      if the MAC layer does not report a fragment in time. */
+  struct ctimer timer;
+};
 
-/** When reassembling, the source address of the fragments being merged */
-rimeaddr_t frag_sender;
+static struct sicslowpan_frag_tx frag_tx_contexts[SICSLOWPAN_FRAG_TX_CONTEXTS];
 
-/** Reassembly %process %timer. */
-static struct timer reass_timer;
+/** The generation of the last fragment sent from a context, never 0. */
+static uint16_t frag_tx_generation;
+#endif /* SICSLOWPAN_FRAG_TX_CONTEXTS > 0 */
 
 /** @} */
 #else /* SICSLOWPAN_CONF_FRAG */
 /** The buffer used for the 6lowpan processing is uip_buf.
     We do not use any additional buffer.*/
 #define sicslowpan_buf uip_buf
-#define sicslowpan_len uip_len
 #endif /* SICSLOWPAN_CONF_FRAG */
 
 static int last_rssi;
@@ -1301,6 +1363,10 @@ compress_hdr_ipv6(rimeaddr_t *rime_destaddr)
 /** \name Input/output functions common to all compression schemes
  * @{                                                                 */
 /*--------------------------------------------------------------------*/
+#if SICSLOWPAN_FRAG_TX_CONTEXTS > 0
+static void frag_tx_sent(uint16_t generation, int status);
+#endif /* SICSLOWPAN_FRAG_TX_CONTEXTS > 0 */
+/*--------------------------------------------------------------------*/
 /**
  * Callback function for the MAC packet sent callback
  */
@@ -1313,15 +1379,39 @@ packet_sent(void *ptr, int status, int transmissions)
     callback->output_callback(status);
   }
   last_tx_status = status;
+
+#if SICSLOWPAN_FRAG_TX_CONTEXTS > 0
+  if(ptr != NULL) {
+    frag_tx_sent((uint16_t)(uintptr_t)ptr, status);
+  }
+#endif /* SICSLOWPAN_FRAG_TX_CONTEXTS > 0 */
+}
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Check if the IPv6 packet in uip_buf is a routing or neighbor
+ * discovery message, which may be given precedence over data by the
+ * MAC layer.
+ */
+static int
+is_control_packet(void)
+{
+  return UIP_IP_BUF->proto == UIP_PROTO_ICMP6 &&
+    (UIP_ICMP_BUF->type == ICMP6_RPL ||
+     (UIP_ICMP_BUF->type >= ICMP6_RS &&
+      UIP_ICMP_BUF->type <= ICMP6_REDIRECT));
 }
 /*--------------------------------------------------------------------*/
 /**
  * \brief This function is called by the 6lowpan code to send out a
  * packet.
  * \param dest the link layer destination address of the packet
+ * \param ptr the generation of the fragment, or NULL if the packet
+ * is not sent from a fragmentation context
+ * \param is_control non-zero if the packet belongs to a routing or
+ * neighbor discovery message
  */
 static void
-send_packet(rimeaddr_t *dest)
+send_packet(rimeaddr_t *dest, void *ptr, int is_control)
 {
   /* Set the link layer destination address for the packet as a
    * packetbuf attribute. The MAC layer can access the destination
@@ -1339,14 +1429,171 @@ send_packet(rimeaddr_t *dest)
     packetbuf_set_attr(PACKETBUF_ATTR_RELIABLE, 1);
 #endif
 
+  /* Routing and neighbor discovery messages may be given precedence
+     over data by the MAC layer. A packet type set by the caller, such
+     as a TCP stream, is kept. */
+  if(is_control && packetbuf_attr(PACKETBUF_ATTR_PACKET_TYPE) ==
+     PACKETBUF_ATTR_PACKET_TYPE_DATA) {
+    packetbuf_set_attr(PACKETBUF_ATTR_PACKET_TYPE,
+                       PACKETBUF_ATTR_PACKET_TYPE_CONTROL);
+  }
+
   /* Provide a callback function to receive the result of
      a packet transmission. */
-  NETSTACK_MAC.send(&packet_sent, NULL);
+  NETSTACK_MAC.send(&packet_sent, ptr);
 
   /* If we are sending multiple packets in a row, we need to let the
      watchdog know that we are still alive. */
   watchdog_periodic();
 }
+#if SICSLOWPAN_CONF_FRAG
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Build a FRAGN fragment in packetbuf.
+ * \param ip the IPv6 packet being fragmented
+ * \param len the total length of the IPv6 packet
+ * \param tag the datagram tag
+ * \param offset the offset of the fragment in the IPv6 packet
+ * \param payload_len the length of the fragment payload
+ * \param attrs the packetbuf attributes of the first fragment
+ * \param addrs the packetbuf addresses of the first fragment
+ */
+static void
+build_fragn(const uint8_t *ip, uint16_t len, uint16_t tag,
+            uint16_t offset, int payload_len,
+            struct packetbuf_attr *attrs, struct packetbuf_addr *addrs)
+{
+  packetbuf_clear();
+  rime_ptr = packetbuf_dataptr();
+  /* Packet type, reliability and the attributes set by the upper
+     layer apply to all fragments of the datagram. */
+  packetbuf_attr_copyfrom(attrs, addrs);
+/*     RIME_FRAG_BUF->dispatch_size = */
+/*       uip_htons((SICSLOWPAN_DISPATCH_FRAGN << 8) | uip_len); */
+  SET16(RIME_FRAG_PTR, RIME_FRAG_DISPATCH_SIZE,
+        ((SICSLOWPAN_DISPATCH_FRAGN << 8) | len));
+  SET16(RIME_FRAG_PTR, RIME_FRAG_TAG, tag);
+  RIME_FRAG_PTR[RIME_FRAG_OFFSET] = offset >> 3;
+  PRINTFO("(offset %d, len %d, tag %d)\n", offset >> 3, payload_len, tag);
+  memcpy(rime_ptr + SICSLOWPAN_FRAGN_HDR_LEN, ip + offset, payload_len);
+  packetbuf_set_datalen(payload_len + SICSLOWPAN_FRAGN_HDR_LEN);
+}
+/*--------------------------------------------------------------------*/
+#if SICSLOWPAN_FRAG_TX_CONTEXTS > 0
+/**
+ * \brief Abort a datagram whose last fragment has not been reported
+ * by the MAC layer, so that its context is not kept forever.
+ */
+static void
+frag_tx_timeout(void *ptr)
+{
+  struct sicslowpan_frag_tx *tx = ptr;
+
+  PRINTFO("fragment tx timed out, dropping subsequent fragments.\n");
+  frag_stats.aborted++;
+  tx->len = 0;
+}
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Hand the fragment in packetbuf to the MAC layer.
+ */
+static void
+frag_tx_send(struct sicslowpan_frag_tx *tx)
+{
+  if(++frag_tx_generation == 0) {
+    frag_tx_generation = 1;
+  }
+  tx->generation = frag_tx_generation;
+  /* Armed before sending, as the MAC layer may report the fragment
+     right away and schedule the next one. */
+  ctimer_set(&tx->timer, SICSLOWPAN_FRAG_TX_TIMEOUT, frag_tx_timeout, tx);
+  send_packet(&tx->dest, (void *)(uintptr_t)tx->generation, tx->is_control);
+}
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Send the next fragment of a datagram.
+ */
+static void
+frag_tx_next(void *ptr)
+{
+  struct sicslowpan_frag_tx *tx = ptr;
+  int payload_len;
+
+  payload_len = tx->payload_len;
+  if(tx->len - tx->processed_len < payload_len) {
+    /* last fragment */
+    payload_len = tx->len - tx->processed_len;
+  }
+  PRINTFO("sicslowpan output: fragment ");
+  build_fragn(tx->buf, tx->len, tx->tag, tx->processed_len, payload_len,
+              tx->attrs, tx->addrs);
+  tx->processed_len += payload_len;
+  frag_tx_send(tx);
+}
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Called when the MAC layer is done with a fragment: schedule
+ * the next fragment of the datagram, or release its context once all
+ * fragments have been delivered or one of them has failed.
+ * \param generation the generation of the fragment
+ * \param status the MAC layer status of the fragment
+ */
+static void
+frag_tx_sent(uint16_t generation, int status)
+{
+  struct sicslowpan_frag_tx *tx;
+  int i;
+
+  tx = NULL;
+  for(i = 0; i < SICSLOWPAN_FRAG_TX_CONTEXTS; i++) {
+    if(frag_tx_contexts[i].len != 0 &&
+       frag_tx_contexts[i].generation == generation) {
+      tx = &frag_tx_contexts[i];
+      break;
+    }
+  }
+  if(tx == NULL) {
+    /* The datagram has already timed out, and its context may have
+       been reused by another one. */
+    return;
+  }
+  if(status == MAC_TX_DEFERRED) {
+    /* The MAC layer reports the fragment again once it is sent. */
+    return;
+  }
+  if(status != MAC_TX_OK) {
+    PRINTFO("error %d in fragment tx, dropping subsequent fragments.\n",
+            status);
+    frag_stats.aborted++;
+    ctimer_stop(&tx->timer);
+    tx->len = 0;
+  } else if(tx->processed_len >= tx->len) {
+    frag_stats.sent++;
+    ctimer_stop(&tx->timer);
+    tx->len = 0;
+  } else {
+    ctimer_set(&tx->timer, SICSLOWPAN_FRAG_TX_INTERVAL, frag_tx_next, tx);
+  }
+}
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Find an unused context to send a fragmented datagram.
+ * \return The context, or NULL if all contexts are in use
+ */
+static struct sicslowpan_frag_tx *
+frag_tx_context(void)
+{
+  int i;
+
+  for(i = 0; i < SICSLOWPAN_FRAG_TX_CONTEXTS; i++) {
+    if(frag_tx_contexts[i].len == 0) {
+      return &frag_tx_contexts[i];
+    }
+  }
+  return NULL;
+}
+#endif /* SICSLOWPAN_FRAG_TX_CONTEXTS > 0 */
+#endif /* SICSLOWPAN_CONF_FRAG */
 /*--------------------------------------------------------------------*/
 /** \brief Take an IP packet and format it to be sent on an 802.15.4
  *  network using 6lowpan.
@@ -1433,6 +1680,7 @@ output(const uip_lladdr_t *localdest)
    * We calculate it here only to make a better decision of whether the outgoing packet
    * needs to be fragmented or not. */
 #define USE_FRAMER_HDRLEN 1
+  packetbuf_attr_copyto(out_attrs, out_addrs);
 #if USE_FRAMER_HDRLEN
   packetbuf_clear();
   packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, &dest);
@@ -1443,27 +1691,46 @@ output(const uip_lladdr_t *localdest)
   }
   packetbuf_clear();
 
-  /* We must set the max transmissions attribute again after clearing
-     the buffer. */
-  packetbuf_set_attr(PACKETBUF_ATTR_MAX_MAC_TRANSMISSIONS,
-                     SICSLOWPAN_MAX_MAC_TRANSMISSIONS);
+  /* We must set the attributes again after clearing the buffer. */
+  packetbuf_attr_copyfrom(out_attrs, out_addrs);
 #else /* USE_FRAMER_HDRLEN */
   framer_hdrlen = 21;
 #endif /* USE_FRAMER_HDRLEN */
 
   if((int)uip_len - (int)uncomp_hdr_len > (int)MAC_MAX_PAYLOAD - framer_hdrlen - (int)rime_hdr_len) {
 #if SICSLOWPAN_CONF_FRAG
-    struct queuebuf *q;
+    uint16_t frag_tag;
+#if SICSLOWPAN_FRAG_TX_CONTEXTS > 0
+    struct sicslowpan_frag_tx *tx;
+#endif /* SICSLOWPAN_FRAG_TX_CONTEXTS > 0 */
     /*
      * The outbound IPv6 packet is too large to fit into a single 15.4
      * packet, so we fragment it into multiple packets and send them.
      * The first fragment contains frag1 dispatch, then
      * IPv6/HC1/HC06/HC_UDP dispatchs/headers.
      * The following fragments contain only the fragn dispatch.
+     *
+     * Each fragment is built in packetbuf directly from uip_buf, which
+     * is not modified by the MAC layer, so no copy of the fragment
+     * needs to be kept around while it is sent.
+     *
+     * With SICSLOWPAN_FRAG_TX_CONTEXTS, only the first fragment is sent
+     * from here. The datagram is copied into a context and the
+     * following fragments are sent one at a time from the MAC sent
+     * callback.
      */
 
     PRINTFO("Fragmentation sending packet len %d\n", uip_len);
 
+#if SICSLOWPAN_FRAG_TX_CONTEXTS > 0
+    tx = frag_tx_context();
+    if(tx == NULL) {
+      PRINTFO("sicslowpan output: no free fragmentation context; dropping packet\n");
+      frag_stats.aborted++;
+      return 0;
+    }
+#endif /* SICSLOWPAN_FRAG_TX_CONTEXTS > 0 */
+
     /* Create 1st Fragment */
     PRINTFO("sicslowpan output: 1rst fragment ");
 
@@ -1479,25 +1746,34 @@ output(const uip_lladdr_t *localdest)
     SET16(RIME_FRAG_PTR, RIME_FRAG_DISPATCH_SIZE,
           ((SICSLOWPAN_DISPATCH_FRAG1 << 8) | uip_len));
 /*     RIME_FRAG_BUF->tag = uip_htons(my_tag); */
-    SET16(RIME_FRAG_PTR, RIME_FRAG_TAG, my_tag);
-    my_tag++;
+    frag_tag = my_tag++;
+    SET16(RIME_FRAG_PTR, RIME_FRAG_TAG, frag_tag);
 
     /* Copy payload and send */
     rime_hdr_len += SICSLOWPAN_FRAG1_HDR_LEN;
     rime_payload_len = (MAC_MAX_PAYLOAD - framer_hdrlen - rime_hdr_len) & 0xfffffff8;
-    PRINTFO("(len %d, tag %d)\n", rime_payload_len, my_tag);
+    PRINTFO("(len %d, tag %d)\n", rime_payload_len, frag_tag);
     memcpy(rime_ptr + rime_hdr_len,
            (uint8_t *)UIP_IP_BUF + uncomp_hdr_len, rime_payload_len);
     packetbuf_set_datalen(rime_payload_len + rime_hdr_len);
-    q = queuebuf_new_from_packetbuf();
-    if(q == NULL) {
-      PRINTFO("could not allocate queuebuf for first fragment, dropping packet\n");
-      return 0;
-    }
-    send_packet(&dest);
-    queuebuf_to_packetbuf(q);
-    queuebuf_free(q);
-    q = NULL;
+
+    /* set processed_ip_out_len to what we already sent from the IP payload*/
+    processed_ip_out_len = rime_payload_len + uncomp_hdr_len;
+
+    rime_hdr_len = SICSLOWPAN_FRAGN_HDR_LEN;
+#if SICSLOWPAN_FRAG_TX_CONTEXTS > 0
+    memcpy(tx->buf, UIP_IP_BUF, uip_len);
+    tx->len = uip_len;
+    tx->processed_len = processed_ip_out_len;
+    tx->tag = frag_tag;
+    tx->payload_len = (MAC_MAX_PAYLOAD - framer_hdrlen - rime_hdr_len) & 0xfffffff8;
+    rimeaddr_copy(&tx->dest, &dest);
+    tx->is_control = is_control_packet();
+    memcpy(tx->attrs, out_attrs, sizeof(tx->attrs));
+    memcpy(tx->addrs, out_addrs, sizeof(tx->addrs));
+    frag_tx_send(tx);
+#else /* SICSLOWPAN_FRAG_TX_CONTEXTS > 0 */
+    send_packet(&dest, NULL, is_control_packet());
 
     /* Check tx result. */
     if((last_tx_status == MAC_TX_COLLISION) ||
@@ -1507,43 +1783,22 @@ output(const uip_lladdr_t *localdest)
       return 0;
     }
 
-    /* set processed_ip_out_len to what we already sent from the IP payload*/
-    processed_ip_out_len = rime_payload_len + uncomp_hdr_len;
-    
     /*
      * Create following fragments
-     * Datagram tag is already in the buffer, we need to set the
-     * FRAGN dispatch and for each fragment, the offset
+     * For each fragment, we set the FRAGN dispatch, the datagram tag
+     * and the offset
      */
-    rime_hdr_len = SICSLOWPAN_FRAGN_HDR_LEN;
-/*     RIME_FRAG_BUF->dispatch_size = */
-/*       uip_htons((SICSLOWPAN_DISPATCH_FRAGN << 8) | uip_len); */
-    SET16(RIME_FRAG_PTR, RIME_FRAG_DISPATCH_SIZE,
-          ((SICSLOWPAN_DISPATCH_FRAGN << 8) | uip_len));
     rime_payload_len = (MAC_MAX_PAYLOAD - framer_hdrlen - rime_hdr_len) & 0xfffffff8;
     while(processed_ip_out_len < uip_len) {
       PRINTFO("sicslowpan output: fragment ");
-      RIME_FRAG_PTR[RIME_FRAG_OFFSET] = processed_ip_out_len >> 3;
-      
-      /* Copy payload and send */
       if(uip_len - processed_ip_out_len < rime_payload_len) {
         /* last fragment */
         rime_payload_len = uip_len - processed_ip_out_len;
       }
-      PRINTFO("(offset %d, len %d, tag %d)\n",
-             processed_ip_out_len >> 3, rime_payload_len, my_tag);
-      memcpy(rime_ptr + rime_hdr_len,
-             (uint8_t *)UIP_IP_BUF + processed_ip_out_len, rime_payload_len);
-      packetbuf_set_datalen(rime_payload_len + rime_hdr_len);
-      q = queuebuf_new_from_packetbuf();
-      if(q == NULL) {
-        PRINTFO("could not allocate queuebuf, dropping fragment\n");
-        return 0;
-      }
-      send_packet(&dest);
-      queuebuf_to_packetbuf(q);
-      queuebuf_free(q);
-      q = NULL;
+      build_fragn((uint8_t *)UIP_IP_BUF, uip_len, frag_tag,
+                  processed_ip_out_len, rime_payload_len,
+                  out_attrs, out_addrs);
+      send_packet(&dest, NULL, is_control_packet());
       processed_ip_out_len += rime_payload_len;
 
       /* Check tx result. */
@@ -1554,6 +1809,7 @@ output(const uip_lladdr_t *localdest)
         return 0;
       }
     }
+#endif /* SICSLOWPAN_FRAG_TX_CONTEXTS > 0 */
 #else /* SICSLOWPAN_CONF_FRAG */
     PRINTFO("sicslowpan output: Packet too large to be sent without fragmentation support; dropping packet\n");
     return 0;
@@ -1567,11 +1823,93 @@ output(const uip_lladdr_t *localdest)
     memcpy(rime_ptr + rime_hdr_len, (uint8_t *)UIP_IP_BUF + uncomp_hdr_len,
            uip_len - uncomp_hdr_len);
     packetbuf_set_datalen(uip_len - uncomp_hdr_len + rime_hdr_len);
-    send_packet(&dest);
+    send_packet(&dest, NULL, is_control_packet());
   }
   return 1;
 }
 
+#if SICSLOWPAN_CONF_FRAG
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Find the reassembly context of a fragment, or set up a new
+ * one.
+ * \param tag The datagram tag of the fragment
+ * \param size The datagram size of the fragment
+ * \return The reassembly context, or NULL if the datagram is too large
+ *
+ * When all contexts are in use, the oldest reassembly is discarded to
+ * make room for the new one, which lessens the negative impacts of too
+ * high SICSLOWPAN_REASS_MAXAGE.
+ */
+static struct sicslowpan_reass *
+reass_context(uint16_t tag, uint16_t size)
+{
+  struct sicslowpan_reass *r, *free;
+  const rimeaddr_t *sender = packetbuf_addr(PACKETBUF_ADDR_SENDER);
+  clock_time_t now = clock_time();
+
+  /* Look for the context of the datagram, and for an unused context
+     or else the oldest one. */
+  free = NULL;
+  for(r = reass_contexts; r < &reass_contexts[SICSLOWPAN_REASS_CONTEXTS]; r++) {
+    if(r->len == 0) {
+      if(free == NULL || free->len != 0) {
+        free = r;
+      }
+    } else if(r->len == size && r->tag == tag &&
+              rimeaddr_cmp(&r->sender, sender)) {
+      return r;
+    } else if(free == NULL ||
+              (free->len != 0 &&
+               now - r->timer.start > now - free->timer.start)) {
+      free = r;
+    }
+  }
+
+  if(size > UIP_BUFSIZE - UIP_LLH_LEN) {
+    PRINTFI("sicslowpan input: datagram too large (%d)\n", size);
+    return NULL;
+  }
+
+  if(free->len != 0) {
+    PRINTFI("sicslowpan input: discarding reassembly (tag %d)\n", free->tag);
+    frag_stats.dropped++;
+  }
+  free->len = size;
+  memset(free->received, 0, sizeof(free->received));
+  free->tag = tag;
+  rimeaddr_copy(&free->sender, sender);
+  timer_set(&free->timer, SICSLOWPAN_REASS_MAXAGE * CLOCK_SECOND / 16);
+  PRINTFI("sicslowpan input: INIT FRAGMENTATION (len %d, tag %d)\n",
+          size, tag);
+  return free;
+}
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Record the part of a datagram carried by a fragment.
+ * \param r The reassembly context of the datagram
+ * \param offset The offset of the fragment in the IP packet
+ * \param len The length of the fragment in the IP packet
+ * \return Non-zero if all parts of the datagram have been received
+ */
+static int
+reass_received(struct sicslowpan_reass *r, uint16_t offset, uint16_t len)
+{
+  uint16_t unit;
+
+  if(len > 0) {
+    for(unit = offset >> 3; unit <= (offset + len - 1) >> 3; unit++) {
+      r->received[unit >> 3] |= 1 << (unit & 7);
+    }
+  }
+  for(unit = 0; unit <= (r->len - 1) >> 3; unit++) {
+    if((r->received[unit >> 3] & (1 << (unit & 7))) == 0) {
+      return 0;
+    }
+  }
+  return 1;
+}
+#endif /* SICSLOWPAN_CONF_FRAG */
 /*--------------------------------------------------------------------*/
 /** \brief Process a received 6lowpan packet.
  *  \param r The MAC layer
@@ -1579,8 +1917,14 @@ output(const uip_lladdr_t *localdest)
  *  The 6lowpan packet is put in packetbuf by the MAC. If its a frag1 or
  *  a non-fragmented packet we first uncompress the IP header. The
  *  6lowpan payload and possibly the uncompressed IP header are then
- *  copied in siclowpan_buf. If the IP packet is complete it is copied
- *  to uip_buf and the IP layer is called.
+ *  copied in the reassembly buffer of the datagram, or directly in
+ *  uip_buf for a non-fragmented packet. If the IP packet is complete
+ *  it is copied to uip_buf and the IP layer is called.
+ *
+ *  Fragments may arrive in any order, as each fragment is copied to
+ *  its place in the datagram. The datagram is complete once every
+ *  8-byte unit of it has been received, so duplicate fragments are
+ *  harmless.
  *
  * \note We do not check for overlapping sicslowpan fragments
  * (it is a SHALL in the RFC 4944 and should never happen)
@@ -1596,7 +1940,7 @@ input(void)
 #if SICSLOWPAN_CONF_FRAG
   /* tag of the fragment */
   uint16_t frag_tag = 0;
-  uint8_t first_fragment = 0, last_fragment = 0;
+  struct sicslowpan_reass *r;
 #endif /*SICSLOWPAN_CONF_FRAG*/
 
   /* init */
@@ -1610,10 +1954,13 @@ input(void)
      want to query us for it later. */
   last_rssi = (signed short)packetbuf_attr(PACKETBUF_ATTR_RSSI);
 #if SICSLOWPAN_CONF_FRAG
-  /* if reassembly timed out, cancel it */
-  if(timer_expired(&reass_timer)) {
-    sicslowpan_len = 0;
-    processed_ip_in_len = 0;
+  /* if a reassembly timed out, cancel it */
+  for(r = reass_contexts; r < &reass_contexts[SICSLOWPAN_REASS_CONTEXTS]; r++) {
+    if(r->len != 0 && timer_expired(&r->timer)) {
+      PRINTFI("sicslowpan input: reassembly timed out (tag %d)\n", r->tag);
+      r->len = 0;
+      frag_stats.timedout++;
+    }
   }
   /*
    * Since we don't support the mesh and broadcast header, the first header
@@ -1630,8 +1977,6 @@ input(void)
       PRINTFI("size %d, tag %d, offset %d)\n",
              frag_size, frag_tag, frag_offset);
       rime_hdr_len += SICSLOWPAN_FRAG1_HDR_LEN;
-      /*      printf("frag1 %d %d\n", reass_tag, frag_tag);*/
-      first_fragment = 1;
       is_fragment = 1;
       break;
     case SICSLOWPAN_DISPATCH_FRAGN:
@@ -1646,77 +1991,23 @@ input(void)
       PRINTFI("size %d, tag %d, offset %d)\n",
              frag_size, frag_tag, frag_offset);
       rime_hdr_len += SICSLOWPAN_FRAGN_HDR_LEN;
-
-      /* If this is the last fragment, we may shave off any extrenous
-         bytes at the end. We must be liberal in what we accept. */
-      PRINTFI("last_fragment?: processed_ip_in_len %d rime_payload_len %d frag_size %d\n",
-              processed_ip_in_len, packetbuf_datalen() - rime_hdr_len, frag_size);
-
-      if(processed_ip_in_len + packetbuf_datalen() - rime_hdr_len >= frag_size) {
-        last_fragment = 1;
-      }
       is_fragment = 1;
       break;
     default:
       break;
   }
 
-  /* We are currently reassembling a packet, but have just received the first
-   * fragment of another packet. We can either ignore it and hope to receive
-   * the rest of the under-reassembly packet fragments, or we can discard the
-   * previous packet altogether, and start reassembling the new packet.
-   *
-   * We discard the previous packet, and start reassembling the new packet.
-   * This lessens the negative impacts of too high SICSLOWPAN_REASS_MAXAGE.
-   */
-#define PRIORITIZE_NEW_PACKETS 1
-#if PRIORITIZE_NEW_PACKETS
-
-  if(!is_fragment) {
-    /* Prioritize non-fragment packets too. */
-    sicslowpan_len = 0;
-    processed_ip_in_len = 0;
-  } else if(processed_ip_in_len > 0 && first_fragment
-      && !rimeaddr_cmp(&frag_sender, packetbuf_addr(PACKETBUF_ADDR_SENDER))) {
-    sicslowpan_len = 0;
-    processed_ip_in_len = 0;
-  }
-#endif /* PRIORITIZE_NEW_PACKETS */
-
-  if(processed_ip_in_len > 0) {
-    /* reassembly is ongoing */
-    /*    printf("frag %d %d\n", reass_tag, frag_tag);*/
-    if((frag_size > 0 &&
-        (frag_size != sicslowpan_len ||
-         reass_tag  != frag_tag ||
-         !rimeaddr_cmp(&frag_sender, packetbuf_addr(PACKETBUF_ADDR_SENDER))))  ||
-       frag_size == 0) {
-      /*
-       * the packet is a fragment that does not belong to the packet
-       * being reassembled or the packet is not a fragment.
-       */
-      PRINTFI("sicslowpan input: Dropping 6lowpan packet that is not a fragment of the packet currently being reassembled\n");
+  if(is_fragment) {
+    reass = reass_context(frag_tag, frag_size);
+    if(reass == NULL) {
+      frag_stats.dropped++;
       return;
     }
+    sicslowpan_buf = reass->buf.u8;
   } else {
-    /*
-     * reassembly is off
-     * start it if we received a fragment
-     */
-    if((frag_size > 0) && (frag_size <= UIP_BUFSIZE)) {
-      /* We are currently not reassembling a packet, but have received a packet fragment
-       * that is not the first one. */
-      if(is_fragment && !first_fragment) {
-        return;
-      }
-
-      sicslowpan_len = frag_size;
-      reass_tag = frag_tag;
-      timer_set(&reass_timer, SICSLOWPAN_REASS_MAXAGE * CLOCK_SECOND / 16);
-      PRINTFI("sicslowpan input: INIT FRAGMENTATION (len %d, tag %d)\n",
-             sicslowpan_len, reass_tag);
-      rimeaddr_copy(&frag_sender, packetbuf_addr(PACKETBUF_ADDR_SENDER));
-    }
+    /* A packet that is not fragmented is uncompressed directly into
+       uip_buf, without disturbing ongoing reassemblies. */
+    sicslowpan_buf = uip_buf;
   }
 
   if(rime_hdr_len == SICSLOWPAN_FRAGN_HDR_LEN) {
@@ -1774,81 +2065,82 @@ input(void)
   }
   rime_payload_len = packetbuf_datalen() - rime_hdr_len;
 
+#if SICSLOWPAN_CONF_FRAG
+  if(is_fragment) {
+    /* If this is the last fragment, we may shave off any extrenous
+       bytes at the end. We must be liberal in what we accept. */
+    if(uncomp_hdr_len + (uint16_t)(frag_offset << 3) + rime_payload_len >
+       reass->len) {
+      rime_payload_len = reass->len - uncomp_hdr_len -
+        (uint16_t)(frag_offset << 3);
+      if(rime_payload_len < 0) {
+        PRINTFI("sicslowpan input: fragment beyond end of datagram\n");
+        return;
+      }
+    }
+  }
+#endif /* SICSLOWPAN_CONF_FRAG */
+
   /* Sanity-check size of incoming packet to avoid buffer overflow */
   {
     int req_size = UIP_LLH_LEN + uncomp_hdr_len + (uint16_t)(frag_offset << 3)
         + rime_payload_len;
-    if(req_size > sizeof(sicslowpan_buf)) {
+    if(req_size > UIP_BUFSIZE) {
       PRINTF(
           "SICSLOWPAN: packet dropped, minimum required SICSLOWPAN_IP_BUF size: %d+%d+%d+%d=%d (current size: %d)\n",
           UIP_LLH_LEN, uncomp_hdr_len, (uint16_t)(frag_offset << 3),
-          rime_payload_len, req_size, sizeof(sicslowpan_buf));
+          rime_payload_len, req_size, UIP_BUFSIZE);
       return;
     }
   }
 
   memcpy((uint8_t *)SICSLOWPAN_IP_BUF + uncomp_hdr_len + (uint16_t)(frag_offset << 3), rime_ptr + rime_hdr_len, rime_payload_len);
-  
-  /* update processed_ip_in_len if fragment, sicslowpan_len otherwise */
 
 #if SICSLOWPAN_CONF_FRAG
-  if(frag_size > 0) {
-    /* Add the size of the header only for the first fragment. */
-    if(first_fragment != 0) {
-      processed_ip_in_len += uncomp_hdr_len;
-    }
-    /* For the last fragment, we are OK if there is extrenous bytes at
-       the end of the packet. */
-    if(last_fragment != 0) {
-      processed_ip_in_len = frag_size;
-    } else {
-      processed_ip_in_len += rime_payload_len;
+  if(is_fragment) {
+    /* The header size counts only for the first fragment, for which
+       it is non-zero. */
+    PRINTF("offset %d, rime_payload_len %d\n",
+           frag_offset << 3, rime_payload_len);
+    if(!reass_received(reass, (uint16_t)(frag_offset << 3),
+                       uncomp_hdr_len + rime_payload_len)) {
+      return;
     }
-    PRINTF("processed_ip_in_len %d, rime_payload_len %d\n", processed_ip_in_len, rime_payload_len);
 
-  } else {
+    /*
+     * We have a full IP packet in the reassembly buffer, deliver it
+     * to the IP stack
+     */
+    PRINTFI("sicslowpan input: IP packet ready (length %d)\n", reass->len);
+    memcpy((uint8_t *)UIP_IP_BUF, (uint8_t *)SICSLOWPAN_IP_BUF, reass->len);
+    uip_len = reass->len;
+    reass->len = 0;
+    frag_stats.completed++;
+  } else
 #endif /* SICSLOWPAN_CONF_FRAG */
-    sicslowpan_len = rime_payload_len + uncomp_hdr_len;
-#if SICSLOWPAN_CONF_FRAG
+  {
+    uip_len = rime_payload_len + uncomp_hdr_len;
   }
 
-  /*
-   * If we have a full IP packet in sicslowpan_buf, deliver it to
-   * the IP stack
-   */
-  PRINTF("sicslowpan_init processed_ip_in_len %d, sicslowpan_len %d\n",
-         processed_ip_in_len, sicslowpan_len);
-  if(processed_ip_in_len == 0 || (processed_ip_in_len == sicslowpan_len)) {
-    PRINTFI("sicslowpan input: IP packet ready (length %d)\n",
-           sicslowpan_len);
-    memcpy((uint8_t *)UIP_IP_BUF, (uint8_t *)SICSLOWPAN_IP_BUF, sicslowpan_len);
-    uip_len = sicslowpan_len;
-    sicslowpan_len = 0;
-    processed_ip_in_len = 0;
-#endif /* SICSLOWPAN_CONF_FRAG */
-
 #if DEBUG
-    {
-      uint16_t ndx;
-      PRINTF("after decompression %u:", SICSLOWPAN_IP_BUF->len[1]);
-      for (ndx = 0; ndx < SICSLOWPAN_IP_BUF->len[1] + 40; ndx++) {
-        uint8_t data = ((uint8_t *) (SICSLOWPAN_IP_BUF))[ndx];
-        PRINTF("%02x", data);
-      }
-      PRINTF("\n");
+  {
+    uint16_t ndx;
+    PRINTF("after decompression %u:", UIP_IP_BUF->len[1]);
+    for (ndx = 0; ndx < UIP_IP_BUF->len[1] + 40; ndx++) {
+      uint8_t data = ((uint8_t *) (UIP_IP_BUF))[ndx];
+      PRINTF("%02x", data);
     }
+    PRINTF("\n");
+  }
 #endif
 
-    /* if callback is set then set attributes and call */
-    if(callback) {
-      set_packet_attrs();
-      callback->input_callback();
-    }
-
-    tcpip_input();
-#if SICSLOWPAN_CONF_FRAG
+  /* if callback is set then set attributes and call */
+  if(callback) {
+    set_packet_attrs();
+    callback->input_callback();
   }
-#endif /* SICSLOWPAN_CONF_FRAG */
+
+  tcpip_input();
 }
 /** @} */
 
@@ -1915,6 +2207,14 @@ sicslowpan_get_last_rssi(void)
 {
   return last_rssi;
 }
+#if SICSLOWPAN_CONF_FRAG
+/*--------------------------------------------------------------------*/
+void
+sicslowpan_get_frag_stats(struct sicslowpan_frag_stats *stats)
+{
+  memcpy(stats, &frag_stats, sizeof(frag_stats));
+}
+#endif /* SICSLOWPAN_CONF_FRAG */
 /*--------------------------------------------------------------------*/
 const struct network_driver sicslowpan_driver = {
   "sicslowpan",
@@ -317,8 +317,29 @@ struct sicslowpan_nh_compressor {
 
 };
 
+/**
+ * \brief Counters for the reassembly of fragmented datagrams
+ */
+struct sicslowpan_frag_stats {
+  /** Datagrams that were reassembled and passed to the IP stack. */
+  unsigned long completed;
+  /** Datagrams discarded because the reassembly timed out. */
+  unsigned long timedout;
+  /** Fragments or partial datagrams dropped because they were too
+      large, or because all reassembly contexts were in use. */
+  unsigned long dropped;
+  /** Fragmented datagrams whose fragments were all delivered by the
+      MAC layer (only counted when SICSLOWPAN_FRAG_TX_CONTEXTS > 0). */
+  unsigned long sent;
+  /** Fragmented datagrams that were not sent, or aborted after a
+      fragment could not be delivered. */
+  unsigned long aborted;
+};
+
 int sicslowpan_get_last_rssi(void);
 
+void sicslowpan_get_frag_stats(struct sicslowpan_frag_stats *stats);
+
 extern const struct network_driver sicslowpan_driver;
 
 #endif /* SICSLOWPAN_H_ */
@@ -567,6 +567,16 @@ tcpip_ipv6_output(void)
        nexthop address. */
     if(uip_ds6_is_addr_onlink(&UIP_IP_BUF->destipaddr)){
       nexthop = &UIP_IP_BUF->destipaddr;
+#if UIP_CONF_IPV6_RPL && RPL_WITH_NON_STORING
+    } else if((nexthop = rpl_update_header_srh()) != NULL) {
+      /* The packet is source routed. The nexthop is the neighbor in
+         the destination field of the IPv6 header. */
+      if(uip_len > UIP_LINK_MTU) {
+        UIP_LOG("tcpip_ipv6_output: Packet to big with routing header");
+        uip_len = 0;
+        return;
+      }
+#endif /* UIP_CONF_IPV6_RPL && RPL_WITH_NON_STORING */
     } else {
       uip_ds6_route_t *route;
       /* Check if we have a route to the destination address. */
@@ -795,6 +805,8 @@ tcpip_uipcall(void)
 PROCESS_THREAD(tcpip_process, ev, data)
 {
   PROCESS_BEGIN();
+
+  process_set_priority(&tcpip_process, PROCESS_PRIORITY_HIGH);
   
 #if UIP_TCP
  {
@@ -65,6 +65,13 @@ LIST(notificationlist);
 
 static int num_routes = 0;
 
+#if UIP_DS6_ROUTE_HASH
+/* Host routes hashed on their address, and the list of all other
+   routes. Both are chained through the index_next field. */
+static uip_ds6_route_t *route_hash[UIP_DS6_ROUTE_HASH_SIZE];
+static uip_ds6_route_t *prefix_routes;
+#endif /* UIP_DS6_ROUTE_HASH */
+
 #undef DEBUG
 #define DEBUG DEBUG_NONE
 #include "net/uip-debug.h"
@@ -99,6 +106,50 @@ assert_nbr_routes_list_sane(void)
 }
 #endif /* DEBUG != DEBUG_NONE */
 /*---------------------------------------------------------------------------*/
+#if UIP_DS6_ROUTE_HASH
+static uip_ds6_route_t **
+index_chain(uip_ipaddr_t *ipaddr, uint8_t length)
+{
+  uint16_t h;
+  int i;
+
+  if(length != 128) {
+    return &prefix_routes;
+  }
+
+  /* Host routes mostly differ in the interface identifier. */
+  h = 0;
+  for(i = 8; i < 16; i++) {
+    h = (h << 3) ^ (h >> 13) ^ ipaddr->u8[i];
+  }
+  return &route_hash[h % UIP_DS6_ROUTE_HASH_SIZE];
+}
+/*---------------------------------------------------------------------------*/
+static void
+index_add(uip_ds6_route_t *r)
+{
+  uip_ds6_route_t **chain;
+
+  chain = index_chain(&r->ipaddr, r->length);
+  r->index_next = *chain;
+  *chain = r;
+}
+/*---------------------------------------------------------------------------*/
+static void
+index_rm(uip_ds6_route_t *r)
+{
+  uip_ds6_route_t **p;
+
+  for(p = index_chain(&r->ipaddr, r->length); *p != NULL;
+      p = &(*p)->index_next) {
+    if(*p == r) {
+      *p = r->index_next;
+      return;
+    }
+  }
+}
+#endif /* UIP_DS6_ROUTE_HASH */
+/*---------------------------------------------------------------------------*/
 #if UIP_DS6_NOTIFICATIONS
 static void
 call_route_callback(int event, uip_ipaddr_t *route,
@@ -146,6 +197,11 @@ uip_ds6_route_init(void)
   memb_init(&defaultroutermemb);
   list_init(defaultrouterlist);
 
+#if UIP_DS6_ROUTE_HASH
+  memset(route_hash, 0, sizeof(route_hash));
+  prefix_routes = NULL;
+#endif /* UIP_DS6_ROUTE_HASH */
+
 #if UIP_DS6_NOTIFICATIONS
   list_init(notificationlist);
 #endif
@@ -227,9 +283,24 @@ uip_ds6_route_lookup(uip_ipaddr_t *addr)
 
   found_route = NULL;
   longestmatch = 0;
+#if UIP_DS6_ROUTE_HASH
+  /* A host route is always the longest match, so the prefix routes
+     only need to be searched when there is none. */
+  for(r = *index_chain(addr, 128);
+      r != NULL && found_route == NULL;
+      r = r->index_next) {
+    if(uip_ipaddr_cmp(addr, &r->ipaddr)) {
+      found_route = r;
+    }
+  }
+  for(r = found_route != NULL ? NULL : prefix_routes;
+      r != NULL;
+      r = r->index_next) {
+#else /* UIP_DS6_ROUTE_HASH */
   for(r = uip_ds6_route_head();
       r != NULL;
       r = uip_ds6_route_next(r)) {
+#endif /* UIP_DS6_ROUTE_HASH */
     if(r->length >= longestmatch &&
        uip_ipaddr_prefixcmp(addr, &r->ipaddr, r->length)) {
       longestmatch = r->length;
@@ -277,6 +348,11 @@ uip_ds6_route_add(uip_ipaddr_t *ipaddr, uint8_t length,
     PRINTF("uip_ds6_route_add: old route already found, updating this one instead: ");
     PRINT6ADDR(ipaddr);
     PRINTF("\n");
+#if UIP_DS6_ROUTE_HASH
+    /* The address and length may change, so the route is indexed
+       again below. */
+    index_rm(r);
+#endif /* UIP_DS6_ROUTE_HASH */
   } else {
     struct uip_ds6_route_neighbor_routes *routes;
     /* If there is no routing entry, create one */
@@ -330,6 +406,9 @@ uip_ds6_route_add(uip_ipaddr_t *ipaddr, uint8_t length,
 
   uip_ipaddr_copy(&(r->ipaddr), ipaddr);
   r->length = length;
+#if UIP_DS6_ROUTE_HASH
+  index_add(r);
+#endif /* UIP_DS6_ROUTE_HASH */
 
 #ifdef UIP_DS6_ROUTE_STATE_TYPE
   memset(&r->state, 0, sizeof(UIP_DS6_ROUTE_STATE_TYPE));
@@ -366,6 +445,9 @@ uip_ds6_route_rm(uip_ds6_route_t *route)
     PRINTF("\n");
 
     list_remove(route->routes->route_list, route);
+#if UIP_DS6_ROUTE_HASH
+    index_rm(route);
+#endif /* UIP_DS6_ROUTE_HASH */
     if(list_head(route->routes->route_list) == NULL) {
       /* If this was the only route using this neighbor, remove the
          neibhor from the table */
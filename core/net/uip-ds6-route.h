@@ -80,6 +80,22 @@ void uip_ds6_notification_rm(struct uip_ds6_notification *n);
 #define UIP_DS6_ROUTE_NB UIP_CONF_MAX_ROUTES
 #endif /* UIP_CONF_MAX_ROUTES */
 
+/* Index the routing table to speed up uip_ds6_route_lookup(). Host
+   (/128) routes are kept in a hash table with UIP_DS6_ROUTE_HASH_SIZE
+   buckets, and shorter prefixes on a separate list. A lookup then
+   costs one hash bucket plus the prefix routes instead of all routes. */
+#ifdef UIP_CONF_DS6_ROUTE_HASH
+#define UIP_DS6_ROUTE_HASH UIP_CONF_DS6_ROUTE_HASH
+#else /* UIP_CONF_DS6_ROUTE_HASH */
+#define UIP_DS6_ROUTE_HASH 0
+#endif /* UIP_CONF_DS6_ROUTE_HASH */
+
+#ifdef UIP_CONF_DS6_ROUTE_HASH_SIZE
+#define UIP_DS6_ROUTE_HASH_SIZE UIP_CONF_DS6_ROUTE_HASH_SIZE
+#else /* UIP_CONF_DS6_ROUTE_HASH_SIZE */
+#define UIP_DS6_ROUTE_HASH_SIZE UIP_DS6_ROUTE_NB
+#endif /* UIP_CONF_DS6_ROUTE_HASH_SIZE */
+
 /** \brief define some additional RPL related route state and
  *  neighbor callback for RPL - if not a DS6_ROUTE_STATE is already set */
 #ifndef UIP_DS6_ROUTE_STATE_TYPE
@@ -108,6 +124,10 @@ typedef struct uip_ds6_route {
      belong to the neighbor table entry that this routing table entry
      uses. */
   struct uip_ds6_route_neighbor_routes *routes;
+#if UIP_DS6_ROUTE_HASH
+  /* Next route in the same hash bucket, or on the prefix list. */
+  struct uip_ds6_route *index_next;
+#endif /* UIP_DS6_ROUTE_HASH */
   uip_ipaddr_t ipaddr;
 #ifdef UIP_DS6_ROUTE_STATE_TYPE
   UIP_DS6_ROUTE_STATE_TYPE state;
@@ -468,6 +468,54 @@
 #define SICSLOWPAN_REASS_MAXAGE 20
 #endif
 
+/**
+ * Number of datagrams that can be reassembled at the same time at the
+ * 6lowpan layer. Each context holds a buffer of UIP_BUFSIZE bytes.
+ */
+#ifdef SICSLOWPAN_CONF_REASS_CONTEXTS
+#define SICSLOWPAN_REASS_CONTEXTS (SICSLOWPAN_CONF_REASS_CONTEXTS)
+#else
+#define SICSLOWPAN_REASS_CONTEXTS 1
+#endif
+
+/**
+ * Number of fragmented datagrams that can be sent at the same time at
+ * the 6lowpan layer. When zero, the fragments of a datagram are all
+ * handed to the MAC layer at once and the result of each transmission
+ * is checked right after it returns, which is only meaningful with a
+ * synchronous MAC. Otherwise, the datagram is copied into one of these
+ * contexts and each fragment is sent when the MAC reports the previous
+ * one as delivered, so that a datagram is aborted on the first failed
+ * fragment. Each context holds a buffer of UIP_BUFSIZE bytes.
+ */
+#ifdef SICSLOWPAN_CONF_FRAG_TX_CONTEXTS
+#define SICSLOWPAN_FRAG_TX_CONTEXTS (SICSLOWPAN_CONF_FRAG_TX_CONTEXTS)
+#else
+#define SICSLOWPAN_FRAG_TX_CONTEXTS 0
+#endif
+
+/**
+ * Delay (in clock ticks) between the delivery of a fragment and the
+ * transmission of the next fragment of the same datagram, when
+ * SICSLOWPAN_FRAG_TX_CONTEXTS is non-zero.
+ */
+#ifdef SICSLOWPAN_CONF_FRAG_TX_INTERVAL
+#define SICSLOWPAN_FRAG_TX_INTERVAL (SICSLOWPAN_CONF_FRAG_TX_INTERVAL)
+#else
+#define SICSLOWPAN_FRAG_TX_INTERVAL 0
+#endif
+
+/**
+ * Time (in clock ticks) to wait for the MAC layer to report a fragment
+ * before the datagram is aborted and its context released, when
+ * SICSLOWPAN_FRAG_TX_CONTEXTS is non-zero.
+ */
+#ifdef SICSLOWPAN_CONF_FRAG_TX_TIMEOUT
+#define SICSLOWPAN_FRAG_TX_TIMEOUT (SICSLOWPAN_CONF_FRAG_TX_TIMEOUT)
+#else
+#define SICSLOWPAN_FRAG_TX_TIMEOUT (10 * CLOCK_SECOND)
+#endif
+
 /**
  * Do we compress the IP header or not (default: no)
  */
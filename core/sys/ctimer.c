@@ -46,6 +46,11 @@
 #include "contiki.h"
 #include "lib/list.h"
 
+#include <stddef.h>
+
+/* The callback timers that are set before the ctimer process has
+   started. Once it has started, every callback timer is only tracked
+   by its own event timer. */
 LIST(ctimer_list);
 
 static char initialized;
@@ -65,23 +70,24 @@ PROCESS_THREAD(ctimer_process, ev, data)
   struct ctimer *c;
   PROCESS_BEGIN();
 
-  for(c = list_head(ctimer_list); c != NULL; c = c->next) {
+  while((c = list_pop(ctimer_list)) != NULL) {
     etimer_set(&c->etimer, c->etimer.timer.interval);
   }
   initialized = 1;
 
   while(1) {
     PROCESS_YIELD_UNTIL(ev == PROCESS_EVENT_TIMER);
-    for(c = list_head(ctimer_list); c != NULL; c = c->next) {
-      if(&c->etimer == data) {
-	list_remove(ctimer_list, c);
-	PROCESS_CONTEXT_BEGIN(c->p);
-	if(c->f != NULL) {
-	  c->f(c->ptr);
-	}
-	PROCESS_CONTEXT_END(c->p);
-	break;
+    /* The event timers of this process all belong to callback
+       timers. The timer may have been stopped or set again after the
+       event was posted, in which case it must not fire. */
+    c = (struct ctimer *)((char *)data - offsetof(struct ctimer, etimer));
+    if(c->active && etimer_expired(&c->etimer)) {
+      c->active = 0;
+      PROCESS_CONTEXT_BEGIN(c->p);
+      if(c->f != NULL) {
+	c->f(c->ptr);
       }
+      PROCESS_CONTEXT_END(c->p);
     }
   }
   PROCESS_END();
@@ -92,6 +98,7 @@ ctimer_init(void)
 {
   initialized = 0;
   list_init(ctimer_list);
+  process_set_priority(&ctimer_process, PROCESS_PRIORITY_HIGH);
   process_start(&ctimer_process, NULL);
 }
 /*---------------------------------------------------------------------------*/
@@ -103,69 +110,66 @@ ctimer_set(struct ctimer *c, clock_time_t t,
   c->p = PROCESS_CURRENT();
   c->f = f;
   c->ptr = ptr;
+  c->active = 1;
   if(initialized) {
     PROCESS_CONTEXT_BEGIN(&ctimer_process);
     etimer_set(&c->etimer, t);
     PROCESS_CONTEXT_END(&ctimer_process);
   } else {
     c->etimer.timer.interval = t;
+    list_remove(ctimer_list, c);
+    list_add(ctimer_list, c);
   }
-
-  list_remove(ctimer_list, c);
-  list_add(ctimer_list, c);
 }
 /*---------------------------------------------------------------------------*/
 void
 ctimer_reset(struct ctimer *c)
 {
+  c->active = 1;
   if(initialized) {
     PROCESS_CONTEXT_BEGIN(&ctimer_process);
     etimer_reset(&c->etimer);
     PROCESS_CONTEXT_END(&ctimer_process);
+  } else {
+    list_remove(ctimer_list, c);
+    list_add(ctimer_list, c);
   }
-
-  list_remove(ctimer_list, c);
-  list_add(ctimer_list, c);
 }
 /*---------------------------------------------------------------------------*/
 void
 ctimer_restart(struct ctimer *c)
 {
+  c->active = 1;
   if(initialized) {
     PROCESS_CONTEXT_BEGIN(&ctimer_process);
     etimer_restart(&c->etimer);
     PROCESS_CONTEXT_END(&ctimer_process);
+  } else {
+    list_remove(ctimer_list, c);
+    list_add(ctimer_list, c);
   }
-
-  list_remove(ctimer_list, c);
-  list_add(ctimer_list, c);
 }
 /*---------------------------------------------------------------------------*/
 void
 ctimer_stop(struct ctimer *c)
 {
+  c->active = 0;
   if(initialized) {
     etimer_stop(&c->etimer);
   } else {
     c->etimer.next = NULL;
     c->etimer.p = PROCESS_NONE;
+    list_remove(ctimer_list, c);
   }
-  list_remove(ctimer_list, c);
 }
 /*---------------------------------------------------------------------------*/
 int
 ctimer_expired(struct ctimer *c)
 {
-  struct ctimer *t;
   if(initialized) {
     return etimer_expired(&c->etimer);
   }
-  for(t = list_head(ctimer_list); t != NULL; t = t->next) {
-    if(t == c) {
-      return 0;
-    }
-  }
-  return 1;
+  return !c->active;
 }
 /*---------------------------------------------------------------------------*/
 /** @} */
@@ -54,9 +54,140 @@ static clock_time_t next_expiration;
 
 PROCESS(etimer_process, "Event timer");
 /*---------------------------------------------------------------------------*/
+#if ETIMER_HEAP
+/*
+ * With ETIMER_HEAP, timerlist is the root of a pairing heap. Each
+ * timer points to its first child and, through next, to its next
+ * sibling. The root is the timer that expires first.
+ */
+static clock_time_t now;
+/*---------------------------------------------------------------------------*/
+static clock_time_t
+remaining(struct etimer *t)
+{
+  clock_time_t elapsed;
+
+  /* Expired timers all compare equal, so that timers that are set in
+     the past do not wrap around to the end of the heap. */
+  elapsed = now - t->timer.start;
+  return elapsed >= t->timer.interval ? 0 : t->timer.interval - elapsed;
+}
+/*---------------------------------------------------------------------------*/
+static struct etimer *
+meld(struct etimer *a, struct etimer *b)
+{
+  struct etimer *t;
+
+  if(a == NULL) {
+    return b;
+  }
+  if(b == NULL) {
+    return a;
+  }
+  if(remaining(b) < remaining(a)) {
+    t = a;
+    a = b;
+    b = t;
+  }
+  /* b becomes the first child of a. */
+  b->prev = a;
+  b->next = a->child;
+  if(a->child != NULL) {
+    a->child->prev = b;
+  }
+  a->child = b;
+  a->next = NULL;
+  a->prev = NULL;
+  return a;
+}
+/*---------------------------------------------------------------------------*/
+static struct etimer *
+merge_pairs(struct etimer *first)
+{
+  struct etimer *a, *b, *pairs, *root;
+
+  /* Meld the siblings two by two from left to right, and chain the
+     results in reverse order... */
+  pairs = NULL;
+  while(first != NULL) {
+    a = first;
+    b = a->next;
+    first = b != NULL ? b->next : NULL;
+    a->next = NULL;
+    if(b != NULL) {
+      b->next = NULL;
+      a = meld(a, b);
+    }
+    a->next = pairs;
+    pairs = a;
+  }
+
+  /* ...then meld them from right to left. */
+  root = NULL;
+  while(pairs != NULL) {
+    a = pairs;
+    pairs = a->next;
+    a->next = NULL;
+    root = meld(root, a);
+  }
+  if(root != NULL) {
+    root->prev = NULL;
+  }
+  return root;
+}
+/*---------------------------------------------------------------------------*/
+static int
+heap_contains(struct etimer *t)
+{
+  /* Every timer in the heap but the root has a parent or a previous
+     sibling, and the links of a timer are cleared when it leaves the
+     heap, so stale timers never look like they are still in it. */
+  return t == timerlist || (t->p != PROCESS_NONE && t->prev != NULL);
+}
+/*---------------------------------------------------------------------------*/
+static void
+heap_insert(struct etimer *t)
+{
+  t->child = NULL;
+  t->next = NULL;
+  t->prev = NULL;
+  timerlist = meld(timerlist, t);
+}
+/*---------------------------------------------------------------------------*/
+static void
+heap_remove(struct etimer *t)
+{
+  if(t == timerlist) {
+    timerlist = merge_pairs(t->child);
+  } else {
+    /* Cut the subtree of t from the heap, then meld its children back
+       into the heap. */
+    if(t->prev->child == t) {
+      t->prev->child = t->next;
+    } else {
+      t->prev->next = t->next;
+    }
+    if(t->next != NULL) {
+      t->next->prev = t->prev;
+    }
+    timerlist = meld(timerlist, merge_pairs(t->child));
+  }
+  t->child = NULL;
+  t->next = NULL;
+  t->prev = NULL;
+}
+#endif /* ETIMER_HEAP */
+/*---------------------------------------------------------------------------*/
 static void
 update_time(void)
 {
+#if ETIMER_HEAP
+  if(timerlist == NULL) {
+    next_expiration = 0;
+  } else {
+    next_expiration = timerlist->timer.start + timerlist->timer.interval;
+  }
+#else /* ETIMER_HEAP */
   clock_time_t tdist;
   clock_time_t now;
   struct etimer *t;
@@ -75,6 +206,7 @@ update_time(void)
     }
     next_expiration = now + tdist;
   }
+#endif /* ETIMER_HEAP */
 }
 /*---------------------------------------------------------------------------*/
 PROCESS_THREAD(etimer_process, ev, data)
@@ -91,6 +223,27 @@ PROCESS_THREAD(etimer_process, ev, data)
     if(ev == PROCESS_EVENT_EXITED) {
       struct process *p = data;
 
+#if ETIMER_HEAP
+      /* Empty the heap, then put back the timers of other processes. */
+      now = clock_time();
+      u = NULL;
+      while(timerlist != NULL) {
+	t = timerlist;
+	timerlist = merge_pairs(t->child);
+	t->next = u;
+	u = t;
+      }
+      while(u != NULL) {
+	t = u;
+	u = u->next;
+	if(t->p != p) {
+	  heap_insert(t);
+	} else {
+	  t->next = t->child = t->prev = NULL;
+	}
+      }
+      update_time();
+#else /* ETIMER_HEAP */
       while(timerlist != NULL && timerlist->p == p) {
 	timerlist = timerlist->next;
       }
@@ -104,11 +257,26 @@ PROCESS_THREAD(etimer_process, ev, data)
 	    t = t->next;
 	}
       }
+#endif /* ETIMER_HEAP */
       continue;
     } else if(ev != PROCESS_EVENT_POLL) {
       continue;
     }
 
+#if ETIMER_HEAP
+    now = clock_time();
+    while(timerlist != NULL && remaining(timerlist) == 0) {
+      t = timerlist;
+      if(process_post(t->p, PROCESS_EVENT_TIMER, t) == PROCESS_ERR_OK) {
+	heap_remove(t);
+	t->p = PROCESS_NONE;
+      } else {
+	etimer_request_poll();
+	break;
+      }
+    }
+    update_time();
+#else /* ETIMER_HEAP */
   again:
     
     u = NULL;
@@ -135,7 +303,7 @@ PROCESS_THREAD(etimer_process, ev, data)
       }
       u = t;
     }
-    
+#endif /* ETIMER_HEAP */
   }
   
   PROCESS_END();
@@ -150,6 +318,18 @@ etimer_request_poll(void)
 static void
 add_timer(struct etimer *timer)
 {
+#if ETIMER_HEAP
+  etimer_request_poll();
+
+  /* The expiration time has changed, so the timer has to be put back
+     in its place in the heap. */
+  now = clock_time();
+  if(heap_contains(timer)) {
+    heap_remove(timer);
+  }
+  timer->p = PROCESS_CURRENT();
+  heap_insert(timer);
+#else /* ETIMER_HEAP */
   struct etimer *t;
 
   etimer_request_poll();
@@ -169,6 +349,7 @@ add_timer(struct etimer *timer)
   timer->p = PROCESS_CURRENT();
   timer->next = timerlist;
   timerlist = timer;
+#endif /* ETIMER_HEAP */
 
   update_time();
 }
@@ -197,7 +378,18 @@ etimer_restart(struct etimer *et)
 void
 etimer_adjust(struct etimer *et, int timediff)
 {
+#if ETIMER_HEAP
+  now = clock_time();
+  if(heap_contains(et)) {
+    heap_remove(et);
+    et->timer.start += timediff;
+    heap_insert(et);
+  } else {
+    et->timer.start += timediff;
+  }
+#else /* ETIMER_HEAP */
   et->timer.start += timediff;
+#endif /* ETIMER_HEAP */
   update_time();
 }
 /*---------------------------------------------------------------------------*/
@@ -234,6 +426,13 @@ etimer_next_expiration_time(void)
 void
 etimer_stop(struct etimer *et)
 {
+#if ETIMER_HEAP
+  now = clock_time();
+  if(heap_contains(et)) {
+    heap_remove(et);
+    update_time();
+  }
+#else /* ETIMER_HEAP */
   struct etimer *t;
 
   /* First check if et is the first event timer on the list. */
@@ -257,6 +456,7 @@ etimer_stop(struct etimer *et)
 
   /* Remove the next pointer from the item to be removed. */
   et->next = NULL;
+#endif /* ETIMER_HEAP */
   /* Set the timer as expired */
   et->p = PROCESS_NONE;
 }
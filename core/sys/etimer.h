@@ -65,6 +65,18 @@
 #include "sys/timer.h"
 #include "sys/process.h"
 
+/**
+ * Keep the pending event timers in a min-heap ordered by expiration
+ * time instead of an unordered list. Setting, stopping and finding the
+ * next timer to expire then no longer walk every pending timer, at the
+ * cost of two more pointers per timer.
+ */
+#ifdef ETIMER_CONF_HEAP
+#define ETIMER_HEAP ETIMER_CONF_HEAP
+#else /* ETIMER_CONF_HEAP */
+#define ETIMER_HEAP 0
+#endif /* ETIMER_CONF_HEAP */
+
 /**
  * A timer.
  *
@@ -77,6 +89,12 @@ struct etimer {
   struct timer timer;
   struct etimer *next;
   struct process *p;
+#if ETIMER_HEAP
+  /* The first child of the timer in the heap, and its previous
+     sibling, or its parent if it is the first child. */
+  struct etimer *child;
+  struct etimer *prev;
+#endif /* ETIMER_HEAP */
 };
 
 /**
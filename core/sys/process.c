@@ -44,9 +44,23 @@
  */
 
 #include <stdio.h>
+#include <string.h>
 
 #include "sys/process.h"
 #include "sys/arg.h"
+#if PROCESS_CONF_STATS || PROCESS_PROFILE
+#include "sys/rtimer.h"
+#endif /* PROCESS_CONF_STATS || PROCESS_PROFILE */
+
+#if PROCESS_PROFILE
+#ifdef PROCESS_CONF_PROFILE_NOW
+typedef unsigned long profile_time_t;
+#define PROFILE_NOW() PROCESS_CONF_PROFILE_NOW()
+#else /* PROCESS_CONF_PROFILE_NOW */
+typedef rtimer_clock_t profile_time_t;
+#define PROFILE_NOW() RTIMER_NOW()
+#endif /* PROCESS_CONF_PROFILE_NOW */
+#endif /* PROCESS_PROFILE */
 
 /*
  * Pointer to the currently running process structure.
@@ -63,17 +77,70 @@ struct event_data {
   process_event_t ev;
   process_data_t data;
   struct process *p;
+#if PROCESS_PRIORITIES
+  process_num_events_t next;
+#endif /* PROCESS_PRIORITIES */
+#if PROCESS_CONF_STATS
+  rtimer_clock_t posted;
+#endif /* PROCESS_CONF_STATS */
+#if PROCESS_PROFILE
+  profile_time_t profile_posted;
+#endif /* PROCESS_PROFILE */
 };
 
 static process_num_events_t nevents, fevent;
 static struct event_data events[PROCESS_CONF_NUMEVENTS];
 
+#if PROCESS_PRIORITIES
+/*
+ * With PROCESS_PRIORITIES, the events are not kept in a ring but in
+ * one FIFO per priority class, linked through the next field of the
+ * events. The unused events are kept in a free list.
+ */
+#define NO_EVENT PROCESS_CONF_NUMEVENTS
+#define NPRIORITIES 2
+static process_num_events_t head[NPRIORITIES], tail[NPRIORITIES];
+static process_num_events_t free_events;
+#else /* PROCESS_PRIORITIES */
+#define NPRIORITIES 1
+#endif /* PROCESS_PRIORITIES */
+
 #if PROCESS_CONF_STATS
 process_num_events_t process_maxevents;
+static struct process_stats stats[NPRIORITIES];
 #endif
 
 static volatile unsigned char poll_requested;
 
+#if PROCESS_PROFILE
+/* The latencies of the events, the first entry being for the events
+   outside of the profiled range. */
+static struct process_event_profile event_profiles[PROCESS_PROFILE_EVENTS + 1];
+/* The time spent in the processes called by the current process. */
+static unsigned long profile_nested;
+#endif /* PROCESS_PROFILE */
+
+#if PROCESS_POLL_LIST
+/*
+ * The processes that have been polled. Poll requests, which may come
+ * from interrupts, are added to the active list while do_poll() works
+ * on the other one, so that a process can be polled again while its
+ * poll handler runs.
+ */
+static struct process *volatile poll_lists[2];
+static volatile unsigned char poll_active;
+
+/* Interrupts are disabled while a poll list is changed, as a poll
+   request from an interrupt could otherwise be lost. */
+#ifdef PROCESS_CONF_POLL_LIST_LOCK
+#define POLL_LIST_LOCK()      PROCESS_CONF_POLL_LIST_LOCK()
+#define POLL_LIST_UNLOCK(s)   PROCESS_CONF_POLL_LIST_UNLOCK(s)
+#else /* PROCESS_CONF_POLL_LIST_LOCK */
+#define POLL_LIST_LOCK()      0
+#define POLL_LIST_UNLOCK(s)   (void)(s)
+#endif /* PROCESS_CONF_POLL_LIST_LOCK */
+#endif /* PROCESS_POLL_LIST */
+
 #define PROCESS_STATE_NONE        0
 #define PROCESS_STATE_RUNNING     1
 #define PROCESS_STATE_CALLED      2
@@ -187,7 +254,28 @@ call_process(struct process *p, process_event_t ev, process_data_t data)
     PRINTF("process: calling process '%s' with event %d\n", PROCESS_NAME_STRING(p), ev);
     process_current = p;
     p->state = PROCESS_STATE_CALLED;
+#if PROCESS_PROFILE
+    {
+      unsigned long nested = profile_nested;
+      profile_time_t start = PROFILE_NOW();
+      unsigned long elapsed;
+
+      profile_nested = 0;
+      ret = p->thread(&p->pt, ev, data);
+      elapsed = (profile_time_t)(PROFILE_NOW() - start);
+
+      /* Only account the time spent in this process, not in the
+         processes it has called. */
+      p->profile.calls++;
+      p->profile.time += elapsed - profile_nested;
+      if(elapsed - profile_nested > p->profile.time_max) {
+        p->profile.time_max = elapsed - profile_nested;
+      }
+      profile_nested = nested + elapsed;
+    }
+#else /* PROCESS_PROFILE */
     ret = p->thread(&p->pt, ev, data);
+#endif /* PROCESS_PROFILE */
     if(ret == PT_EXITED ||
        ret == PT_ENDED ||
        ev == PROCESS_EVENT_EXIT) {
@@ -207,12 +295,28 @@ process_exit(struct process *p)
 void
 process_init(void)
 {
+#if PROCESS_PRIORITIES
+  process_num_events_t i;
+#endif /* PROCESS_PRIORITIES */
+
   lastevent = PROCESS_EVENT_MAX;
 
   nevents = fevent = 0;
+#if PROCESS_PRIORITIES
+  for(i = 0; i < PROCESS_CONF_NUMEVENTS; i++) {
+    events[i].next = i + 1;
+  }
+  free_events = 0;
+  head[PROCESS_PRIORITY_NORMAL] = head[PROCESS_PRIORITY_HIGH] = NO_EVENT;
+#endif /* PROCESS_PRIORITIES */
 #if PROCESS_CONF_STATS
   process_maxevents = 0;
+  memset(stats, 0, sizeof(stats));
 #endif /* PROCESS_CONF_STATS */
+#if PROCESS_POLL_LIST
+  poll_lists[0] = poll_lists[1] = NULL;
+  poll_active = 0;
+#endif /* PROCESS_POLL_LIST */
 
   process_current = process_list = NULL;
 }
@@ -225,6 +329,31 @@ static void
 do_poll(void)
 {
   struct process *p;
+#if PROCESS_POLL_LIST
+  struct process *next;
+  unsigned char list;
+  int s;
+
+  poll_requested = 0;
+  /* Switch the lists, so that new poll requests go to the other one. */
+  s = POLL_LIST_LOCK();
+  list = poll_active;
+  poll_active = !list;
+  p = poll_lists[list];
+  poll_lists[list] = NULL;
+  POLL_LIST_UNLOCK(s);
+
+  for(; p != NULL; p = next) {
+    /* The process may be polled again, and put on the other list, as
+       soon as needspoll is cleared. */
+    next = p->nextpoll;
+    p->needspoll = 0;
+    if(process_is_running(p)) {
+      p->state = PROCESS_STATE_RUNNING;
+      call_process(p, PROCESS_EVENT_POLL, NULL);
+    }
+  }
+#else /* PROCESS_POLL_LIST */
 
   poll_requested = 0;
   /* Call the processes that needs to be polled. */
@@ -235,6 +364,7 @@ do_poll(void)
       call_process(p, PROCESS_EVENT_POLL, NULL);
     }
   }
+#endif /* PROCESS_POLL_LIST */
 }
 /*---------------------------------------------------------------------------*/
 /*
@@ -249,6 +379,10 @@ do_event(void)
   static process_data_t data;
   static struct process *receiver;
   static struct process *p;
+  process_num_events_t i;
+#if PROCESS_PRIORITIES || PROCESS_CONF_STATS
+  int priority;
+#endif
   
   /*
    * If there are any events in the queue, take the first one and walk
@@ -259,16 +393,67 @@ do_event(void)
    */
 
   if(nevents > 0) {
-    
+
+#if PROCESS_PRIORITIES
+    /* Take the first event of the highest priority class. */
+    priority = head[PROCESS_PRIORITY_HIGH] != NO_EVENT ?
+      PROCESS_PRIORITY_HIGH : PROCESS_PRIORITY_NORMAL;
+    i = head[priority];
+    head[priority] = events[i].next;
+#else /* PROCESS_PRIORITIES */
+#if PROCESS_CONF_STATS
+    priority = 0;
+#endif /* PROCESS_CONF_STATS */
+    i = fevent;
+
+    /* Since we have seen the new event, we move pointer upwards. */
+    fevent = (fevent + 1) % PROCESS_CONF_NUMEVENTS;
+#endif /* PROCESS_PRIORITIES */
+
     /* There are events that we should deliver. */
-    ev = events[fevent].ev;
+    ev = events[i].ev;
     
-    data = events[fevent].data;
-    receiver = events[fevent].p;
+    data = events[i].data;
+    receiver = events[i].p;
 
-    /* Since we have seen the new event, we move pointer upwards
-       and decrese the number of events. */
-    fevent = (fevent + 1) % PROCESS_CONF_NUMEVENTS;
+#if PROCESS_CONF_STATS
+    {
+      unsigned long latency = (rtimer_clock_t)(RTIMER_NOW() - events[i].posted);
+
+      stats[priority].nevents--;
+      stats[priority].delivered++;
+      stats[priority].latency_total += latency;
+      if(latency > stats[priority].latency_max) {
+        stats[priority].latency_max = latency;
+      }
+    }
+#endif /* PROCESS_CONF_STATS */
+
+#if PROCESS_PROFILE
+    {
+      struct process_event_profile *e;
+      unsigned long latency =
+        (profile_time_t)(PROFILE_NOW() - events[i].profile_posted);
+
+      e = &event_profiles[0];
+      if(ev >= PROCESS_EVENT_NONE &&
+         ev - PROCESS_EVENT_NONE < PROCESS_PROFILE_EVENTS) {
+        e = &event_profiles[ev - PROCESS_EVENT_NONE + 1];
+      }
+      e->events++;
+      e->latency_total += latency;
+      if(latency > e->latency_max) {
+        e->latency_max = latency;
+      }
+    }
+#endif /* PROCESS_PROFILE */
+
+#if PROCESS_PRIORITIES
+    events[i].next = free_events;
+    free_events = i;
+#endif /* PROCESS_PRIORITIES */
+
+    /* Decrease the number of events. */
     --nevents;
 
     /* If this is a broadcast event, we deliver it to all events, in
@@ -322,6 +507,9 @@ int
 process_post(struct process *p, process_event_t ev, process_data_t data)
 {
   static process_num_events_t snum;
+#if PROCESS_PRIORITIES || PROCESS_CONF_STATS
+  int priority;
+#endif
 
   if(PROCESS_CURRENT() == NULL) {
     PRINTF("process_post: NULL process posts event %d to process '%s', nevents %d\n",
@@ -343,16 +531,43 @@ process_post(struct process *p, process_event_t ev, process_data_t data)
     return PROCESS_ERR_FULL;
   }
   
+#if PROCESS_PRIORITIES
+  priority = (p != PROCESS_BROADCAST && p->priority == PROCESS_PRIORITY_HIGH) ?
+    PROCESS_PRIORITY_HIGH : PROCESS_PRIORITY_NORMAL;
+  snum = free_events;
+  free_events = events[snum].next;
+  events[snum].next = NO_EVENT;
+  if(head[priority] == NO_EVENT) {
+    head[priority] = snum;
+  } else {
+    events[tail[priority]].next = snum;
+  }
+  tail[priority] = snum;
+#else /* PROCESS_PRIORITIES */
+#if PROCESS_CONF_STATS
+  priority = 0;
+#endif /* PROCESS_CONF_STATS */
   snum = (process_num_events_t)(fevent + nevents) % PROCESS_CONF_NUMEVENTS;
+#endif /* PROCESS_PRIORITIES */
   events[snum].ev = ev;
   events[snum].data = data;
   events[snum].p = p;
+#if PROCESS_CONF_STATS
+  events[snum].posted = RTIMER_NOW();
+#endif /* PROCESS_CONF_STATS */
+#if PROCESS_PROFILE
+  events[snum].profile_posted = PROFILE_NOW();
+#endif /* PROCESS_PROFILE */
   ++nevents;
 
 #if PROCESS_CONF_STATS
   if(nevents > process_maxevents) {
     process_maxevents = nevents;
   }
+  stats[priority].nevents++;
+  if(stats[priority].nevents > stats[priority].maxevents) {
+    stats[priority].maxevents = stats[priority].nevents;
+  }
 #endif /* PROCESS_CONF_STATS */
   
   return PROCESS_ERR_OK;
@@ -373,7 +588,21 @@ process_poll(struct process *p)
   if(p != NULL) {
     if(p->state == PROCESS_STATE_RUNNING ||
        p->state == PROCESS_STATE_CALLED) {
+#if PROCESS_POLL_LIST
+      int s;
+
+      /* Test and set needspoll together with the insertion, so that
+         the process is on a list whenever needspoll is set. */
+      s = POLL_LIST_LOCK();
+      if(!p->needspoll) {
+        p->needspoll = 1;
+        p->nextpoll = poll_lists[poll_active];
+        poll_lists[poll_active] = p;
+      }
+      POLL_LIST_UNLOCK(s);
+#else /* PROCESS_POLL_LIST */
       p->needspoll = 1;
+#endif /* PROCESS_POLL_LIST */
       poll_requested = 1;
     }
   }
@@ -385,4 +614,42 @@ process_is_running(struct process *p)
   return p->state != PROCESS_STATE_NONE;
 }
 /*---------------------------------------------------------------------------*/
+#if PROCESS_CONF_STATS
+void
+process_get_stats(int priority, struct process_stats *s)
+{
+  if(priority >= 0 && priority < NPRIORITIES) {
+    memcpy(s, &stats[priority], sizeof(*s));
+  } else {
+    memset(s, 0, sizeof(*s));
+  }
+}
+#endif /* PROCESS_CONF_STATS */
+/*---------------------------------------------------------------------------*/
+#if PROCESS_PROFILE
+void
+process_get_event_profile(process_event_t ev,
+                          struct process_event_profile *profile)
+{
+  if(ev >= PROCESS_EVENT_NONE &&
+     ev - PROCESS_EVENT_NONE < PROCESS_PROFILE_EVENTS) {
+    memcpy(profile, &event_profiles[ev - PROCESS_EVENT_NONE + 1],
+           sizeof(*profile));
+  } else {
+    memcpy(profile, &event_profiles[0], sizeof(*profile));
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+process_profile_reset(void)
+{
+  struct process *p;
+
+  for(p = process_list; p != NULL; p = p->next) {
+    memset(&p->profile, 0, sizeof(p->profile));
+  }
+  memset(event_profiles, 0, sizeof(event_profiles));
+}
+#endif /* PROCESS_PROFILE */
+/*---------------------------------------------------------------------------*/
 /** @} */
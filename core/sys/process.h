@@ -88,6 +88,74 @@ typedef unsigned char process_num_events_t;
 #define PROCESS_CONF_NUMEVENTS 32
 #endif /* PROCESS_CONF_NUMEVENTS */
 
+/**
+ * Deliver the events posted to high priority processes before those
+ * posted to other processes. Both classes share the
+ * PROCESS_CONF_NUMEVENTS event slots.
+ */
+#ifdef PROCESS_CONF_PRIORITIES
+#define PROCESS_PRIORITIES PROCESS_CONF_PRIORITIES
+#else /* PROCESS_CONF_PRIORITIES */
+#define PROCESS_PRIORITIES 0
+#endif /* PROCESS_CONF_PRIORITIES */
+
+/**
+ * Keep the processes that have been polled in a list, so that the poll
+ * handlers are called without walking through all processes.
+ *
+ * Platforms on which interrupt handlers poll processes must also
+ * define PROCESS_CONF_POLL_LIST_LOCK(), which disables interrupts and
+ * returns the previous interrupt state, and
+ * PROCESS_CONF_POLL_LIST_UNLOCK(s), which restores it.
+ */
+#ifdef PROCESS_CONF_POLL_LIST
+#define PROCESS_POLL_LIST PROCESS_CONF_POLL_LIST
+#else /* PROCESS_CONF_POLL_LIST */
+#define PROCESS_POLL_LIST 0
+#endif /* PROCESS_CONF_POLL_LIST */
+
+/**
+ * Record how often each process runs and for how long, and how long
+ * the events wait in the queue. The rtimer clock is used, unless the
+ * platform sets PROCESS_CONF_PROFILE_NOW() to a finer clock that
+ * returns an unsigned long.
+ */
+#ifdef PROCESS_CONF_PROFILE
+#define PROCESS_PROFILE PROCESS_CONF_PROFILE
+#else /* PROCESS_CONF_PROFILE */
+#define PROCESS_PROFILE 0
+#endif /* PROCESS_CONF_PROFILE */
+
+/**
+ * Number of ticks per second of the profiler clock.
+ */
+#ifdef PROCESS_CONF_PROFILE_SECOND
+#define PROCESS_PROFILE_SECOND PROCESS_CONF_PROFILE_SECOND
+#else /* PROCESS_CONF_PROFILE_SECOND */
+#define PROCESS_PROFILE_SECOND RTIMER_ARCH_SECOND
+#endif /* PROCESS_CONF_PROFILE_SECOND */
+
+/**
+ * Number of event numbers, starting with PROCESS_EVENT_NONE, for which
+ * the latency is recorded separately when PROCESS_CONF_PROFILE is
+ * set. The latencies of the other events are recorded together.
+ */
+#ifdef PROCESS_CONF_PROFILE_EVENTS
+#define PROCESS_PROFILE_EVENTS PROCESS_CONF_PROFILE_EVENTS
+#else /* PROCESS_CONF_PROFILE_EVENTS */
+#define PROCESS_PROFILE_EVENTS 16
+#endif /* PROCESS_CONF_PROFILE_EVENTS */
+
+/**
+ * \name Process priorities
+ * @{
+ */
+/** Application processes. */
+#define PROCESS_PRIORITY_NORMAL 0
+/** Processes that handle timers and network traffic. */
+#define PROCESS_PRIORITY_HIGH   1
+/** @} */
+
 #define PROCESS_EVENT_NONE            0x80
 #define PROCESS_EVENT_INIT            0x81
 #define PROCESS_EVENT_POLL            0x82
@@ -312,6 +380,35 @@ static PT_THREAD(process_thread_##name(struct pt *process_pt,	\
 
 /** @} */
 
+#if PROCESS_PROFILE
+/**
+ * The profile of a process. The times are in PROCESS_PROFILE_SECOND
+ * ticks, and do not include the time spent in other processes called
+ * synchronously.
+ */
+struct process_profile {
+  /** Number of times the process has been called. */
+  unsigned long calls;
+  /** Total time spent in the process. */
+  unsigned long time;
+  /** Longest time spent in one call of the process. */
+  unsigned long time_max;
+};
+
+/**
+ * The latency between the posting and the delivery of events, in
+ * PROCESS_PROFILE_SECOND ticks.
+ */
+struct process_event_profile {
+  /** Number of events delivered. */
+  unsigned long events;
+  /** Sum of the latencies of the delivered events. */
+  unsigned long latency_total;
+  /** Highest latency of a delivered event. */
+  unsigned long latency_max;
+};
+#endif /* PROCESS_PROFILE */
+
 struct process {
   struct process *next;
 #if PROCESS_CONF_NO_PROCESS_NAMES
@@ -323,6 +420,15 @@ struct process {
   PT_THREAD((* thread)(struct pt *, process_event_t, process_data_t));
   struct pt pt;
   unsigned char state, needspoll;
+#if PROCESS_PRIORITIES
+  unsigned char priority;
+#endif /* PROCESS_PRIORITIES */
+#if PROCESS_POLL_LIST
+  struct process *nextpoll;
+#endif /* PROCESS_POLL_LIST */
+#if PROCESS_PROFILE
+  struct process_profile profile;
+#endif /* PROCESS_PROFILE */
 };
 
 /**
@@ -519,6 +625,69 @@ CCIF int process_is_running(struct process *p);
  */
 int process_nevents(void);
 
+/**
+ * Set the priority of a process.
+ *
+ * Events posted to a process with priority PROCESS_PRIORITY_HIGH are
+ * delivered before the events posted to other processes. This has no
+ * effect unless PROCESS_CONF_PRIORITIES is set.
+ *
+ * \param p The process.
+ * \param priority PROCESS_PRIORITY_NORMAL or PROCESS_PRIORITY_HIGH.
+ */
+#if PROCESS_PRIORITIES
+#define process_set_priority(p, prio) ((p)->priority = (prio))
+#else /* PROCESS_PRIORITIES */
+#define process_set_priority(p, prio)
+#endif /* PROCESS_PRIORITIES */
+
+#if PROCESS_CONF_STATS
+/**
+ * Statistics of the event queue of one priority class.
+ *
+ * The latencies are the times between the posting and the delivery of
+ * the events, in rtimer ticks.
+ */
+struct process_stats {
+  /** Number of events waiting in the queue. */
+  process_num_events_t nevents;
+  /** Highest number of events that have waited in the queue. */
+  process_num_events_t maxevents;
+  /** Number of events delivered. */
+  unsigned long delivered;
+  /** Sum of the latencies of the delivered events. */
+  unsigned long latency_total;
+  /** Highest latency of a delivered event. */
+  unsigned long latency_max;
+};
+
+/**
+ * Get the statistics of the event queue.
+ *
+ * \param priority The priority class, PROCESS_PRIORITY_NORMAL when
+ * PROCESS_CONF_PRIORITIES is not set.
+ * \param stats Where to store the statistics.
+ */
+void process_get_stats(int priority, struct process_stats *stats);
+#endif /* PROCESS_CONF_STATS */
+
+#if PROCESS_PROFILE
+/**
+ * Get the latency profile of an event.
+ *
+ * \param ev The event. Events outside of the PROCESS_PROFILE_EVENTS
+ * events starting with PROCESS_EVENT_NONE share one profile.
+ * \param profile Where to store the profile.
+ */
+void process_get_event_profile(process_event_t ev,
+                               struct process_event_profile *profile);
+
+/**
+ * Clear the profiles of the running processes and of the events.
+ */
+void process_profile_reset(void);
+#endif /* PROCESS_PROFILE */
+
 /** @} */
 
 CCIF extern struct process *process_list;
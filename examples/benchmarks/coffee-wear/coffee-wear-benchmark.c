@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2013, the Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Endurance benchmark of Coffee that simulates years of use of
+ *         a data logger, and reports how the sector erasures are spread.
+ */
+
+#include "contiki.h"
+#include "cfs/cfs.h"
+#include "cfs/cfs-coffee.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define YEARS          5
+#define HOURS_PER_YEAR (365 * 24)
+
+/* Small state files that are rewritten through micro logs. */
+#define STATE_FILES      4
+#define STATE_FILE_SIZE  2048
+#define STATE_WRITES     4     /* Per hour. */
+#define STATE_WRITE_SIZE 32
+
+/* Sensor readings are appended to a file, which is kept for a few days
+   once it is full. */
+#define READING_SIZE     96    /* Per hour. */
+#define ARCHIVE_SIZE     16384
+#define ARCHIVES         4
+
+/* Configuration that is written once. */
+#define CONFIG_FILES     4
+#define CONFIG_FILE_SIZE 32768
+
+/* The configuration of Coffee is private to cfs-coffee.c. */
+#if defined(COFFEE_HOT_COLD_SEPARATION) && COFFEE_HOT_COLD_SEPARATION
+#define MODE "hot/cold separation"
+#else
+#define MODE "first fit"
+#endif
+
+static char buf[CONFIG_FILE_SIZE];
+static unsigned archive_first, archive_next;
+static cfs_offset_t archive_size;
+/*---------------------------------------------------------------------------*/
+static void
+write_file(const char *name, cfs_offset_t offset, int size, int flags)
+{
+  int fd;
+
+  fd = cfs_open(name, flags);
+  if(fd < 0 || cfs_seek(fd, offset, CFS_SEEK_SET) != offset ||
+     cfs_write(fd, buf, size) != size) {
+    printf("coffee-wear-benchmark: cannot write %s\n", name);
+    exit(1);
+  }
+  cfs_close(fd);
+}
+/*---------------------------------------------------------------------------*/
+static void
+simulate_hour(void)
+{
+  char name[16];
+  int i;
+
+  for(i = 0; i < STATE_WRITES; i++) {
+    sprintf(name, "state%d", (int)(random() % STATE_FILES));
+    memset(buf, random(), STATE_WRITE_SIZE);
+    write_file(name, (random() % (STATE_FILE_SIZE / STATE_WRITE_SIZE)) *
+	       STATE_WRITE_SIZE, STATE_WRITE_SIZE, CFS_READ | CFS_WRITE);
+  }
+
+  sprintf(name, "data%u", archive_next);
+  memset(buf, random() | 1, READING_SIZE);
+  write_file(name, archive_size, READING_SIZE, CFS_WRITE | CFS_APPEND);
+  archive_size += READING_SIZE;
+  if(archive_size + READING_SIZE > ARCHIVE_SIZE) {
+    archive_next++;
+    archive_size = 0;
+    if(archive_next - archive_first > ARCHIVES) {
+      sprintf(name, "data%u", archive_first++);
+      cfs_remove(name);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+report(const char *what)
+{
+  long count, min, max;
+  unsigned long total;
+  unsigned sector;
+
+  min = max = cfs_coffee_get_erase_count(0);
+  total = 0;
+  for(sector = 0; (count = cfs_coffee_get_erase_count(sector)) >= 0;
+      sector++) {
+    if(count < min) {
+      min = count;
+    }
+    if(count > max) {
+      max = count;
+    }
+    total += count;
+  }
+  printf("%-6s %8lu %8ld %8ld %8.1f %8.2f\n", what, total, min, max,
+	 (double)total / sector, max * (double)sector / total);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS(coffee_wear_benchmark_process, "Coffee wear benchmark");
+AUTOSTART_PROCESSES(&coffee_wear_benchmark_process);
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(coffee_wear_benchmark_process, ev, data)
+{
+  static unsigned year, hour;
+  char name[16];
+  unsigned sector;
+  int i;
+
+  PROCESS_BEGIN();
+
+  if(cfs_coffee_get_erase_count(0) < 0) {
+    printf("coffee-wear-benchmark: COFFEE_WEAR_STATS is not enabled\n");
+    exit(1);
+  }
+
+  cfs_coffee_format();
+
+  for(i = 0; i < CONFIG_FILES; i++) {
+    sprintf(name, "config%d", i);
+    memset(buf, i + 1, sizeof(buf));
+    write_file(name, 0, sizeof(buf), CFS_WRITE);
+  }
+  for(i = 0; i < STATE_FILES; i++) {
+    sprintf(name, "state%d", i);
+    cfs_coffee_reserve(name, STATE_FILE_SIZE);
+    memset(buf, i + 1, STATE_FILE_SIZE);
+    write_file(name, 0, STATE_FILE_SIZE, CFS_WRITE);
+  }
+
+  printf("coffee-wear-benchmark: %s, sector erasures\n", MODE);
+  printf("%-6s %8s %8s %8s %8s %8s\n",
+	 "year", "total", "min", "max", "mean", "max/mean");
+  for(year = 1; year <= YEARS; year++) {
+    for(hour = 0; hour < HOURS_PER_YEAR; hour++) {
+      simulate_hour();
+      /* Let the incremental garbage collector run, if it is enabled. */
+      process_poll(&coffee_wear_benchmark_process);
+      PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_POLL);
+    }
+    sprintf(name, "%u", year);
+    report(name);
+  }
+
+  printf("Erasures per sector:");
+  for(sector = 0; cfs_coffee_get_erase_count(sector) >= 0; sector++) {
+    printf(" %ld", cfs_coffee_get_erase_count(sector));
+  }
+  printf("\n");
+
+  exit(0);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,276 @@
+/*
+ * Copyright (c) 2013, the Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Benchmark of the Coffee file lookups against the number of
+ *         files, for the native platform and for Sky motes in Cooja.
+ */
+
+#include "contiki.h"
+#include "cfs/cfs.h"
+#include "cfs/cfs-coffee.h"
+#include "lib/random.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define FILE_SIZE 256
+
+#define DATA_FILE_SIZE 65536L
+#define DATA_SIZE      1000
+
+#define GC_FILES       8
+
+/* Fewer rounds on simulated motes, where every flash access takes
+   simulated time. */
+#if CONTIKI_TARGET_NATIVE
+#define ROUNDS         1000
+#define GC_ROUNDS      5000
+#else
+#define ROUNDS         100
+#define GC_ROUNDS      500
+#endif
+
+/* The configuration of Coffee is private to cfs-coffee.c. */
+#if defined(COFFEE_NAME_INDEX) && COFFEE_NAME_INDEX
+#define MODE "name index"
+#else
+#define MODE "scan"
+#endif
+#if defined(COFFEE_GC_INCREMENTAL) && COFFEE_GC_INCREMENTAL
+#define GC_MODE "incremental GC"
+#else
+#define GC_MODE "GC on demand"
+#endif
+#if defined(COFFEE_EOF_RECORDS) && COFFEE_EOF_RECORDS
+#define EOF_MODE "EOF records"
+#else
+#define EOF_MODE "EOF scan"
+#endif
+
+static const int counts[] = { 8, 32, 128 };
+/*---------------------------------------------------------------------------*/
+#if CONTIKI_TARGET_NATIVE
+#if defined(__i386__) || defined(__x86_64__)
+#define UNIT "cycles"
+static unsigned long long
+now(void)
+{
+  return __builtin_ia32_rdtsc();
+}
+#else
+#define UNIT "ns"
+static unsigned long long
+now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+#endif
+#else /* CONTIKI_TARGET_NATIVE */
+#define UNIT "us"
+static unsigned long long
+now(void)
+{
+  static rtimer_clock_t last;
+  static unsigned long long ticks;
+  rtimer_clock_t t;
+
+  /* Extend the rtimer, which may wrap within a few seconds. */
+  t = RTIMER_NOW();
+  ticks += (rtimer_clock_t)(t - last);
+  last = t;
+  return ticks * 1000000 / RTIMER_SECOND;
+}
+#endif /* CONTIKI_TARGET_NATIVE */
+/*---------------------------------------------------------------------------*/
+static void
+reboot(void)
+{
+  unsigned size;
+  void *mem;
+
+  /* Forget everything that Coffee keeps in RAM. */
+  mem = cfs_coffee_get_protected_mem(&size);
+  memset(mem, 0, size);
+}
+/*---------------------------------------------------------------------------*/
+static void
+benchmark(int num)
+{
+  unsigned long long start, first, open, miss;
+  char name[16];
+  int r, i, fd;
+
+  cfs_coffee_format();
+  for(i = 0; i < num; i++) {
+    sprintf(name, "file%d", i);
+    if(cfs_coffee_reserve(name, FILE_SIZE) < 0) {
+      printf("coffee-benchmark: failed to create %s\n", name);
+      exit(1);
+    }
+  }
+  reboot();
+
+  sprintf(name, "file%d", num - 1);
+  start = now();
+  fd = cfs_open(name, CFS_READ);
+  first = now() - start;
+  cfs_close(fd);
+
+  open = 0;
+  for(r = 0; r < ROUNDS; r++) {
+    sprintf(name, "file%d", (int)(random_rand() % num));
+    start = now();
+    fd = cfs_open(name, CFS_READ);
+    cfs_close(fd);
+    open += now() - start;
+  }
+
+  miss = 0;
+  for(r = 0; r < ROUNDS; r++) {
+    sprintf(name, "none%d", (int)(random_rand() % num));
+    start = now();
+    fd = cfs_open(name, CFS_READ);
+    miss += now() - start;
+  }
+
+  /* Integer figures, as printf() has no floating point on every
+     platform. */
+  printf("%5d %12lu %12lu %12lu\n", num, (unsigned long)first,
+         (unsigned long)(open / ROUNDS), (unsigned long)(miss / ROUNDS));
+}
+/*---------------------------------------------------------------------------*/
+static void
+benchmark_end(void)
+{
+  unsigned long long start, end;
+  static char buf[DATA_SIZE];
+  int r, fd;
+
+  cfs_coffee_format();
+  if(cfs_coffee_reserve("data", DATA_FILE_SIZE) < 0) {
+    printf("coffee-benchmark: failed to create the data file\n");
+    exit(1);
+  }
+  fd = cfs_open("data", CFS_WRITE);
+  memset(buf, 0xa5, sizeof(buf));
+  cfs_write(fd, buf, sizeof(buf));
+  cfs_close(fd);
+
+  end = 0;
+  for(r = 0; r < ROUNDS; r++) {
+    reboot();
+    start = now();
+    fd = cfs_open("data", CFS_READ);
+    cfs_seek(fd, 0, CFS_SEEK_END);
+    end += now() - start;
+    cfs_close(fd);
+  }
+
+  printf("end of a %d byte file in %ld bytes: %lu %s\n",
+         DATA_SIZE, DATA_FILE_SIZE, (unsigned long)(end / ROUNDS), UNIT);
+}
+/*---------------------------------------------------------------------------*/
+static void
+benchmark_gc(void)
+{
+  unsigned long long start, elapsed, total, max;
+  struct cfs_coffee_gc_stats stats;
+  char name[16];
+  int r, fd;
+
+  cfs_coffee_format();
+
+  /* Rewrite random files, which leaves obsolete files behind. */
+  total = max = 0;
+  for(r = 0; r < GC_ROUNDS; r++) {
+    sprintf(name, "gc%d", (int)(random_rand() % GC_FILES));
+    cfs_remove(name);
+    start = now();
+    fd = cfs_open(name, CFS_WRITE);
+    elapsed = now() - start;
+    if(fd < 0) {
+      printf("coffee-benchmark: failed to create %s\n", name);
+      exit(1);
+    }
+    cfs_write(fd, name, sizeof(name));
+    cfs_close(fd);
+
+    total += elapsed;
+    if(elapsed > max) {
+      max = elapsed;
+    }
+
+    /* Give the other processes a chance to run. */
+    while(process_run() > 0);
+  }
+
+  cfs_coffee_get_gc_stats(&stats);
+  printf("create with %s: %lu average, %lu max %s, "
+         "%lu erased sectors, %lu blocking GC runs\n", GC_MODE,
+         (unsigned long)(total / GC_ROUNDS), (unsigned long)max, UNIT,
+         stats.erased, stats.blocking_runs);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS(coffee_benchmark_process, "Coffee benchmark");
+AUTOSTART_PROCESSES(&coffee_benchmark_process);
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(coffee_benchmark_process, ev, data)
+{
+  int i;
+
+  PROCESS_BEGIN();
+
+  printf("coffee-benchmark: %s, %s, %s per operation\n",
+         MODE, EOF_MODE, UNIT);
+  printf("%5s %12s %12s %12s\n", "num", "first", "open", "miss");
+  for(i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+    benchmark(counts[i]);
+  }
+  benchmark_end();
+  benchmark_gc();
+  printf("coffee-benchmark: done\n");
+
+#if CONTIKI_TARGET_NATIVE
+  exit(0);
+#endif /* CONTIKI_TARGET_NATIVE */
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
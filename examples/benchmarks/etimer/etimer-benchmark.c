@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2013, the Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Benchmark of the event timer operations against the number of
+ *         pending timers, for the native platform.
+ */
+
+#include "contiki.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define MAX_TIMERS 512
+#define ROUNDS     10000
+
+static struct etimer timers[MAX_TIMERS];
+static struct ctimer ctimers[MAX_TIMERS];
+static const int counts[] = { 8, 32, 128, 512 };
+/*---------------------------------------------------------------------------*/
+#if defined(__i386__) || defined(__x86_64__)
+#define UNIT "cycles"
+static unsigned long long
+now(void)
+{
+  return __builtin_ia32_rdtsc();
+}
+#else
+#define UNIT "ns"
+static unsigned long long
+now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+#endif
+/*---------------------------------------------------------------------------*/
+static clock_time_t
+interval(void)
+{
+  /* Long enough for no timer to expire during the benchmark. */
+  return 1000 * CLOCK_SECOND + random() % (100 * CLOCK_SECOND);
+}
+/*---------------------------------------------------------------------------*/
+static void
+benchmark(int num)
+{
+  unsigned long long start, set, stop, poll, cset;
+  struct etimer *t;
+  struct ctimer *c;
+  int r, i;
+
+  for(i = 0; i < num; i++) {
+    etimer_set(&timers[i], interval());
+  }
+
+  set = 0;
+  for(r = 0; r < ROUNDS; r++) {
+    t = &timers[random() % num];
+    start = now();
+    etimer_set(t, interval());
+    set += now() - start;
+  }
+
+  stop = 0;
+  for(r = 0; r < ROUNDS; r++) {
+    t = &timers[random() % num];
+    start = now();
+    etimer_stop(t);
+    etimer_set(t, interval());
+    stop += now() - start;
+  }
+
+  poll = 0;
+  for(r = 0; r < ROUNDS; r++) {
+    etimer_request_poll();
+    start = now();
+    process_run();
+    poll += now() - start;
+  }
+
+  for(i = 0; i < num; i++) {
+    etimer_stop(&timers[i]);
+  }
+
+  for(i = 0; i < num; i++) {
+    ctimer_set(&ctimers[i], interval(), NULL, NULL);
+  }
+
+  cset = 0;
+  for(r = 0; r < ROUNDS; r++) {
+    c = &ctimers[random() % num];
+    start = now();
+    ctimer_set(c, interval(), NULL, NULL);
+    cset += now() - start;
+  }
+
+  for(i = 0; i < num; i++) {
+    ctimer_stop(&ctimers[i]);
+  }
+
+  printf("%5d %12.1f %12.1f %12.1f %12.1f\n", num,
+         (double)set / ROUNDS, (double)stop / ROUNDS, (double)poll / ROUNDS,
+         (double)cset / ROUNDS);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS(etimer_benchmark_process, "etimer benchmark");
+AUTOSTART_PROCESSES(&etimer_benchmark_process);
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(etimer_benchmark_process, ev, data)
+{
+  int i;
+
+  PROCESS_BEGIN();
+
+  printf("etimer-benchmark: %s, %s per operation\n",
+         ETIMER_HEAP ? "heap" : "list", UNIT);
+  printf("%5s %12s %12s %12s %12s\n", "num", "set", "stop", "poll",
+         "ctimer_set");
+  for(i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+    benchmark(counts[i]);
+  }
+
+  exit(0);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2013, the Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Benchmark of memb_alloc() and memb_free() against pool size,
+ *         for the native platform.
+ */
+
+#include "contiki.h"
+#include "lib/memb.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define ROUNDS 200
+#define CHURN  10000
+
+struct block {
+  char data[32];
+};
+
+MEMB(pool8, struct block, 8);
+MEMB(pool32, struct block, 32);
+MEMB(pool128, struct block, 128);
+MEMB(pool512, struct block, 512);
+MEMB(pool2048, struct block, 2048);
+
+static struct memb *pools[] = { &pool8, &pool32, &pool128, &pool512,
+                                &pool2048 };
+static void *blocks[2048];
+/*---------------------------------------------------------------------------*/
+#if defined(__i386__) || defined(__x86_64__)
+#define UNIT "cycles"
+static unsigned long long
+now(void)
+{
+  return __builtin_ia32_rdtsc();
+}
+#else
+#define UNIT "ns"
+static unsigned long long
+now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+#endif
+/*---------------------------------------------------------------------------*/
+static void
+benchmark(struct memb *m)
+{
+  unsigned long long start, fill, drain, churn;
+  void *p;
+  int r, i;
+
+  memb_init(m);
+  fill = drain = 0;
+
+  for(r = 0; r < ROUNDS; r++) {
+    start = now();
+    for(i = 0; i < m->num; i++) {
+      blocks[i] = memb_alloc(m);
+    }
+    fill += now() - start;
+
+    start = now();
+    for(i = 0; i < m->num; i++) {
+      memb_free(m, blocks[i]);
+    }
+    drain += now() - start;
+  }
+
+  for(i = 0; i < m->num; i++) {
+    blocks[i] = memb_alloc(m);
+    if(blocks[i] == NULL) {
+      printf("memb-benchmark: allocation %d of %d failed\n", i, m->num);
+      exit(1);
+    }
+  }
+  if(memb_alloc(m) != NULL) {
+    printf("memb-benchmark: allocated more than %d blocks\n", m->num);
+    exit(1);
+  }
+  memb_free(m, blocks[m->num - 1]);
+
+  start = now();
+  for(r = 0; r < CHURN; r++) {
+    p = memb_alloc(m);
+    memb_free(m, p);
+  }
+  churn = now() - start;
+
+  printf("%5u %12.1f %12.1f %12.1f\n", m->num,
+         (double)fill / ((double)ROUNDS * m->num),
+         (double)drain / ((double)ROUNDS * m->num),
+         (double)churn / CHURN);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS(memb_benchmark_process, "memb benchmark");
+AUTOSTART_PROCESSES(&memb_benchmark_process);
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(memb_benchmark_process, ev, data)
+{
+  int i;
+
+  PROCESS_BEGIN();
+
+  printf("memb-benchmark: %s, %s per operation\n",
+         MEMB_FREELIST ? "free list" : "linear search", UNIT);
+  printf("%5s %12s %12s %12s\n", "num", "fill", "drain", "churn");
+  for(i = 0; i < sizeof(pools) / sizeof(pools[0]); i++) {
+    benchmark(pools[i]);
+  }
+
+  exit(0);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2013, the Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Benchmark of uip_ds6_route_lookup() against the number of
+ *         routes, for the native platform.
+ */
+
+#include "contiki.h"
+#include "net/uip-ds6.h"
+#include "lib/random.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define NEXTHOPS 8
+#define DURATION 0.5 /* seconds per measurement */
+
+static const int route_counts[] = { 10, 100, 1000 };
+static uip_ipaddr_t dest[1000];
+/*---------------------------------------------------------------------------*/
+static double
+now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+/*---------------------------------------------------------------------------*/
+static void
+host_addr(uip_ipaddr_t *addr, int n)
+{
+  /* Spread the interface identifiers like the MAC-derived addresses
+     of a real network. */
+  uip_ip6addr(addr, 0xaaaa, 0, 0, 0, 0x0212, 0x7400 | (n >> 8),
+              (n * 0x9e37) & 0xffff, n);
+}
+/*---------------------------------------------------------------------------*/
+static double
+lookups_per_second(int num, int offset, int expect_found)
+{
+  unsigned long lookups;
+  double start, elapsed;
+  uip_ds6_route_t *r;
+  uip_ipaddr_t addr;
+  int i;
+
+  lookups = 0;
+  start = now();
+  do {
+    for(i = 0; i < 1000; i++) {
+      if(offset == 0) {
+        r = uip_ds6_route_lookup(&dest[random_rand() % num]);
+      } else {
+        host_addr(&addr, offset + i);
+        r = uip_ds6_route_lookup(&addr);
+      }
+      if((r != NULL) != expect_found) {
+        printf("route-lookup-benchmark: unexpected lookup result\n");
+        exit(1);
+      }
+    }
+    lookups += 1000;
+    elapsed = now() - start;
+  } while(elapsed < DURATION);
+
+  return lookups / elapsed;
+}
+/*---------------------------------------------------------------------------*/
+PROCESS(route_lookup_benchmark_process, "Route lookup benchmark");
+AUTOSTART_PROCESSES(&route_lookup_benchmark_process);
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(route_lookup_benchmark_process, ev, data)
+{
+  static uip_ipaddr_t nexthop[NEXTHOPS];
+  uip_lladdr_t lladdr;
+  uip_ds6_route_t *r;
+  int i, j, num;
+
+  PROCESS_BEGIN();
+
+  for(i = 0; i < NEXTHOPS; i++) {
+    memset(&lladdr, 0, sizeof(lladdr));
+    lladdr.addr[sizeof(lladdr) - 1] = i + 1;
+    uip_ip6addr(&nexthop[i], 0xfe80, 0, 0, 0, 0, 0, 0, i + 1);
+    uip_ds6_nbr_add(&nexthop[i], &lladdr, 1, NBR_REACHABLE);
+  }
+
+  printf("route-lookup-benchmark: %s, lookups per second\n",
+         UIP_DS6_ROUTE_HASH ? "indexed" : "linear search");
+  printf("%6s %12s %12s\n", "routes", "hit", "miss");
+
+  for(i = 0; i < sizeof(route_counts) / sizeof(route_counts[0]); i++) {
+    num = route_counts[i];
+
+    while((r = uip_ds6_route_head()) != NULL) {
+      uip_ds6_route_rm(r);
+    }
+    for(j = 0; j < num; j++) {
+      host_addr(&dest[j], j + 1);
+      if(uip_ds6_route_add(&dest[j], 128, &nexthop[j % NEXTHOPS]) == NULL) {
+        printf("route-lookup-benchmark: could not add route %d\n", j);
+        exit(1);
+      }
+    }
+
+    printf("%6d %12.0f %12.0f\n", num,
+           lookups_per_second(num, 0, 1),
+           lookups_per_second(num, 2000, 0));
+  }
+
+  exit(0);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -105,6 +105,17 @@
 
 #define NETSTACK_CONF_RDC_CHANNEL_CHECK_RATE 8
 
+/* Channel hopping and slot timing of the TSCH RDC driver. The rtimer
+   of Cooja motes counts milliseconds and their radio takes a few of
+   them to turn around, so the slots are longer than on hardware. */
+#define TSCH_CONF_SET_CHANNEL(c)               radio_set_channel(c)
+#define TSCH_CONF_SLOT_DURATION                (RTIMER_SECOND / 50)
+#define TSCH_CONF_TX_OFFSET                    (RTIMER_SECOND / 200)
+#define TSCH_CONF_TX_DELAY                     2
+#define TSCH_CONF_GUARD_TIME                   3
+#define TSCH_CONF_ACK_WAIT_TIME                (RTIMER_SECOND / 200)
+#define TSCH_CONF_AFTER_ACK_DETECTED_WAIT_TIME 2
+
 /* Default network config */
 #if WITH_UIP6
 
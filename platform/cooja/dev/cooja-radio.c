@@ -66,6 +66,11 @@ int simLQI = 105;
 
 static const void *pending_data;
 
+/* The time at which the last frame started to arrive. Like cc2420,
+   we pass it up in PACKETBUF_ATTR_TIMESTAMP. */
+static rtimer_clock_t last_packet_timestamp;
+static char timestamp_taken;
+
 PROCESS(cooja_radio_process, "cooja radio process");
 
 /*---------------------------------------------------------------------------*/
@@ -119,12 +124,18 @@ doInterfaceActionsBeforeTick(void)
 {
   if(!simRadioHWOn) {
     simInSize = 0;
+    timestamp_taken = 0;
     return;
   }
   if(simReceiving) {
     simLastSignalStrength = simSignalStrength;
+    if(!timestamp_taken) {
+      last_packet_timestamp = simCurrentTime;
+      timestamp_taken = 1;
+    }
     return;
   }
+  timestamp_taken = 0;
 
   if(simInSize > 0) {
     process_poll(&cooja_radio_process);
@@ -255,6 +266,7 @@ PROCESS_THREAD(cooja_radio_process, ev, data)
     PROCESS_YIELD_UNTIL(ev == PROCESS_EVENT_POLL);
 
     packetbuf_clear();
+    packetbuf_set_attr(PACKETBUF_ATTR_TIMESTAMP, last_packet_timestamp);
     len = radio_read(packetbuf_dataptr(), PACKETBUF_SIZE);
     if(len > 0) {
       packetbuf_set_datalen(len);
@@ -54,7 +54,11 @@
 #define COFFEE_LOG_DIVISOR		4
 #define COFFEE_LOG_SIZE			8192
 #define COFFEE_LOG_TABLE_LIMIT		256
+#ifdef COFFEE_CONF_MICRO_LOGS
+#define COFFEE_MICRO_LOGS		COFFEE_CONF_MICRO_LOGS
+#else
 #define COFFEE_MICRO_LOGS		0
+#endif
 #define COFFEE_IO_SEMANTICS		1
 
 #define COFFEE_WRITE(buf, size, offset)				\
@@ -66,6 +70,12 @@
 #define COFFEE_ERASE(sector)					\
   		xmem_erase(COFFEE_SECTOR_SIZE, COFFEE_START + (sector) * COFFEE_SECTOR_SIZE)
 
+#define COFFEE_WRITEV(iov, iovcnt)				\
+		xmem_pwritev((iov), (iovcnt))
+
+#define COFFEE_SUBMIT(req)	xmem_submit(req)
+#define COFFEE_WAIT(req)	xmem_wait(req)
+
 #define READ_HEADER(hdr, page)						\
   COFFEE_READ((hdr), sizeof (*hdr), (page) * COFFEE_PAGE_SIZE)
 
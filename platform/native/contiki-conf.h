@@ -243,6 +243,12 @@ typedef unsigned long clock_time_t;
 
 #define CLOCK_CONF_SECOND 1000
 
+/* The native rtimer only ticks at 1 kHz, too coarse for the process
+   profiler, so profile against a microsecond monotonic clock instead. */
+unsigned long clock_profile_usecs(void);
+#define PROCESS_CONF_PROFILE_NOW()  clock_profile_usecs()
+#define PROCESS_CONF_PROFILE_SECOND 1000000UL
+
 #define LOG_CONF_ENABLED 1
 
 #define PROGRAM_HANDLER_CONF_MAX_NUMDSCS 10
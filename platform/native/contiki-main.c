@@ -32,6 +32,7 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <sys/select.h>
@@ -153,7 +154,44 @@ set_rime_addr(void)
   printf("%d\n", addr.u8[i]);
 }
 
+/*---------------------------------------------------------------------------*/
+#if PROCESS_PROFILE
+/*
+ * Write the process and event profiles as CSV to the file named by the
+ * CONTIKI_PROFILE_CSV environment variable when the program exits.
+ * Times are in PROCESS_PROFILE_SECOND units, microseconds on native.
+ */
+static void
+write_profile(void)
+{
+  struct process *p;
+  struct process_event_profile e;
+  FILE *f;
+  int i;
 
+  f = fopen(getenv("CONTIKI_PROFILE_CSV"), "w");
+  if(f == NULL) {
+    perror("CONTIKI_PROFILE_CSV");
+    return;
+  }
+  fprintf(f, "type,name,count,time,time_max\n");
+  for(p = PROCESS_LIST(); p != NULL; p = p->next) {
+    fprintf(f, "process,\"%s\",%lu,%lu,%lu\n", PROCESS_NAME_STRING(p),
+            p->profile.calls, p->profile.time, p->profile.time_max);
+  }
+  for(i = 0; i <= PROCESS_PROFILE_EVENTS; i++) {
+    if(i < PROCESS_PROFILE_EVENTS) {
+      process_get_event_profile(PROCESS_EVENT_NONE + i, &e);
+      fprintf(f, "event,0x%02x,", PROCESS_EVENT_NONE + i);
+    } else {
+      process_get_event_profile(0, &e);
+      fprintf(f, "event,other,");
+    }
+    fprintf(f, "%lu,%lu,%lu\n", e.events, e.latency_total, e.latency_max);
+  }
+  fclose(f);
+}
+#endif /* PROCESS_PROFILE */
 /*---------------------------------------------------------------------------*/
 int contiki_argc = 0;
 char **contiki_argv;
@@ -188,6 +226,11 @@ main(int argc, char **argv)
 #endif
 
   process_init();
+#if PROCESS_PROFILE
+  if(getenv("CONTIKI_PROFILE_CSV") != NULL) {
+    atexit(write_profile);
+  }
+#endif /* PROCESS_PROFILE */
   process_start(&etimer_process, NULL);
   ctimer_init();
 
@@ -79,6 +79,28 @@ xmem_erase(long nbytes, unsigned long offset)
   return nbytes;
 }
 /*---------------------------------------------------------------------------*/
+int
+xmem_preadv(const struct xmem_iovec *iov, int iovcnt)
+{
+  int i, total;
+
+  for(i = total = 0; i < iovcnt; i++) {
+    total += xmem_pread(iov[i].buf, iov[i].nbytes, iov[i].offset);
+  }
+  return total;
+}
+/*---------------------------------------------------------------------------*/
+int
+xmem_pwritev(const struct xmem_iovec *iov, int iovcnt)
+{
+  int i, total;
+
+  for(i = total = 0; i < iovcnt; i++) {
+    total += xmem_pwrite(iov[i].buf, iov[i].nbytes, iov[i].offset);
+  }
+  return total;
+}
+/*---------------------------------------------------------------------------*/
 void
 xmem_init(void)
 {
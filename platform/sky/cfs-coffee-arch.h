@@ -73,6 +73,12 @@
 #define COFFEE_ERASE(sector)					\
   		xmem_erase(COFFEE_SECTOR_SIZE, COFFEE_START + (sector) * COFFEE_SECTOR_SIZE)
 
+#define COFFEE_WRITEV(iov, iovcnt)				\
+		xmem_pwritev((iov), (iovcnt))
+
+#define COFFEE_SUBMIT(req)	xmem_submit(req)
+#define COFFEE_WAIT(req)	xmem_wait(req)
+
 /* Coffee types. */
 typedef int16_t coffee_page_t;
 
@@ -98,6 +98,9 @@
 #define CC2420_CONF_CHANNEL              26
 #endif /* CC2420_CONF_CHANNEL */
 
+/* Channel hopping in the TSCH RDC driver */
+#define TSCH_CONF_SET_CHANNEL(c) cc2420_set_channel(c)
+
 #ifndef CC2420_CONF_CCA_THRESH
 #define CC2420_CONF_CCA_THRESH              -45
 #endif /* CC2420_CONF_CCA_THRESH */
@@ -130,6 +133,10 @@
 
 #define PROCESS_CONF_NUMEVENTS 8
 #define PROCESS_CONF_STATS 1
+/* Poll requests come from interrupts, so interrupts are disabled
+   while the poll list is changed. */
+#define PROCESS_CONF_POLL_LIST_LOCK()    splhigh()
+#define PROCESS_CONF_POLL_LIST_UNLOCK(s) splx(s)
 /*#define PROCESS_CONF_FASTPOLL    4*/
 
 #ifdef WITH_UIP6
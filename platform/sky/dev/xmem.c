@@ -247,6 +247,130 @@ xmem_pwrite(const void *_buf, int size, unsigned long addr)
   return size;
 }
 /*---------------------------------------------------------------------------*/
+/*
+ * Elements that follow each other in the memory are read with one READ
+ * command, and written with one PP command as long as they are on the
+ * same 256 byte page.
+ */
+int
+xmem_preadv(const struct xmem_iovec *iov, int iovcnt)
+{
+  unsigned char *p, *end;
+  unsigned long next;
+  int i, s, total;
+
+  if(iovcnt <= 0) {
+    return 0;
+  }
+
+  wait_ready();
+
+  ENERGEST_ON(ENERGEST_TYPE_FLASH_READ);
+
+  s = splhigh();
+  next = iov[0].offset + 1;
+  total = 0;
+  for(i = 0; i < iovcnt; i++) {
+    if(iov[i].offset != next) {
+      if(i > 0) {
+        SPI_FLASH_DISABLE();
+        splx(s);
+        s = splhigh();
+      }
+      SPI_FLASH_ENABLE();
+
+      SPI_WRITE_FAST(SPI_FLASH_INS_READ);
+      SPI_WRITE_FAST(iov[i].offset >> 16);	/* MSB */
+      SPI_WRITE_FAST(iov[i].offset >> 8);
+      SPI_WRITE_FAST(iov[i].offset >> 0);	/* LSB */
+      SPI_WAITFORTx_ENDED();
+
+      SPI_FLUSH();
+    }
+
+    p = iov[i].buf;
+    end = p + iov[i].nbytes;
+    for(; p < end; p++) {
+      unsigned char u;
+      SPI_READ(u);
+      *p = ~u;
+    }
+    next = iov[i].offset + iov[i].nbytes;
+    total += iov[i].nbytes;
+  }
+
+  SPI_FLASH_DISABLE();
+  splx(s);
+
+  ENERGEST_OFF(ENERGEST_TYPE_FLASH_READ);
+
+  return total;
+}
+/*---------------------------------------------------------------------------*/
+int
+xmem_pwritev(const struct xmem_iovec *iov, int iovcnt)
+{
+  const unsigned char *p, *end;
+  unsigned long addr;
+  int i, s, programming, total;
+
+  ENERGEST_ON(ENERGEST_TYPE_FLASH_WRITE);
+
+  s = 0;
+  programming = 0;
+  addr = 0;
+  total = 0;
+  for(i = 0; i < iovcnt; i++) {
+    if(programming && iov[i].offset != addr) {
+      SPI_WAITFORTx_ENDED();
+      SPI_FLASH_DISABLE();
+      splx(s);
+      programming = 0;
+    }
+
+    addr = iov[i].offset;
+    p = iov[i].buf;
+    end = p + iov[i].nbytes;
+    while(p < end) {
+      if(!programming) {
+        wait_ready();
+        write_enable();
+
+        s = splhigh();
+        SPI_FLASH_ENABLE();
+
+        SPI_WRITE_FAST(SPI_FLASH_INS_PP);
+        SPI_WRITE_FAST(addr >> 16);	/* MSB */
+        SPI_WRITE_FAST(addr >> 8);
+        SPI_WRITE_FAST(addr >> 0);	/* LSB */
+        programming = 1;
+      }
+
+      SPI_WRITE_FAST(~*p++);
+      addr++;
+
+      /* A page program command wraps around at the end of the page. */
+      if((addr & 0xff) == 0) {
+        SPI_WAITFORTx_ENDED();
+        SPI_FLASH_DISABLE();
+        splx(s);
+        programming = 0;
+      }
+    }
+    total += iov[i].nbytes;
+  }
+
+  if(programming) {
+    SPI_WAITFORTx_ENDED();
+    SPI_FLASH_DISABLE();
+    splx(s);
+  }
+
+  ENERGEST_OFF(ENERGEST_TYPE_FLASH_WRITE);
+
+  return total;
+}
+/*---------------------------------------------------------------------------*/
 int
 xmem_erase(long size, unsigned long addr)
 {
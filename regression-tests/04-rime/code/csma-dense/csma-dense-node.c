@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2013, the Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Dense network test for CSMA: every node sends unicasts to
+ *         node 1 at the same rate and then reports its CSMA
+ *         statistics for node 1.
+ */
+
+#include "contiki.h"
+#include "net/rime.h"
+#include "net/mac/csma.h"
+#include "lib/random.h"
+#include "sys/node-id.h"
+
+#include <stdio.h>
+
+#define SINK_ID       1
+#define PACKETS       30
+#define SEND_INTERVAL (CLOCK_SECOND)
+/*---------------------------------------------------------------------------*/
+PROCESS(csma_dense_process, "CSMA dense network test");
+AUTOSTART_PROCESSES(&csma_dense_process);
+/*---------------------------------------------------------------------------*/
+static unsigned received;
+
+static void
+recv_uc(struct unicast_conn *c, const rimeaddr_t *from)
+{
+  received++;
+  printf("received from %d.%d total %u\n",
+         from->u8[0], from->u8[1], received);
+}
+static const struct unicast_callbacks unicast_callbacks = {recv_uc};
+static struct unicast_conn uc;
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(csma_dense_process, ev, data)
+{
+  static struct etimer et;
+  static int sent;
+  const struct csma_stats *stats;
+  rimeaddr_t sink;
+
+  PROCESS_EXITHANDLER(unicast_close(&uc);)
+  PROCESS_BEGIN();
+
+  unicast_open(&uc, 146, &unicast_callbacks);
+
+  if(node_id == SINK_ID) {
+    PROCESS_EXIT();
+  }
+
+  sink.u8[0] = SINK_ID;
+  sink.u8[1] = 0;
+
+  /* Let all nodes boot before sending */
+  etimer_set(&et, CLOCK_SECOND * 5);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+
+  for(sent = 0; sent < PACKETS; sent++) {
+    etimer_set(&et, SEND_INTERVAL / 2 + random_rand() % SEND_INTERVAL);
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+    packetbuf_copyfrom("Hello", 6);
+    unicast_send(&uc, &sink);
+  }
+
+  /* Wait for the last packets to go out */
+  etimer_set(&et, CLOCK_SECOND * 10);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+
+  stats = csma_stats_get(&sink);
+  if(stats != NULL) {
+    printf("done sent %d completed %u retries %u drops %u queued %u\n",
+           sent, stats->packets, stats->retries, stats->drops,
+           stats->queued);
+  } else {
+    printf("done sent %d no statistics\n", sent);
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
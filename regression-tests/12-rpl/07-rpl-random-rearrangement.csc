@@ -26,7 +26,7 @@
       <description>Sender</description>
       <source>[CONFIG_DIR]/code/sender-node.c</source>
       <commands>make clean TARGET=cooja
-make sender-node.cooja TARGET=cooja</commands>
+make sender-node.cooja TARGET=cooja DEFINES=RPL_CONF_STATS=1</commands>
       <moteinterface>org.contikios.cooja.interfaces.Position</moteinterface>
       <moteinterface>org.contikios.cooja.interfaces.Battery</moteinterface>
       <moteinterface>org.contikios.cooja.contikimote.interfaces.ContikiVib</moteinterface>
@@ -51,7 +51,7 @@ make sender-node.cooja TARGET=cooja</commands>
       <description>RPL root</description>
       <source>[CONFIG_DIR]/code/root-node.c</source>
       <commands>make clean TARGET=cooja
-make root-node.cooja TARGET=cooja</commands>
+make root-node.cooja TARGET=cooja DEFINES=RPL_CONF_STATS=1</commands>
       <moteinterface>org.contikios.cooja.interfaces.Position</moteinterface>
       <moteinterface>org.contikios.cooja.interfaces.Battery</moteinterface>
       <moteinterface>org.contikios.cooja.contikimote.interfaces.ContikiVib</moteinterface>
@@ -76,7 +76,7 @@ make root-node.cooja TARGET=cooja</commands>
       <description>Receiver</description>
       <source>[CONFIG_DIR]/code/receiver-node.c</source>
       <commands>make clean TARGET=cooja
-make receiver-node.cooja TARGET=cooja</commands>
+make receiver-node.cooja TARGET=cooja DEFINES=RPL_CONF_STATS=1</commands>
       <moteinterface>org.contikios.cooja.interfaces.Position</moteinterface>
       <moteinterface>org.contikios.cooja.interfaces.Battery</moteinterface>
       <moteinterface>org.contikios.cooja.contikimote.interfaces.ContikiVib</moteinterface>
@@ -575,8 +575,21 @@ var numForwarders = 20;&#xD;
 var forwardIDStart = 4;&#xD;
 packetsReceived = [];&#xD;
 var hops;&#xD;
+var daoSent = [];&#xD;
+var daoTargets = [];&#xD;
 &#xD;
-TIMEOUT(6000000, if(packetsReceived.length &gt; 50) { log.testOK(); } );&#xD;
+/* The DAO counters of each node are cumulative, so sum the latest. */&#xD;
+function logDaoStats() {&#xD;
+    var sent = 0;&#xD;
+    var targets = 0;&#xD;
+    for(var i in daoSent) {&#xD;
+        sent += daoSent[i];&#xD;
+        targets += daoTargets[i];&#xD;
+    }&#xD;
+    log.log('DAO stats: sent ' + sent + ' targets ' + targets + '\n');&#xD;
+}&#xD;
+&#xD;
+TIMEOUT(6000000, logDaoStats(); if(packetsReceived.length &gt; 50) { log.testOK(); } );&#xD;
 &#xD;
 while(true) {&#xD;
     YIELD();&#xD;
@@ -616,6 +629,10 @@ while(true) {&#xD;
         hops = 0;&#xD;
     } else if(msg.startsWith("#L")) {&#xD;
         hops++;&#xD;
+    } else if(msg.startsWith("DAO stats")) {&#xD;
+        var fields = msg.split(" ");&#xD;
+        daoSent[id] = parseInt(fields[3]);&#xD;
+        daoTargets[id] = parseInt(fields[5]);&#xD;
     } else if(msg.startsWith("Data")) {&#xD;
         var data = msg.split(" ");&#xD;
         var num = parseInt(data[14]);&#xD;
@@ -28,3 +28,11 @@
  */
 #define TCPIP_CONF_ANNOTATE_TRANSMISSIONS 1
 
+#if WITH_TSCH
+#undef NETSTACK_CONF_MAC
+#define NETSTACK_CONF_MAC nullmac_driver
+#undef NETSTACK_CONF_RDC
+#define NETSTACK_CONF_RDC tsch_driver
+/* The Cooja radio does not ack frames, so TSCH acks them itself */
+#define RDC_CONF_HARDWARE_SEND_ACK 0
+#endif /* WITH_TSCH */
@@ -38,6 +38,9 @@
 #include "simple-udp.h"
 
 #include "net/rpl/rpl.h"
+#if RPL_CONF_STATS
+#include "net/rpl/rpl-private.h"
+#endif /* RPL_CONF_STATS */
 #include "dev/leds.h"
 
 #include <stdio.h>
@@ -45,6 +48,8 @@
 
 #define UDP_PORT 1234
 
+#define STATS_INTERVAL		(60 * CLOCK_SECOND)
+
 static struct simple_udp_connection unicast_connection;
 
 /*---------------------------------------------------------------------------*/
@@ -90,6 +95,18 @@ set_global_address(void)
   return &ipaddr;
 }
 /*---------------------------------------------------------------------------*/
+#if RPL_CONF_STATS
+static struct ctimer stats_timer;
+
+static void
+print_dao_stats(void *ptr)
+{
+  printf("DAO stats: sent %u targets %u\n",
+         rpl_stats.dao_sent, rpl_stats.dao_targets_sent);
+  ctimer_reset(&stats_timer);
+}
+#endif /* RPL_CONF_STATS */
+/*---------------------------------------------------------------------------*/
 uint8_t should_blink = 1;
 static void
 route_callback(int event, uip_ipaddr_t *route, uip_ipaddr_t *ipaddr)
@@ -116,6 +133,10 @@ PROCESS_THREAD(receiver_node_process, ev, data)
   simple_udp_register(&unicast_connection, UDP_PORT,
                       NULL, UDP_PORT, receiver);
 
+#if RPL_CONF_STATS
+  ctimer_set(&stats_timer, STATS_INTERVAL, print_dao_stats, NULL);
+#endif /* RPL_CONF_STATS */
+
   etimer_set(&et, CLOCK_SECOND);
   while(1) {
     PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
@@ -39,6 +39,9 @@
 #include "simple-udp.h"
 
 #include "net/rpl/rpl.h"
+#if WITH_TSCH
+#include "net/mac/tsch.h"
+#endif /* WITH_TSCH */
 
 #include <stdio.h>
 #include <string.h>
@@ -120,6 +123,11 @@ PROCESS_THREAD(unicast_receiver_process, ev, data)
 
   PROCESS_BEGIN();
 
+#if WITH_TSCH
+  /* The root also starts the TSCH network. */
+  tsch_set_coordinator(1);
+#endif /* WITH_TSCH */
+
   ipaddr = set_global_address();
 
   create_rpl_dag(ipaddr);
@@ -38,11 +38,18 @@
 
 #include "simple-udp.h"
 
+#include "net/rpl/rpl.h"
+#if RPL_CONF_STATS
+#include "net/rpl/rpl-private.h"
+#endif /* RPL_CONF_STATS */
+
 #include <stdio.h>
 #include <string.h>
 
 #define UDP_PORT 1234
 
+#define STATS_INTERVAL		(60 * CLOCK_SECOND)
+
 #define SEND_INTERVAL		(60 * CLOCK_SECOND)
 #define SEND_TIME		(random_rand() % (SEND_INTERVAL))
 
@@ -87,6 +94,18 @@ set_global_address(void)
   }
 }
 /*---------------------------------------------------------------------------*/
+#if RPL_CONF_STATS
+static struct ctimer stats_timer;
+
+static void
+print_dao_stats(void *ptr)
+{
+  printf("DAO stats: sent %u targets %u\n",
+         rpl_stats.dao_sent, rpl_stats.dao_targets_sent);
+  ctimer_reset(&stats_timer);
+}
+#endif /* RPL_CONF_STATS */
+/*---------------------------------------------------------------------------*/
 PROCESS_THREAD(sender_node_process, ev, data)
 {
   static struct etimer periodic_timer;
@@ -100,6 +119,10 @@ PROCESS_THREAD(sender_node_process, ev, data)
   simple_udp_register(&unicast_connection, UDP_PORT,
                       NULL, UDP_PORT, receiver);
 
+#if RPL_CONF_STATS
+  ctimer_set(&stats_timer, STATS_INTERVAL, print_dao_stats, NULL);
+#endif /* RPL_CONF_STATS */
+
   etimer_set(&periodic_timer, SEND_INTERVAL);
   while(1) {
 